@@ -84,6 +84,8 @@ void GameInit()
 
     SetupClones();
 
+    rlmSetAnimationWorkerCount(2);
+
     for (int i = 0; i < 5; i++)
     {
         modelInstance[i].model = &coloredRobots[i];
@@ -105,6 +107,7 @@ void GameInit()
 
 void GameCleanup()
 {
+    rlmSetAnimationWorkerCount(0);
     rlmUnloadModel(&masterRobotModel);
     CloseWindow();
 }
@@ -114,8 +117,7 @@ bool GameUpdate()
     if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT))
         UpdateCamera(&ViewCam, CAMERA_THIRD_PERSON);
 
-    for (int i = 0; i < 5; i++)
-        rlmAdvanceAnimationInstance(&modelInstance[i], GetFrameTime());
+    rlmAdvanceAnimationInstances(modelInstance, 5, GetFrameTime());
 
     if (masterRobotModel.skeleton)
     {
@@ -156,7 +158,7 @@ void GameDraw()
   //DrawModel(raylibModel, Vector3Zeros, 1, WHITE);
 
     for (int i = 0; i < 5; i++)
-        rlmDrawModelWithPose(*modelInstance[i].model, modelInstance[i].transform, &modelInstance[i].currentPose);
+        rlmDrawModelWithPose(*modelInstance[i].model, modelInstance[i].transform, rlmGetAnimationInstancePose(&modelInstance[i]));
 
     DrawGrid(100, 1);
 
@@ -0,0 +1,105 @@
+/*
+Raylib example file.
+This is an example main file for a simple raylib project.
+Use this as a starting point or replace it with your code.
+
+-- Copyright (c) 2020-2024 Jeffery Myers
+--
+--This software is provided "as-is", without any express or implied warranty. In no event 
+--will the authors be held liable for any damages arising from the use of this software.
+
+--Permission is granted to anyone to use this software for any purpose, including commercial 
+--applications, and to alter it and redistribute it freely, subject to the following restrictions:
+
+--  1. The origin of this software must not be misrepresented; you must not claim that you 
+--  wrote the original software. If you use this software in a product, an acknowledgment 
+--  in the product documentation would be appreciated but is not required.
+--
+--  2. Altered source versions must be plainly marked as such, and must not be misrepresented
+--  as being the original software.
+--
+--  3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "raylib.h"
+#include "raymath.h"
+
+#include "rlModels.h"	
+#include "rlModels_IO.h"
+
+rlmModel robotModel = { 0 };
+rlmModelAnimationSet animSet = { 0 };
+
+constexpr int PassCount = 2000;
+
+// returns nanoseconds per bone for one full sweep of lerps over every frame of every sequence
+double BenchmarkKeyframeLerp(rlmModelAnimationPose& pose)
+{
+    long long boneCount = 0;
+
+    double start = GetTime();
+
+    for (int pass = 0; pass < PassCount; pass++)
+    {
+        float param = (pass % 100) / 100.0f;
+
+        for (int s = 0; s < animSet.sequenceCount; s++)
+        {
+            rlmModelAniamtionSequence& sequence = animSet.sequences[s];
+
+            for (int f = 0; f < sequence.keyframeCount; f++)
+            {
+                int next = (f + 1) % sequence.keyframeCount;
+                rlmSetPoseToKeyframesLerp(robotModel, &pose, sequence.keyframes[f], sequence.keyframes[next], param);
+                boneCount += robotModel.skeleton->boneCount;
+            }
+        }
+    }
+
+    double elapsed = GetTime() - start;
+
+    return (elapsed * 1000000000.0) / double(boneCount);
+}
+
+int main()
+{
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(320, 200, "Benchmark");
+
+    Model raylibModel = LoadModel("resources/robot.glb");
+    robotModel = rlmLoadFromModel(raylibModel);
+
+    if (!robotModel.skeleton)
+    {
+        TraceLog(LOG_ERROR, "Benchmark: model has no skeleton");
+        CloseWindow();
+        return 1;
+    }
+
+    ModelAnimation* animations = LoadModelAnimations("resources/robot.glb", &animSet.sequenceCount);
+    animSet.sequences = rlmLoadModelAnimations(robotModel.skeleton, animations, animSet.sequenceCount);
+
+    rlmModelAnimationPose pose = rlmLoadPoseFromModel(robotModel);
+
+    rlmSetAnimationSIMD(false);
+    double scalarTime = BenchmarkKeyframeLerp(pose);
+
+    rlmSetAnimationSIMD(true);
+    double simdTime = BenchmarkKeyframeLerp(pose);
+
+    TraceLog(LOG_INFO, "Benchmark: %d bones, %d sequences, %d passes", robotModel.skeleton->boneCount, animSet.sequenceCount, PassCount);
+    TraceLog(LOG_INFO, "Benchmark: scalar keyframe lerp %.2f ns/bone", scalarTime);
+
+    if (rlmIsAnimationSIMDSupported())
+        TraceLog(LOG_INFO, "Benchmark: SIMD keyframe lerp %.2f ns/bone (%.2fx)", simdTime, scalarTime / simdTime);
+    else
+        TraceLog(LOG_INFO, "Benchmark: SIMD keyframe lerp is not supported in this build");
+
+    rlmUnloadPose(&pose);
+    rlmUnloadAnimationSet(&animSet);
+    rlmUnloadModel(&robotModel);
+    CloseWindow();
+
+    return 0;
+}
@@ -34,6 +34,10 @@ rlmModel newModel = { 0 };
 
 rlmModel cloneModel = { 0 };
 
+#define INSTANCE_COUNT 16
+rlmPQSTransorm instanceTransforms[INSTANCE_COUNT] = { 0 };
+Color instanceTints[INSTANCE_COUNT] = { 0 };
+
 void GameInit()
 {
     SetConfigFlags(FLAG_VSYNC_HINT | FLAG_WINDOW_RESIZABLE);
@@ -59,12 +63,26 @@ void GameInit()
     cloneModel.orientationTransform.rotation = QuaternionFromAxisAngle(Vector3UnitY, 180 * DEG2RAD);
     rlmSetMaterialChannelTexture(&cloneModel.groups[0].material.baseChannel, LoadTexture("resources/castle_diffuse_blue.png"));
     cloneModel.groups[0].material.baseChannel.ownsTexture = true;
+
+    // a ring of smaller tinted copies, drawn in one call per mesh
+    for (int i = 0; i < INSTANCE_COUNT; i++)
+    {
+        float angle = i * (360.0f / INSTANCE_COUNT) * DEG2RAD;
+
+        instanceTransforms[i] = rlmPQSIdentity();
+        instanceTransforms[i].position = Vector3{ cosf(angle) * 150, 0, sinf(angle) * 150 };
+        instanceTransforms[i].rotation = QuaternionFromAxisAngle(Vector3UnitY, -angle);
+        instanceTransforms[i].scale = Vector3{ 0.5f, 0.5f, 0.5f };
+
+        instanceTints[i] = ColorFromHSV(i * (360.0f / INSTANCE_COUNT), 0.5f, 1.0f);
+    }
 }
 
 void GameCleanup()
 {
     rlmUnloadModel(&cloneModel);
     rlmUnloadModel(&newModel);
+    rlmUnloadInstancingResources();
     CloseWindow();
 }
 
@@ -85,6 +103,8 @@ void GameDraw()
     rlmDrawModel(newModel, rlmPQSIdentity());
     rlmDrawModel(cloneModel, rlmPQSIdentity());
 
+    rlmDrawModelInstancedEx(newModel, instanceTransforms, instanceTints, INSTANCE_COUNT);
+
     DrawGrid(100, 1);
 
     EndMode3D();
@@ -0,0 +1,62 @@
+#version 330
+
+#define MAX_BONE_NUM 128
+
+// Input vertex attributes
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+in vec4 vertexColor;
+in vec3 vertexNormal;
+in vec4 vertexBoneIds;
+in vec4 vertexBoneWeights;
+
+// Input uniform values
+uniform mat4 mvp;
+uniform mat4 matNormal;
+
+// the top three rows of each bone matrix, 48 bytes a bone instead of 64
+uniform vec4 boneMatrices3x4[MAX_BONE_NUM*3];
+
+// Output vertex attributes (to fragment shader)
+out vec2 fragTexCoord;
+out vec4 fragColor;
+out vec3 fragNormal;
+
+void main()
+{
+    int boneIndex0 = int(vertexBoneIds.x)*3;
+    int boneIndex1 = int(vertexBoneIds.y)*3;
+    int boneIndex2 = int(vertexBoneIds.z)*3;
+    int boneIndex3 = int(vertexBoneIds.w)*3;
+
+    // blend the rows first, so the vertex is only transformed once
+    vec4 row0 =
+        vertexBoneWeights.x*boneMatrices3x4[boneIndex0] +
+        vertexBoneWeights.y*boneMatrices3x4[boneIndex1] +
+        vertexBoneWeights.z*boneMatrices3x4[boneIndex2] +
+        vertexBoneWeights.w*boneMatrices3x4[boneIndex3];
+
+    vec4 row1 =
+        vertexBoneWeights.x*boneMatrices3x4[boneIndex0 + 1] +
+        vertexBoneWeights.y*boneMatrices3x4[boneIndex1 + 1] +
+        vertexBoneWeights.z*boneMatrices3x4[boneIndex2 + 1] +
+        vertexBoneWeights.w*boneMatrices3x4[boneIndex3 + 1];
+
+    vec4 row2 =
+        vertexBoneWeights.x*boneMatrices3x4[boneIndex0 + 2] +
+        vertexBoneWeights.y*boneMatrices3x4[boneIndex1 + 2] +
+        vertexBoneWeights.z*boneMatrices3x4[boneIndex2 + 2] +
+        vertexBoneWeights.w*boneMatrices3x4[boneIndex3 + 2];
+
+    vec4 position = vec4(vertexPosition, 1.0);
+    vec4 skinnedPosition = vec4(dot(row0, position), dot(row1, position), dot(row2, position), 1.0);
+
+    vec4 skinnedNormal = vec4(dot(row0.xyz, vertexNormal), dot(row1.xyz, vertexNormal), dot(row2.xyz, vertexNormal), 0.0);
+
+    fragTexCoord = vertexTexCoord;
+    fragColor = vertexColor;
+
+    fragNormal = normalize(vec3(matNormal*skinnedNormal));
+
+    gl_Position = mvp*skinnedPosition;
+}
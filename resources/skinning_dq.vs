@@ -0,0 +1,80 @@
+#version 330
+
+#define MAX_BONE_NUM 128
+
+// Input vertex attributes
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+in vec4 vertexColor;
+in vec3 vertexNormal;
+in vec4 vertexBoneIds;
+in vec4 vertexBoneWeights;
+
+// Input uniform values
+uniform mat4 mvp;
+uniform mat4 matNormal;
+
+// real and dual quaternion of each bone, then a uniform scale per bone packed four to a vec4, 36 bytes a bone
+uniform vec4 boneDualQuats[MAX_BONE_NUM*2];
+uniform vec4 boneScales[MAX_BONE_NUM/4];
+
+// Output vertex attributes (to fragment shader)
+out vec2 fragTexCoord;
+out vec4 fragColor;
+out vec3 fragNormal;
+
+float boneScale(int bone)
+{
+    return boneScales[bone/4][bone%4];
+}
+
+void main()
+{
+    int boneIndex0 = int(vertexBoneIds.x);
+    int boneIndex1 = int(vertexBoneIds.y);
+    int boneIndex2 = int(vertexBoneIds.z);
+    int boneIndex3 = int(vertexBoneIds.w);
+
+    vec4 real0 = boneDualQuats[boneIndex0*2];
+    vec4 real1 = boneDualQuats[boneIndex1*2];
+    vec4 real2 = boneDualQuats[boneIndex2*2];
+    vec4 real3 = boneDualQuats[boneIndex3*2];
+
+    // q and -q are the same rotation, keep them all on the side of the first one so the blend takes the short way
+    vec4 weights = vertexBoneWeights;
+    weights.y *= sign(dot(real0, real1) + 0.0001);
+    weights.z *= sign(dot(real0, real2) + 0.0001);
+    weights.w *= sign(dot(real0, real3) + 0.0001);
+
+    vec4 real = weights.x*real0 + weights.y*real1 + weights.z*real2 + weights.w*real3;
+    vec4 dual =
+        weights.x*boneDualQuats[boneIndex0*2 + 1] +
+        weights.y*boneDualQuats[boneIndex1*2 + 1] +
+        weights.z*boneDualQuats[boneIndex2*2 + 1] +
+        weights.w*boneDualQuats[boneIndex3*2 + 1];
+
+    float realLength = length(real);
+    real /= realLength;
+    dual /= realLength;
+
+    float scale =
+        vertexBoneWeights.x*boneScale(boneIndex0) +
+        vertexBoneWeights.y*boneScale(boneIndex1) +
+        vertexBoneWeights.z*boneScale(boneIndex2) +
+        vertexBoneWeights.w*boneScale(boneIndex3);
+
+    vec3 position = vertexPosition*scale;
+    vec3 translation = 2.0*(real.w*dual.xyz - dual.w*real.xyz + cross(real.xyz, dual.xyz));
+    vec3 rotatedPosition = position + 2.0*cross(real.xyz, cross(real.xyz, position) + real.w*position);
+    vec3 rotatedNormal = vertexNormal + 2.0*cross(real.xyz, cross(real.xyz, vertexNormal) + real.w*vertexNormal);
+
+    vec4 skinnedPosition = vec4(rotatedPosition + translation, 1.0);
+    vec4 skinnedNormal = vec4(rotatedNormal, 0.0);
+
+    fragTexCoord = vertexTexCoord;
+    fragColor = vertexColor;
+
+    fragNormal = normalize(vec3(matNormal*skinnedNormal));
+
+    gl_Position = mvp*skinnedPosition;
+}
@@ -15,10 +15,25 @@ extern "C" {            // Prevents name mangling of functions
 		Vector3 scale;
 	}rlmPQSTransorm;
 
+	typedef enum rlmVertexLayoutFlags	// how rlmUploadMesh lays out and packs the vertex buffers
+	{
+		RLM_VERTEX_SEPARATE = 0,			// one float buffer per attribute
+		RLM_VERTEX_INTERLEAVED = 1,			// every attribute in one buffer
+		RLM_VERTEX_HOT_COLD = 2,			// interleaved into two buffers, positions and skinning in one and the rest in the other, so depth only passes read less
+		RLM_VERTEX_HALF_POSITIONS = 4,		// 16 bit float positions, about 3 significant digits, fine for props but not for large meshes
+		RLM_VERTEX_PACKED_NORMALS = 8,		// normals and tangents as normalized signed bytes
+		RLM_VERTEX_HALF_TEXCOORDS = 16,		// 16 bit float texcoords, so tiling outside of 0..1 still works
+		RLM_VERTEX_PACKED_WEIGHTS = 32,		// bone weights as normalized unsigned bytes
+		RLM_VERTEX_COMPRESSED = RLM_VERTEX_INTERLEAVED | RLM_VERTEX_HALF_POSITIONS | RLM_VERTEX_PACKED_NORMALS | RLM_VERTEX_HALF_TEXCOORDS | RLM_VERTEX_PACKED_WEIGHTS,
+	}rlmVertexLayoutFlags;
+
 	typedef struct rlmGPUMesh	// minimum data needed to draw a mesh on the GPU
 	{
 		unsigned int vaoId;
-		unsigned int* vboIds;
+		unsigned int* vboIds;	// by attribute location, interleaved attributes repeat the id of their buffer
+		int vertexLayout;		// rlmVertexLayoutFlags the buffers were written with
+		bool indices32;			// the index buffer holds 32 bit indices
+		int arenaSlot;			// 0 when the mesh owns its buffers, otherwise its range in the mesh arena plus one
 
 		bool isIndexed;
 		unsigned int elementCount;
@@ -36,11 +51,55 @@ extern "C" {            // Prevents name mangling of functions
 		float* tangents;        // Vertex tangents (XYZW - 4 components per vertex) (shader-location = 4)
 		unsigned char* colors;      // Vertex colors (RGBA - 4 components per vertex) (shader-location = 3)
 		unsigned short* indices;    // Vertex indices (in case vertex data comes indexed)
+		unsigned int* indices32;    // Vertex indices used in place of indices when there are more vertices than 16 bits can reach
 
 		unsigned char* boneIds; // Vertex bone ids, max 255 bone ids, up to 4 bones influence by vertex (skinning) (shader-location = 6)
 		float* boneWeights;     // Vertex bone weight, up to 4 bones influence by vertex (skinning) (shader-location = 7)
 	}rlmMeshBuffers;
 
+	#define RLM_MAX_MESH_LODS 4
+
+	typedef struct rlmMeshLOD	// a reduced index buffer drawn with the vertex buffers of its mesh
+	{
+		rlmGPUMesh gpuMesh;
+		int triangleCount;
+		float error;		// simplifier error relative to the mesh size, 0 for levels given by the caller
+		float screenSize;	// drawn when the projected bounds are under this fraction of the screen height
+
+		unsigned short* indices;	// freed once the level is uploaded
+		unsigned int* indices32;	// in place of indices when the mesh has 32 bit indices
+	}rlmMeshLOD;
+
+	typedef struct rlmMeshLODReport
+	{
+		int levelCount;		// including the base mesh
+		int triangles[RLM_MAX_MESH_LODS + 1];
+		int bytes[RLM_MAX_MESH_LODS + 1];	// GPU memory, the shared vertex buffers are counted with the base mesh while its buffers are kept
+		float errors[RLM_MAX_MESH_LODS + 1];
+	}rlmMeshLODReport;
+
+	typedef struct rlmMeshOptimizeReport
+	{
+		int vertexCountBefore;
+		int vertexCountAfter;
+		int triangleCountBefore;
+		int triangleCountAfter;		// welding can collapse triangles
+		float acmrBefore;			// average post transform cache misses per triangle, 3 is the worst
+		float acmrAfter;
+	}rlmMeshOptimizeReport;
+
+	typedef struct rlmMeshArenaStats	// occupancy of the shared mesh buffers
+	{
+		int pages;				// vertex arrays, each with one vertex and one index buffer
+		int vertexBytes;		// allocated on the GPU
+		int vertexBytesUsed;
+		int indexBytes;
+		int indexBytesUsed;
+		int allocations;		// meshes and mesh LODs placed in the arena
+		int freeBlocks;			// free ranges, counting the unused end of each buffer, more per page means more fragmentation
+		int largestFreeBlock;	// in bytes, across vertex and index buffers
+	}rlmMeshArenaStats;
+
 	typedef struct rlmMesh // a mesh
 	{
 		char* name;
@@ -51,9 +110,24 @@ extern "C" {            // Prevents name mangling of functions
 
 		rlmPQSTransorm transform;
 
+		int lodCount;
+		rlmMeshLOD lods[RLM_MAX_MESH_LODS];	// coarser levels after the base mesh, in order
+
+		int multiDrawSlot;	// entry in the shared multi draw buffers plus one, 0 when not packed
+
 		// TODO rlmAnimatedMeshBuffers ?
 	}rlmMesh;
 
+	typedef struct rlmMeshBatch	// meshes of a group merged into one buffer, drawn as index ranges
+	{
+		rlmGPUMesh gpuMesh;
+		int firstMesh;
+		int meshCount;
+		int* indexStarts;		// where each mesh's indices start in the batch
+		int* indexCounts;
+		BoundingBox* bounds;	// each mesh in model space
+	}rlmMeshBatch;
+
 	typedef struct rlmMaterialChannel // a texture map in a material
 	{
 		int textureId;
@@ -96,6 +170,11 @@ extern "C" {            // Prevents name mangling of functions
 		int meshCount;
 		rlmMesh* meshes;
 		bool* meshDisableFlags;
+		int* meshLODLevels;		// the level each mesh was last drawn at, so switching can lag behind, shared by every draw of the group
+
+		int batchCount;			// static batches used by rlmDrawModel in place of the meshes, more than one when the vertices don't fit 16 bit indices
+		rlmMeshBatch* batches;
+		bool ownsBatches;
 	}rlmModelGroup;
 
 	typedef struct rlmBoneInfo  // a node in the bone tree
@@ -112,6 +191,7 @@ extern "C" {            // Prevents name mangling of functions
 	typedef struct rlmAnimationKeyframe // a list of bone transforms for a skeleton
 	{
 		rlmPQSTransorm* boneTransforms;
+		bool isView;	// points into a sequence's transformData, which only rlmUnloadAnimationSequence frees
 	}rlmAnimationKeyframe;
 
 	typedef struct rlmSkeleton // a tree of bones, and the keyframe for it's binding pose
@@ -122,6 +202,21 @@ extern "C" {            // Prevents name mangling of functions
 		rlmBoneInfo* rootBone;
 
 		rlmAnimationKeyframe bindingFrame;
+		rlmAnimationKeyframe inverseBindingFrame;	// inverted binding transforms, built by rlmCompileSkeleton
+
+		// flattened hierarchy built by rlmCompileSkeleton, slots are in parent before child order
+		int* boneOrder;		// bone id stored in each slot
+		int* slotParents;	// slot of the parent of each slot, -1 for roots
+		int* slotSubtreeEnds;	// one past the last slot in the subtree starting at each slot
+		int* boneSlots;		// slot for each bone id
+
+		int* slotDepths;	// distance from the root for each slot
+		int maxBoneDepth;
+		int* depthSortedBones;	// bone ids sorted by depth, so every depth limit is a prefix
+		int* depthBoneCounts;	// number of bones at or above each depth, maxBoneDepth + 1 entries
+
+		int boneNameHashSize;	// power of two
+		int* boneNameHash;	// open addressed bone ids, -1 for empty
 	}rlmSkeleton;
 
 	typedef struct rlmModelAnimationPose    // a list of model space matricides baked out for display of an animation
@@ -129,13 +224,48 @@ extern "C" {            // Prevents name mangling of functions
 		Matrix* boneMatricies;
 	}rlmModelAnimationPose;
 
+	typedef struct rlmCompressedTrack	// one position, rotation or scale channel of a bone
+	{
+		int keyCount;		// 0 when the track is constant, and the value is rangeMin
+		int keyOffset;		// index of the first key in the sequence key arrays
+		Vector3 rangeMin;	// quantization range for positions and scales
+		Vector3 rangeSize;
+	}rlmCompressedTrack;
+
+	typedef struct rlmCompressedSequence	// quantized and reduced keyframes, decoded on the fly when sampled
+	{
+		int boneCount;
+		int frameCount;
+
+		rlmCompressedTrack* tracks;	// position, rotation, scale for each bone
+		unsigned short* keyFrames;	// source frame of each key
+		unsigned short* keyData;	// 3 values per key, 16 bit range quantized vectors or smallest three quaternions
+	}rlmCompressedSequence;
+
+	typedef struct rlmAnimationCompressionReport
+	{
+		int rawBytes;
+		int compressedBytes;
+		float ratio;
+
+		int trackCount;
+		int constantTracks;
+		int sourceKeys;
+		int storedKeys;
+	}rlmAnimationCompressionReport;
+
 	typedef struct rlmModelAniamtionSequence    // a named sequence of keyframes
 	{
 		char name[64];
 		float fps;
 
 		int keyframeCount;
-		rlmAnimationKeyframe* keyframes;
+		rlmAnimationKeyframe* keyframes;	// NULL once the sequence is compressed
+
+		int boneCount;
+		rlmPQSTransorm* transformData;		// one frame major block of keyframeCount * boneCount transforms the keyframes point into
+
+		rlmCompressedSequence* compressed;	// optional, sampled instead of the keyframes when set
 	}rlmModelAniamtionSequence;
 
 	typedef struct rlmModelAnimationSet
@@ -144,6 +274,22 @@ extern "C" {            // Prevents name mangling of functions
 		rlmModelAniamtionSequence* sequences;
 	}rlmModelAnimationSet;
 
+	#define RLM_MAX_ANIMATION_LODS 4
+
+	typedef struct rlmAnimationLODLevel
+	{
+		float distance;		// the level is used at or beyond this distance from the view
+		int updateInterval;	// only advance the pose every N updates, time is accumulated in between
+		bool interpolate;	// allow interpolation between keyframes
+		int maxBoneDepth;	// bones deeper than this reuse their parent's matrix, -1 for no limit
+	}rlmAnimationLODLevel;
+
+	typedef struct rlmAnimationLOD
+	{
+		int levelCount;		// 0 disables animation LOD
+		rlmAnimationLODLevel levels[RLM_MAX_ANIMATION_LODS];	// sorted by distance
+	}rlmAnimationLOD;
+
 	typedef struct rlmModel // a group of meshes, materials, and an orientation transform
 	{
 		int groupCount;
@@ -152,8 +298,104 @@ extern "C" {            // Prevents name mangling of functions
 
 		bool ownsSkeleton;
 		rlmSkeleton* skeleton;
+
+		rlmAnimationLOD animationLOD;
 	}rlmModel;
 
+	typedef struct rlmAnimationBoneMask
+	{
+		int boneCount;
+		float* boneWeights;	// 0 to 1 for each bone id
+	}rlmAnimationBoneMask;
+
+	#define RLM_MAX_BLEND_LAYERS 8
+
+	typedef struct rlmAnimationBlendLayer
+	{
+		const rlmModelAniamtionSequence* sequence;
+		float time;		// seconds, loops
+		float weight;
+		const rlmAnimationBoneMask* mask;	// NULL for all bones
+	}rlmAnimationBlendLayer;
+
+	typedef struct rlmRenderQueueStats	// what rlmFlushQueue did
+	{
+		int packets;		// meshes submitted
+		int drawCalls;
+		int shaderChanges;
+		int materialChanges;	// material uniforms applied
+		int textureChanges;
+		int meshChanges;	// vertex array binds
+		int stateChanges;	// all of the above changes
+		int multiDrawPackets;	// packets drawn through the OpenGL 4.3 multi draw path
+	}rlmRenderQueueStats;
+
+	typedef enum rlmBonePaletteFormat	// how bones are laid out for the shader
+	{
+		RLM_BONE_PALETTE_MATRIX = 0,	// mat4, 16 floats
+		RLM_BONE_PALETTE_AFFINE,		// top three rows as vec4s, 12 floats
+		RLM_BONE_PALETTE_DUAL_QUAT,		// real and dual quaternion, 8 floats, then one uniform scale per bone packed into vec4s
+	}rlmBonePaletteFormat;
+
+	typedef struct rlmBoneUploadStats	// bone matrices sent to the GPU
+	{
+		int uploads;		// palettes written to the palette buffer plus bone uniform arrays set
+		int bytes;
+		int paletteBinds;	// palette buffer ranges bound for a group
+	}rlmBoneUploadStats;
+
+	typedef struct rlmFrustum
+	{
+		Vector4 planes[6];	// left, right, bottom, top, near, far, normals point inside
+	}rlmFrustum;
+
+	typedef struct rlmCullingStats
+	{
+		int modelsVisible;
+		int modelsCulled;
+		int meshesVisible;
+		int meshesCulled;
+	}rlmCullingStats;
+
+	typedef struct rlmBoundsTreeNode
+	{
+		BoundingBox bounds;	// leaves are grown by the tree margin
+		int parent;			// next free node when unused
+		int child1;			// -1 for leaves
+		int child2;
+		int height;			// 0 for leaves, -1 for unused nodes
+		int userId;
+	}rlmBoundsTreeNode;
+
+	typedef struct rlmBoundsTree	// dynamic AABB tree over instance world bounds
+	{
+		int root;
+		int nodeCount;
+		int nodeCapacity;
+		int leafCount;
+		int freeList;
+		float margin;		// leaves that move less than this are not reinserted
+
+		rlmBoundsTreeNode* nodes;
+	}rlmBoundsTree;
+
+	typedef struct rlmPoseCache	// shared poses for one sequence on one skeleton, sampled at a fixed rate
+	{
+		const rlmSkeleton* skeleton;
+		const rlmModelAniamtionSequence* sequence;
+
+		float sampleRate;	// slots per second
+		int slotCount;
+		int boneCount;
+
+		Matrix* boneMatricies;	// slotCount * boneCount, slot major
+		bool* validSlots;	// slots are filled on first use, unless the cache was baked
+		bool baked;
+
+		unsigned int hits;	// only counted by rlmGetCachedPose and rlmAdvanceAnimationInstance, not by the animation workers
+		unsigned int misses;
+	}rlmPoseCache;
+
 	typedef struct rlmAnimatedModelInstance
 	{
 		rlmModel* model;
@@ -161,6 +403,10 @@ extern "C" {            // Prevents name mangling of functions
 
 		rlmModelAnimationPose currentPose;
 
+		rlmPoseCache* poseCaches;		// optional, one per sequence in the set, the instance then shares cached poses instead of evaluating currentPose,
+											// cached poses snap to the sample rate and ignore interpolate and the animation LOD bone depth
+		rlmModelAnimationPose cachedPose;	// read only view into the pose cache
+
 		int currentSequence;
 		int currentFrame;
 
@@ -169,10 +415,50 @@ extern "C" {            // Prevents name mangling of functions
 		float currentParam;
 
 		rlmPQSTransorm transform;
+
+		int lodLevel;			// set by rlmUpdateAnimationInstanceLOD, the animation LOD level plus one, 0 for full quality
+		int lodSkippedUpdates;
+		float lodPendingTime;
 	}rlmAnimatedModelInstance;
 
 	// meshes
-	void rlmUploadMesh(rlmMesh* mesh, bool releaseGeoBuffers);
+	void rlmUploadMesh(rlmMesh* mesh, bool releaseGeoBuffers);	// uses the default vertex layout
+	void rlmUploadMeshEx(rlmMesh* mesh, bool releaseGeoBuffers, int vertexLayout);	// rlmVertexLayoutFlags, the half float flags are dropped on OpenGL ES 2
+	void rlmSetDefaultVertexLayout(int vertexLayout);	// also used for static batches
+	int rlmGetDefaultVertexLayout();
+	int rlmGetVertexLayoutSize(int vertexLayout, const rlmMeshBuffers* buffers);	// bytes per vertex for the attributes the buffers have
+
+	// the mesh arena places meshes with the same vertex format in shared pages, one vertex array per page,
+	// drawn with base vertex offsets so meshes in the same page draw without binding anything in between
+	// the layout is always interleaved in the arena, meshes fall back to rlmUploadMeshEx without OpenGL 3.3
+	bool rlmUploadMeshToArena(rlmMesh* mesh, bool releaseGeoBuffers, int vertexLayout);	// false when it was uploaded with rlmUploadMeshEx instead
+	void rlmSetUseMeshArena(bool enabled);	// rlmUploadMesh and the raylib model imports put meshes in the arena (default off)
+	bool rlmGetUseMeshArena();	// false without OpenGL 3.3, even when enabled
+	rlmMeshArenaStats rlmGetMeshArenaStats();
+	void rlmDefragmentMeshArena();	// packs every page's allocations together, pages also do this on their own when a fitting hole is missing
+	void rlmUnloadMeshArena();	// frees every page, only call once the meshes in it are unloaded
+
+	// welds vertices that match, reorders the triangles for the post transform cache and the vertices for fetching
+	// positions within weldDistance of a vertex already kept are merged into it when every other attribute matches, 0 only merges exact copies
+	// 32 bit indices are used when the result has more vertices than 16 bit indices can reach
+	// run it before uploading and before making LODs, they index the old vertex order
+	bool rlmOptimizeMeshBuffers(rlmMeshBuffers* buffers, float weldDistance, rlmMeshOptimizeReport* report);	// report can be NULL
+	float rlmGetMeshBuffersACMR(const rlmMeshBuffers* buffers, int cacheSize);
+
+	// mesh LODs, generated levels need the mesh buffers, each one is reduced from the one before it by the given ratio
+	int rlmGenerateMeshLODs(rlmMesh* mesh, int levelCount, float reduction, float maxError);	// returns the number of levels made
+	void rlmGenerateModelLODs(rlmModel* model, int levelCount, float reduction, float maxError);
+	bool rlmAddMeshLOD(rlmMesh* mesh, const unsigned short* indices, int triangleCount, float screenSize);	// indices into the mesh's own vertices
+	void rlmSetMeshLODScreenSize(rlmMesh* mesh, int level, float screenSize);	// level 1 is the first reduced level
+	int rlmSelectMeshLOD(const rlmMesh* mesh, float screenSize, int currentLevel);	// a current level of -1 skips the hysteresis
+	rlmMeshLODReport rlmGetMeshLODReport(const rlmMesh* mesh);
+
+	// static batching, merges each group's meshes so rlmDrawModel draws them with one call per batch
+	// needs the mesh buffers, skinned groups and groups with mesh transforms are left alone, disabled and culled meshes are skipped by drawing around them
+	// batches hold the full detail meshes, so rlmDrawModel draws a batched group without its mesh LODs, rlmSubmit still uses them
+	bool rlmBatchModelGroup(rlmModelGroup* group);
+	int rlmBatchModel(rlmModel* model);	// returns the number of groups batched
+	void rlmUnbatchModelGroup(rlmModelGroup* group);
 
 	// materials
 	rlmMaterialDef rlmGetDefaultMaterial();
@@ -198,14 +484,80 @@ extern "C" {            // Prevents name mangling of functions
 
 	void rlmApplyMaterialDef(rlmMaterialDef* material);
 
+	// rlmDrawModel keeps the mesh LOD hysteresis in each group's meshLODLevels, shared by every draw of the model,
+	// so a model drawn at several transforms flickers between levels unless it goes through rlmDrawModelEx or rlmSubmitEx
 	void rlmDrawModel(rlmModel model, rlmPQSTransorm transform);
 
+	// pass each instance's own levels, one int per mesh in group order starting at 0, NULL picks the LODs without hysteresis
+	// the instanced fallbacks and rlmDrawBoundsTreeModels always draw without hysteresis
+	void rlmDrawModelEx(rlmModel model, rlmPQSTransorm transform, int* meshLODLevels);
+	int rlmGetModelMeshCount(rlmModel model);	// the size of the LOD level array
+
 	void rlmDrawModelWithPose(rlmModel model, rlmPQSTransorm transform, rlmModelAnimationPose* pose);
 
 	void rlmDrawModelWithPoseEx(rlmModel model, rlmPQSTransorm transform, rlmModelAnimationPose* pose, Shader* shader);
 
+	// one draw per mesh for all the instances, shaders can take the per instance model matrix as "in mat4 instanceTransform"
+	// and the tint as "in vec4 instanceTint", materials whose shaders don't are drawn with a built in shader using the base channel
+	// GL versions without instancing draw the instances one at a time, with the tint multiplied into each group's base channel color
+	// instanced draws always use the full detail meshes, mesh LODs are not picked per instance, draw far instances with
+	// rlmDrawModelEx or rlmSubmitEx to get their LODs, only the one at a time fallback picks LODs (without hysteresis)
+	void rlmDrawModelInstanced(rlmModel model, const rlmPQSTransorm* transforms, int count);
+	void rlmDrawModelInstancedEx(rlmModel model, const rlmPQSTransorm* transforms, const Color* tints, int count); // tints can be NULL
+
+	// skinned crowds, on OpenGL 4.3 the palettes of all the instances go in one storage buffer range and shaders read
+	// "boneMatrices[gl_InstanceID*bonePaletteStride + boneId]" from an "rlmBonePalette" block, other versions draw one at a time
+	void rlmDrawModelInstancedWithPoses(rlmModel model, const rlmPQSTransorm* transforms, rlmModelAnimationPose* poses, int count);
+
+	// deferred drawing, meshes are sorted by pass, shader, texture, mesh and depth when flushed
+	// materials with a base color alpha under 255 are drawn after opaque ones, back to front without depth writes
+	// models must stay valid until the flush, which has to happen inside the 3d mode they are drawn with
+	// poses are copied when submitted, so one pose can be set and submitted again for every instance
+	void rlmBeginQueue();
+	void rlmSubmit(rlmModel model, rlmPQSTransorm transform);
+	void rlmSubmitWithPose(rlmModel model, rlmPQSTransorm transform, rlmModelAnimationPose* pose);
+	void rlmSubmitEx(rlmModel model, rlmPQSTransorm transform, rlmModelAnimationPose* pose, int* meshLODLevels);	// LOD levels as in rlmDrawModelEx, pose can be NULL
+	rlmRenderQueueStats rlmFlushQueue();
+	void rlmUnloadQueue();	// frees the queue memory
+
+	// OpenGL 4.3 multi draw indirect, packed meshes are copied into shared buffers and queued packets using them are drawn
+	// with one glMultiDrawElementsIndirect per material, the model matrix of each draw is read from a shader storage buffer
+	// materials opt in with a shader that reads "drawTransforms[int(drawIndex)]", see rlmGetMultiDrawShader
+	// drawIndex has to be declared "layout(location = 15) in float drawIndex", shaders that put it anywhere else draw one mesh at a time
+	// skinned and posed draws, mesh LODs and other GL versions keep using one draw per mesh, drawIndex reads an identity transform for those
+	bool rlmIsMultiDrawSupported();
+	bool rlmPackModelForMultiDraw(rlmModel model);	// returns false if any mesh could not be packed
+	void rlmSetMultiDraw(bool enabled);	// default on, only used when supported
+	Shader rlmGetMultiDrawShader();	// built in shader with the base channel, owned by rlModels
+
+	// frustum culling, boxes without a size are always visible
+	rlmFrustum rlmGetFrustumFromMatrix(Matrix viewProjection);
+	rlmFrustum rlmGetCurrentFrustum();	// from the rlgl modelview and projection, call inside the 3d mode
+	bool rlmIsBoxInFrustum(const rlmFrustum* frustum, BoundingBox box);
+	int rlmCullBoxes(const rlmFrustum* frustum, const BoundingBox* boxes, int count, bool* visible);	// returns the visible count
+	BoundingBox rlmGetModelBounds(rlmModel model);	// model space, with the orientation and mesh transforms
+	BoundingBox rlmGetModelWorldBounds(rlmModel model, rlmPQSTransorm transform);
+
+	// bounds trees, leaves hold a user id, usually the index of the instance in the caller's arrays
+	rlmBoundsTree rlmLoadBoundsTree(float margin);
+	void rlmUnloadBoundsTree(rlmBoundsTree* tree);
+	int rlmAddBoundsTreeLeaf(rlmBoundsTree* tree, BoundingBox bounds, int userId);	// returns the leaf id
+	void rlmRemoveBoundsTreeLeaf(rlmBoundsTree* tree, int leaf);
+	bool rlmMoveBoundsTreeLeaf(rlmBoundsTree* tree, int leaf, BoundingBox bounds);	// returns true if the leaf had to be reinserted
+
+	// queries write the user ids of the leaves they hit and return how many were written
+	int rlmQueryBoundsTreeFrustum(const rlmBoundsTree* tree, const rlmFrustum* frustum, int* userIds, int maxResults);
+	int rlmQueryBoundsTreeBox(const rlmBoundsTree* tree, BoundingBox box, int* userIds, int maxResults);
+	int rlmQueryBoundsTreeRay(const rlmBoundsTree* tree, Ray ray, float maxDistance, int* userIds, int maxResults);
+
+	// draws the leaves inside the camera frustum, user ids index the model and transform arrays, returns the number drawn
+	int rlmDrawBoundsTreeModels(const rlmBoundsTree* tree, const rlmModel* models, const rlmPQSTransorm* transforms);
+	int rlmDrawBoundsTreeInstanced(const rlmBoundsTree* tree, rlmModel model, const rlmPQSTransorm* transforms, const Color* tints);	// tints can be NULL
+
 
 	// animations
+	void rlmCompileSkeleton(rlmSkeleton* skeleton);	// done on first use for hand built skeletons, call it again after editing the bones or the binding frame
+
 	rlmModelAnimationPose rlmLoadPoseFromModel(rlmModel model);
 	void rlmUnloadPose(rlmModelAnimationPose* pose);
 
@@ -215,13 +567,46 @@ extern "C" {            // Prevents name mangling of functions
 	void rlmSetPoseToKeyframesLerp(rlmModel model, rlmModelAnimationPose* pose, rlmAnimationKeyframe frame1, rlmAnimationKeyframe frame2, float param);
 	void rlmSetPoseToKeyframesLerpEx(rlmModel model, rlmModelAnimationPose* pose, rlmAnimationKeyframe frame1, rlmAnimationKeyframe frame2, float param, rlmBoneInfo* startBone);
 
+	void rlmSampleSequenceAtTime(rlmModel model, const rlmModelAniamtionSequence* sequence, float time, rlmModelAnimationPose* pose); // time in seconds, loops
+
+	rlmAnimationBoneMask rlmLoadBoneMask(rlmModel model, float weight);
+	void rlmSetBoneMaskWeight(rlmModel model, rlmAnimationBoneMask* mask, rlmBoneInfo* startBone, float weight); // sets the bone and all its children
+	void rlmUnloadBoneMask(rlmAnimationBoneMask* mask);
+
+	// weighted average of up to RLM_MAX_BLEND_LAYERS layers, bones with no weight get the binding pose
+	void rlmBlendAnimationLayers(rlmModel model, const rlmAnimationBlendLayer* layers, int layerCount, rlmModelAnimationPose* pose);
+
+	rlmPoseCache rlmLoadPoseCache(rlmModel model, const rlmModelAniamtionSequence* sequence, float sampleRate);
+	void rlmBakePoseCache(rlmModel model, rlmPoseCache* cache);
+	void rlmUnloadPoseCache(rlmPoseCache* cache);
+	// the returned pose is owned by the cache, do not unload it. poses snap to the nearest earlier slot, there is no interpolation.
+	// not thread safe, rlmAdvanceAnimationInstances bakes any unbaked cache and only reads it from the workers
+	rlmModelAnimationPose rlmGetCachedPose(rlmModel model, rlmPoseCache* cache, float time);
+
+	rlmPoseCache* rlmLoadPoseCacheSet(rlmModel model, const rlmModelAnimationSet* set, float sampleRate, bool bake);
+	void rlmUnloadPoseCacheSet(rlmPoseCache* caches, int count);
+
 	rlmBoneInfo* rlmFindBoneByName(rlmModel model, const char* boneName);
+	int rlmFindBoneIdByName(rlmModel model, const char* boneName); // -1 if not found, the id is stable for the life of the skeleton
 
 	void rlmAdvanceAnimationInstance(rlmAnimatedModelInstance* instance, float deltaTime);
+	void rlmAdvanceAnimationInstances(rlmAnimatedModelInstance* instances, int count, float deltaTime); // spread over the animation workers, if any
 	void rlmSetAnimationInstanceSequence(rlmAnimatedModelInstance* instance, int sequence);
+	rlmModelAnimationPose* rlmGetAnimationInstancePose(rlmAnimatedModelInstance* instance); // the pose to draw, cached or not
+
+	// closer than the nearest level's distance instances animate at full quality
+	int rlmAddAnimationLODLevel(rlmModel* model, float distance, int updateInterval, bool interpolate, int maxBoneDepth);	// returns the index in the sorted levels
+	void rlmUpdateAnimationInstanceLOD(rlmAnimatedModelInstance* instance, Vector3 viewPosition);
+	void rlmUpdateAnimationInstancesLOD(rlmAnimatedModelInstance* instances, int count, Vector3 viewPosition);
+
+	void rlmLoadSequenceKeyframes(rlmModelAniamtionSequence* sequence, int keyframeCount, int boneCount);
+
+	// maxError is in model units for positions and scales, and quaternion components for rotations
+	bool rlmCompressAnimationSequence(rlmModelAniamtionSequence* sequence, int boneCount, float maxError, rlmAnimationCompressionReport* report);
+	rlmPQSTransorm rlmDecodeCompressedTransform(const rlmCompressedSequence* sequence, int boneId, int frame);
 
 	void rlmUnloadAnimationPose(rlmModelAnimationPose* pose);
-	void rlmUnloadAnimationKeyframe(rlmAnimationKeyframe* keyframe);
+	void rlmUnloadAnimationKeyframe(rlmAnimationKeyframe* keyframe);	// does nothing for keyframes made by rlmLoadSequenceKeyframes
 	void rlmUnloadAnimationSequence(rlmModelAniamtionSequence* sequence);
 	void rlmUnloadAnimationSet(rlmModelAnimationSet* set);
 
@@ -241,6 +626,39 @@ extern "C" {            // Prevents name mangling of functions
 	void rlmSetDefaultMaterialShader(Shader shader);
 	void rlmClearDefaultMaterialShader();
 
+	void rlmSetAnimationSIMD(bool enabled);	// use the SIMD keyframe lerp path when the build supports it (default on)
+	bool rlmIsAnimationSIMDSupported();
+
+	void rlmSetAnimationWorkerCount(int count);	// threads used by rlmAdvanceAnimationInstances along with the caller, 0 (default) stops them all
+	int rlmGetAnimationWorkerCount();
+
+	void rlmSetFrustumCulling(bool enabled);	// cull unposed models, meshes and instances against the camera when drawing (default on)
+	// skip culling for one call, for draws the caller culled already or that are seen from somewhere else, like shadow passes
+	void rlmDrawModelUnculled(rlmModel model, rlmPQSTransorm transform, int* meshLODLevels);	// LOD levels as in rlmDrawModelEx, can be NULL
+	void rlmDrawModelInstancedUnculled(rlmModel model, const rlmPQSTransorm* transforms, const Color* tints, int count);	// tints can be NULL
+	rlmCullingStats rlmGetCullingStats();
+
+	void rlmSetMeshLODSelection(bool enabled);	// pick mesh LODs by projected size when drawing (default on)
+	void rlmSetMeshLODHysteresis(float fraction);	// how far past a threshold the size has to go before switching back (default 0.1)
+	void rlmResetCullingStats();
+
+	// shaders that declare "uniform rlmBonePalette { mat4 boneMatrices[128]; };" (or a storage block of the same name on OpenGL 4.3)
+	// get their bones from a shared buffer, written once per pose per draw call, instead of a uniform array set for every group
+	// the format follows what the shader declares, "boneMatrices" for mat4, "vec4 boneMatrices3x4[]" or an "rlmBonePalette3x4" block
+	// for affine rows and "vec4 boneDualQuats[]" with "vec4 boneScales[]" for dual quaternions, see the skinning shaders in resources
+	int rlmGetBonePaletteSize(rlmBonePaletteFormat format, int boneCount);	// in floats
+	void rlmWriteBonePalette(const Matrix* bones, int boneCount, rlmBonePaletteFormat format, float* destination);
+	rlmBoneUploadStats rlmGetBoneUploadStats();
+	void rlmResetBoneUploadStats();
+
+	// uniforms are only cached inside one draw call, so values set with SetShaderValue between draws are kept
+	void rlmResetStateCache();	// forgets everything cached about every shader
+	void rlmForgetShader(Shader shader);	// call when unloading a shader rlModels drew with, a new shader can get its id
+	void rlmUnloadInstancingResources();	// frees the instance buffer and built in instancing shader, call before closing the window
+	void rlmUnloadBoundsTreeResources();	// frees the scratch memory used to draw bounds trees
+	void rlmUnloadBonePaletteResources();	// frees the shared bone palette buffer and bone staging memory
+	void rlmUnloadMultiDrawResources();	// frees the shared buffers and shader, packed meshes have to be packed again to use them
+
 #if defined (RLMODELS_IMPLEMENTATION)
 	// TODO put the guts here once it all works
 #endif
@@ -8,8 +8,11 @@ extern "C" {            // Prevents name mangling of functions
 	// todo, make this a simple convert function, there is no need to preserve the old model
 	rlmModel rlmLoadFromModel(Model raylibModel);
 	rlmModel rlmLoadFromModelEX(Model raylibModel, bool keepCPUData);
+	rlmModel rlmLoadFromModelWithLODs(Model raylibModel, bool keepCPUData, int lodLevels, float reduction, float maxError);	// builds mesh LODs while the CPU data is still around
+	rlmModel rlmLoadFromModelOptimized(Model raylibModel, bool keepCPUData, int lodLevels, float reduction, float maxError, float weldDistance, rlmMeshOptimizeReport* report);	// runs rlmOptimizeMeshBuffers on each mesh and uploads it again, report gets the totals and can be NULL
 
 	rlmModelAniamtionSequence* rlmLoadModelAnimations(rlmSkeleton* skeleton, ModelAnimation* animations, int animationCount);
+	rlmModelAniamtionSequence* rlmLoadModelAnimationsCompressed(rlmSkeleton* skeleton, ModelAnimation* animations, int animationCount, float maxError, rlmAnimationCompressionReport* report);
 #if defined(__cplusplus)
 }
 #endif
\ No newline at end of file
@@ -3,7 +3,37 @@
 #include "rlgl.h"
 #include "config.h"
 
+#include "rlModels_Threads.h"
+#include "rlModels_Simplify.h"
+#include "rlModels_Optimize.h"
+
+#include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
+
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_43)
+#include "glad.h"	// rlgl has no wrappers for uniform blocks, indirect draws or buffer copies
+#endif
+
+// rlgl only draws 16 bit indices
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_43)
+#define RLM_SUPPORT_32BIT_INDICES
+#endif
+
+// indirect draws and shader storage buffers
+#if defined(GRAPHICS_API_OPENGL_43)
+#define RLM_SUPPORT_MULTIDRAW
+#endif
+
+// instanced draws and attribute divisors
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_43) || defined(GRAPHICS_API_OPENGL_ES3)
+#define RLM_SUPPORT_INSTANCING
+#endif
+
+#if !defined(RLM_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define RLM_USE_SSE2
+#include <emmintrin.h>
+#endif
 
 static Shader DefaultMaterialShader = { 0 };
 static bool DefaultMaterialShaderSet = false;
@@ -21,1044 +51,7881 @@ static void CheckGlobalBoneMatricies()
 }
 
 
-void rlmSetDefaultMaterialShader(Shader shader)
+// shadow of the GL state set by the library, so calls that would not change anything are skipped
+// bindings are only trusted inside one draw call, raylib's batch renderer changes them without telling us,
+// so every draw call starts from scratch and ends by unbinding what it used, the same as it always did
+// uniform values are kept per program for one draw call as well, raylib's SetShaderValue and DrawMesh set them in between
+// raylib's default shader is never cached, raylib sets it itself
+#define RLM_STATE_TEXTURE_SLOTS 8
+#define RLM_STATE_VERTEX_ATTRIBUTES 16
+#define RLM_STATE_UNIFORM_CACHE_SIZE 1024	// power of two
+#define RLM_STATE_UNIFORM_PROBES 8
+#define RLM_STATE_UNIFORM_MAX_SIZE 64
+#define RLM_STATE_UNKNOWN_PROGRAM 0xFFFFFFFFu
+
+typedef struct rlmUniformCacheEntry
 {
-	DefaultMaterialShader = shader;
-	DefaultMaterialShaderSet = true;
-}
+	unsigned int program;	// 0 for an empty entry
+	unsigned int generation;	// the draw call that set it, entries from older ones are empty
+	int location;
+	int size;
+	unsigned char value[RLM_STATE_UNIFORM_MAX_SIZE];
+}rlmUniformCacheEntry;
+
+typedef struct rlmStateCache
+{
+	unsigned int program;
+	int activeSlot;		// -1 when unknown
+	unsigned int textures[RLM_STATE_TEXTURE_SLOTS];
+	bool cubeMaps[RLM_STATE_TEXTURE_SLOTS];
+	int attributes[RLM_STATE_VERTEX_ATTRIBUTES];	// -1 unknown, 0 disabled, 1 enabled
 
-void rlmClearDefaultMaterialShader()
+	unsigned int generation;
+	rlmUniformCacheEntry uniforms[RLM_STATE_UNIFORM_CACHE_SIZE];
+}rlmStateCache;
+
+static rlmStateCache StateCache = { 0 };
+static bool StateCacheReady = false;
+
+static void rlmStateForgetBindings()
 {
-	DefaultMaterialShader = (Shader){ 0 };
-	DefaultMaterialShaderSet = false;
+	StateCache.program = 0;
+	StateCache.activeSlot = -1;
+	for (int i = 0; i < RLM_STATE_TEXTURE_SLOTS; i++)
+	{
+		StateCache.textures[i] = 0;
+		StateCache.cubeMaps[i] = false;
+	}
+	for (int i = 0; i < RLM_STATE_VERTEX_ATTRIBUTES; i++)
+		StateCache.attributes[i] = -1;
 }
 
-static void rlUnloadMeshBuffer(rlmMeshBuffers* buffers)
+static void rlmStateCheckReady()
 {
-	if (!buffers)
+	if (StateCacheReady)
 		return;
 
-	MemFree(buffers->vertices);
-	MemFree(buffers->texcoords);
-	MemFree(buffers->texcoords2);
-	MemFree(buffers->normals);
-	MemFree(buffers->tangents);
-	MemFree(buffers->colors);
-	MemFree(buffers->indices);
-	MemFree(buffers->boneIds);
-	MemFree(buffers->boneWeights);
-
-	MemFree(buffers);
+	rlmStateForgetBindings();
+	StateCacheReady = true;
 }
 
-void rlmUploadMesh(rlmMesh* mesh, bool releaseGeoBuffers)
+// every draw entry point starts here, values set outside of it may have changed
+static void rlmStateBeginDraw()
 {
-	if (mesh->gpuMesh.vaoId > 0)
-	{
-		// Check if mesh has already been loaded in GPU
-		TraceLog(LOG_WARNING, "VAO: [ID %i] Trying to re-load an already loaded mesh", mesh->gpuMesh.vaoId);
-		return;
-	}
+	rlmStateCheckReady();
+	rlmStateForgetBindings();
 
-	if (mesh->meshBuffers == NULL)
+	// wrapping around would make entries from long ago look current again
+	if (++StateCache.generation == 0)
 	{
-		// Check if mesh has already been loaded in GPU
-		TraceLog(LOG_WARNING, "Trying to upload a mesh with no mesh buffers");
-		return;
+		memset(StateCache.uniforms, 0, sizeof(StateCache.uniforms));
+		StateCache.generation = 1;
 	}
+}
 
-	mesh->gpuMesh.vboIds = (unsigned int*)MemAlloc(MAX_MESH_VERTEX_BUFFERS * sizeof(unsigned int));
-
-	mesh->gpuMesh.vaoId = 0;        // Vertex Array Object
-	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION] = 0;     // Vertex buffer: positions
-	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD] = 0;     // Vertex buffer: texcoords
-	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL] = 0;       // Vertex buffer: normals
-	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR] = 0;        // Vertex buffer: colors
-	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT] = 0;      // Vertex buffer: tangents
-	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2] = 0;    // Vertex buffer: texcoords2
-	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES] = 0;      // Vertex buffer: indices
-
-#ifdef RL_SUPPORT_MESH_GPU_SKINNING
-	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS] = 0;      // Vertex buffer: boneIds
-	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS] = 0;  // Vertex buffer: boneWeights
-#endif
+static bool rlmStateUseProgram(unsigned int program)
+{
+	rlmStateCheckReady();
+	if (StateCache.program == program)
+		return false;
 
-#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
-	mesh->gpuMesh.vaoId = rlLoadVertexArray();
-	rlEnableVertexArray(mesh->gpuMesh.vaoId);
+	rlEnableShader(program);
+	StateCache.program = program;
+	return true;
+}
 
-	// NOTE: Vertex attributes must be uploaded considering default locations points and available vertex data
+static void rlmStateSetActiveSlot(int slot)
+{
+	if (StateCache.activeSlot == slot)
+		return;
 
-	bool dynamic = !releaseGeoBuffers;
+	rlActiveTextureSlot(slot);
+	StateCache.activeSlot = slot;
+}
 
-	// Enable vertex attributes: position (shader-location = 0)
-	void* vertices = mesh->meshBuffers->vertices;
-	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION] = rlLoadVertexBuffer(vertices, mesh->meshBuffers->vertexCount * 3 * sizeof(float), dynamic);
-	rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 3, RL_FLOAT, 0, 0, 0);
-	rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+static bool rlmStateBindTexture(int slot, unsigned int textureId, bool cubeMap)
+{
+	rlmStateCheckReady();
 
-	// Enable vertex attributes: texcoords (shader-location = 1)
-	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD] = rlLoadVertexBuffer(mesh->meshBuffers->texcoords, mesh->meshBuffers->vertexCount * 2 * sizeof(float), dynamic);
-	rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, 2, RL_FLOAT, 0, 0, 0);
-	rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD);
+	bool tracked = slot >= 0 && slot < RLM_STATE_TEXTURE_SLOTS;
+	if (tracked && StateCache.textures[slot] == textureId && StateCache.cubeMaps[slot] == cubeMap)
+		return false;
 
-	// WARNING: When setting default vertex attribute values, the values for each generic vertex attribute
-	// is part of current state, and it is maintained even if a different program object is used
+	rlmStateSetActiveSlot(slot);
+	if (cubeMap)
+		rlEnableTextureCubemap(textureId);
+	else
+		rlEnableTexture(textureId);
 
-	if (mesh->meshBuffers->normals != NULL)
+	if (tracked)
 	{
-		// Enable vertex attributes: normals (shader-location = 2)
-		void* normals = mesh->meshBuffers->normals;
-		mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL] = rlLoadVertexBuffer(normals, mesh->meshBuffers->vertexCount * 3 * sizeof(float), dynamic);
-		rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, 3, RL_FLOAT, 0, 0, 0);
-		rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL);
+		StateCache.textures[slot] = textureId;
+		StateCache.cubeMaps[slot] = cubeMap;
 	}
+	return true;
+}
+
+static void rlmStateUnbindTexture(int slot, bool cubeMap)
+{
+	rlmStateCheckReady();
+
+	bool tracked = slot >= 0 && slot < RLM_STATE_TEXTURE_SLOTS;
+	if (tracked && StateCache.textures[slot] == 0)
+		return;
+
+	rlmStateSetActiveSlot(slot);
+	if (cubeMap)
+		rlDisableTextureCubemap();
 	else
+		rlDisableTexture();
+
+	if (tracked)
 	{
-		// Default vertex attribute: normal
-		// WARNING: Default value provided to shader if location available
-		float value[3] = { 1.0f, 1.0f, 1.0f };
-		rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, value, SHADER_ATTRIB_VEC3, 3);
-		rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL);
+		StateCache.textures[slot] = 0;
+		StateCache.cubeMaps[slot] = false;
 	}
+}
+
+static void rlmStateEnableAttribute(int index, bool enable)
+{
+	rlmStateCheckReady();
+	if (index < 0)
+		return;
 
-	if (mesh->meshBuffers->colors != NULL)
+	if (index < RLM_STATE_VERTEX_ATTRIBUTES)
 	{
-		// Enable vertex attribute: color (shader-location = 3)
-		mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR] = rlLoadVertexBuffer(mesh->meshBuffers->colors, mesh->meshBuffers->vertexCount * 4 * sizeof(unsigned char), dynamic);
-		rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, 4, RL_UNSIGNED_BYTE, 1, 0, 0);
-		rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR);
+		if (StateCache.attributes[index] == (enable ? 1 : 0))
+			return;
+
+		StateCache.attributes[index] = enable ? 1 : 0;
 	}
+
+	if (enable)
+		rlEnableVertexAttribute(index);
 	else
+		rlDisableVertexAttribute(index);
+}
+
+static rlmUniformCacheEntry* rlmStateFindUniform(unsigned int program, int location)
+{
+	unsigned int hash = (program * 2654435761u) ^ ((unsigned int)location * 40503u);
+	int index = (int)(hash & (RLM_STATE_UNIFORM_CACHE_SIZE - 1));
+
+	rlmUniformCacheEntry* firstEmpty = NULL;
+	for (int probe = 0; probe < RLM_STATE_UNIFORM_PROBES; probe++)
 	{
-		// Default vertex attribute: color
-		// WARNING: Default value provided to shader if location available
-		float value[4] = { 1.0f, 1.0f, 1.0f, 1.0f };    // WHITE
-		rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, value, SHADER_ATTRIB_VEC4, 4);
-		rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR);
+		rlmUniformCacheEntry* entry = &StateCache.uniforms[(index + probe) & (RLM_STATE_UNIFORM_CACHE_SIZE - 1)];
+		bool current = entry->program != 0 && entry->generation == StateCache.generation;
+		if (current && entry->program == program && entry->location == location)
+			return entry;
+
+		if (!current && !firstEmpty)
+			firstEmpty = entry;
 	}
 
-	if (mesh->meshBuffers->tangents != NULL)
+	// it's only a cache, so when the probes are full just take over the first one
+	rlmUniformCacheEntry* entry = firstEmpty ? firstEmpty : &StateCache.uniforms[index];
+	entry->program = program;
+	entry->generation = StateCache.generation;
+	entry->location = location;
+	entry->size = -1;
+	return entry;
+}
+
+// returns true when the cached value matches, and updates it otherwise
+static bool rlmStateUniformMatches(int location, const void* value, int size)
+{
+	rlmStateCheckReady();
+
+	unsigned int program = StateCache.program;
+	if (program == 0 || program == RLM_STATE_UNKNOWN_PROGRAM || program == rlGetShaderIdDefault() || size > RLM_STATE_UNIFORM_MAX_SIZE)
+		return false;
+
+	rlmUniformCacheEntry* entry = rlmStateFindUniform(program, location);
+	if (entry->size == size && memcmp(entry->value, value, size) == 0)
+		return true;
+
+	entry->size = size;
+	memcpy(entry->value, value, size);
+	return false;
+}
+
+static void rlmStateSetUniform(int location, const void* value, int uniformType, int count)
+{
+	if (location < 0)
+		return;
+
+	int componentSize = 4;
+	switch (uniformType)
 	{
-		// Enable vertex attribute: tangent (shader-location = 4)
-		mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT] = rlLoadVertexBuffer(mesh->meshBuffers->tangents, mesh->meshBuffers->vertexCount * 4 * sizeof(float), dynamic);
-		rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT, 4, RL_FLOAT, 0, 0, 0);
-		rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT);
+	case SHADER_UNIFORM_VEC2: case SHADER_UNIFORM_IVEC2: componentSize = 8; break;
+	case SHADER_UNIFORM_VEC3: case SHADER_UNIFORM_IVEC3: componentSize = 12; break;
+	case SHADER_UNIFORM_VEC4: case SHADER_UNIFORM_IVEC4: componentSize = 16; break;
+	default: break;
 	}
-	else
+
+	if (rlmStateUniformMatches(location, value, componentSize * count))
+		return;
+
+	rlSetUniform(location, value, uniformType, count);
+}
+
+static rlmBoneUploadStats BoneUploadStats = { 0 };
+
+// how shaders take their bones, from the name of the uniform array or block they declare
+//   "boneMatrices" / "rlmBonePalette"         mat4 per bone, 64 bytes
+//   "boneMatrices3x4" / "rlmBonePalette3x4"   the top three rows of the matrix as vec4s, 48 bytes
+//   "boneDualQuats" + "boneScales"            real and dual quaternion as two vec4s, plus a float scale packed four to a vec4, 36 bytes
+#define RLM_BONE_PROGRAMS 16	// power of two
+
+typedef struct rlmBoneProgram
+{
+	unsigned int program;	// 0 for an empty entry
+	rlmBonePaletteFormat format;
+	int location;		// uniform array, -1 when there is none
+	int scaleLocation;	// dual quaternion scales
+	unsigned int target;	// palette block, GL_UNIFORM_BUFFER, GL_SHADER_STORAGE_BUFFER or 0 when there is none
+	int strideLoc;		// "bonePaletteStride", bones between instances, 0 outside of instanced draws
+}rlmBoneProgram;
+
+static rlmBoneProgram BonePrograms[RLM_BONE_PROGRAMS] = { 0 };
+static float* BoneStaging = NULL;
+static int BoneStagingCapacity = 0;
+
+int rlmGetBonePaletteSize(rlmBonePaletteFormat format, int boneCount)
+{
+	switch (format)
 	{
-		// Default vertex attribute: tangent
-		// WARNING: Default value provided to shader if location available
-		float value[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-		rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT, value, SHADER_ATTRIB_VEC4, 4);
-		rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT);
+	case RLM_BONE_PALETTE_AFFINE: return boneCount * 12;
+	case RLM_BONE_PALETTE_DUAL_QUAT: return boneCount * 8 + ((boneCount + 3) / 4) * 4;
+	default: return boneCount * 16;
 	}
+}
 
-	if (mesh->meshBuffers->texcoords2 != NULL)
+void rlmWriteBonePalette(const Matrix* bones, int boneCount, rlmBonePaletteFormat format, float* destination)
+{
+	if (format == RLM_BONE_PALETTE_AFFINE)
+	{
+		for (int i = 0; i < boneCount; i++)
+		{
+			const Matrix* m = &bones[i];
+			float* row = destination + i * 12;
+			row[0] = m->m0; row[1] = m->m4; row[2] = m->m8; row[3] = m->m12;
+			row[4] = m->m1; row[5] = m->m5; row[6] = m->m9; row[7] = m->m13;
+			row[8] = m->m2; row[9] = m->m6; row[10] = m->m10; row[11] = m->m14;
+		}
+	}
+	else if (format == RLM_BONE_PALETTE_DUAL_QUAT)
 	{
-		// Enable vertex attribute: texcoord2 (shader-location = 5)
-		mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2] = rlLoadVertexBuffer(mesh->meshBuffers->texcoords2, mesh->meshBuffers->vertexCount * 2 * sizeof(float), dynamic);
-		rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2, 2, RL_FLOAT, 0, 0, 0);
-		rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2);
+		float* scales = destination + boneCount * 8;
+		for (int i = 0; i < boneCount; i++)
+		{
+			const Matrix* m = &bones[i];
+
+			// dual quaternions can't hold a non uniform scale, so it is averaged
+			float sx = sqrtf(m->m0 * m->m0 + m->m1 * m->m1 + m->m2 * m->m2);
+			float sy = sqrtf(m->m4 * m->m4 + m->m5 * m->m5 + m->m6 * m->m6);
+			float sz = sqrtf(m->m8 * m->m8 + m->m9 * m->m9 + m->m10 * m->m10);
+			float scale = (sx + sy + sz) / 3.0f;
+
+			Matrix rotation = *m;
+			if (sx > 0 && sy > 0 && sz > 0)
+			{
+				rotation.m0 /= sx; rotation.m1 /= sx; rotation.m2 /= sx;
+				rotation.m4 /= sy; rotation.m5 /= sy; rotation.m6 /= sy;
+				rotation.m8 /= sz; rotation.m9 /= sz; rotation.m10 /= sz;
+			}
+			Quaternion real = QuaternionNormalize(QuaternionFromMatrix(rotation));
+
+			// dual part is half the translation times the rotation
+			float tx = m->m12, ty = m->m13, tz = m->m14;
+			float* dq = destination + i * 8;
+			dq[0] = real.x; dq[1] = real.y; dq[2] = real.z; dq[3] = real.w;
+			dq[4] = 0.5f * (tx * real.w + ty * real.z - tz * real.y);
+			dq[5] = 0.5f * (-tx * real.z + ty * real.w + tz * real.x);
+			dq[6] = 0.5f * (tx * real.y - ty * real.x + tz * real.w);
+			dq[7] = -0.5f * (tx * real.x + ty * real.y + tz * real.z);
+
+			scales[i] = scale;
+		}
+
+		for (int i = boneCount; i < ((boneCount + 3) / 4) * 4; i++)
+			scales[i] = 1.0f;
 	}
 	else
 	{
-		// Default vertex attribute: texcoord2
-		// WARNING: Default value provided to shader if location available
-		float value[2] = { 0.0f, 0.0f };
-		rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2, value, SHADER_ATTRIB_VEC2, 2);
-		rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2);
+		for (int i = 0; i < boneCount; i++)
+		{
+			float16 matrix = MatrixToFloatV(bones[i]);
+			memcpy(destination + i * 16, matrix.v, sizeof(matrix.v));
+		}
 	}
+}
 
-#ifdef RL_SUPPORT_MESH_GPU_SKINNING
-	if (mesh->meshBuffers->boneIds != NULL)
+// bone arrays are too big to compare, but the default bones never change, so only their count is cached
+static void rlmStateSetBoneMatrices(int location, const Matrix* matrices, int count)
+{
+	if (location < 0)
+		return;
+
+	if (matrices == DefaultBoneMatricies)
 	{
-		// Enable vertex attribute: boneIds (shader-location = 7)
-		mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS] = rlLoadVertexBuffer(mesh->meshBuffers->boneIds, mesh->meshBuffers->vertexCount * 4 * sizeof(unsigned char), dynamic);
-		rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS, 4, RL_UNSIGNED_BYTE, 0, 0, 0);
-		rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS);
+		if (rlmStateUniformMatches(location, &count, sizeof(int)))
+			return;
 	}
-	else
+	else if (StateCache.program != 0 && StateCache.program != RLM_STATE_UNKNOWN_PROGRAM)
 	{
-		// Default vertex attribute: boneIds
-		// WARNING: Default value provided to shader if location available
-		float value[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-		rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS, value, SHADER_ATTRIB_VEC4, 4);
-		rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS);
+		rlmStateFindUniform(StateCache.program, location)->size = -1;
 	}
 
-	if (mesh->meshBuffers->boneWeights != NULL)
+	rlSetUniformMatrices(location, matrices, count);
+
+	BoneUploadStats.uploads++;
+	BoneUploadStats.bytes += count * (int)sizeof(float16);
+}
+
+// the compact formats go through the same count only caching for the default bones
+static void rlmStateSetCompactBones(const rlmBoneProgram* bones, const Matrix* matrices, int count)
+{
+	if (matrices == DefaultBoneMatricies)
 	{
-		// Enable vertex attribute: boneWeights (shader-location = 8)
-		mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS] = rlLoadVertexBuffer(mesh->meshBuffers->boneWeights, mesh->meshBuffers->vertexCount * 4 * sizeof(float), dynamic);
-		rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS, 4, RL_FLOAT, 0, 0, 0);
-		rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS);
+		if (rlmStateUniformMatches(bones->location, &count, sizeof(int)))
+			return;
 	}
-	else
+	else if (StateCache.program != 0 && StateCache.program != RLM_STATE_UNKNOWN_PROGRAM)
 	{
-		// Default vertex attribute: boneWeights
-		// WARNING: Default value provided to shader if location available
-		float value[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-		rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS, value, SHADER_ATTRIB_VEC4, 2);
-		rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS);
+		rlmStateFindUniform(StateCache.program, bones->location)->size = -1;
 	}
-#endif
 
-	if (mesh->meshBuffers->indices != NULL)
+	int size = rlmGetBonePaletteSize(bones->format, count);
+	if (size > BoneStagingCapacity)
 	{
-		mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES] = rlLoadVertexBufferElement(mesh->meshBuffers->indices, mesh->meshBuffers->triangleCount * 3 * sizeof(unsigned short), dynamic);
+		BoneStaging = (float*)MemRealloc(BoneStaging, size * sizeof(float));
+		BoneStagingCapacity = size;
 	}
 
-	if (mesh->gpuMesh.vaoId > 0) TRACELOG(LOG_INFO, "VAO: [ID %i] Mesh uploaded successfully to VRAM (GPU)", mesh->vaoId);
-	else TRACELOG(LOG_INFO, "VBO: Mesh uploaded successfully to VRAM (GPU)");
-
-	rlDisableVertexArray();
-#endif
+	rlmWriteBonePalette(matrices, count, bones->format, BoneStaging);
 
-	if (releaseGeoBuffers)
+	if (bones->format == RLM_BONE_PALETTE_AFFINE)
 	{
-		rlUnloadMeshBuffer(mesh->meshBuffers);
-		mesh->meshBuffers = NULL;
+		rlSetUniform(bones->location, BoneStaging, SHADER_UNIFORM_VEC4, count * 3);
+	}
+	else
+	{
+		rlSetUniform(bones->location, BoneStaging, SHADER_UNIFORM_VEC4, count * 2);
+		if (bones->scaleLocation >= 0)
+			rlSetUniform(bones->scaleLocation, BoneStaging + count * 8, SHADER_UNIFORM_VEC4, (count + 3) / 4);
 	}
+
+	BoneUploadStats.uploads++;
+	BoneUploadStats.bytes += size * (int)sizeof(float);
 }
 
-void rlmUnloadMesh(rlmMesh* mesh)
-{
-	if (!mesh)
-		return;
+// bone palettes, shaders that declare a "rlmBonePalette" uniform block (or storage block on GL 4.3) get their bones from
+// one shared buffer instead of a uniform array, each pose is written once per draw call and every group binds its range
+// the buffer is a ring, when it fills up it is orphaned so the driver can keep the old storage alive for draws in flight
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_43)
+#define RLM_SUPPORT_BONE_PALETTE
+#endif
 
-	MemFree(mesh->name);
-	mesh->name = NULL;
+#if defined(RLM_SUPPORT_BONE_PALETTE)
 
-	rlUnloadVertexArray(mesh->gpuMesh.vaoId);
+#define RLM_BONE_PALETTE_BINDING 1
+#define RLM_BONE_PALETTE_UPLOADS 64		// power of two
+#define RLM_BONE_PALETTE_MIN_SIZE (1024 * 1024)
 
-	if (mesh->gpuMesh.vboIds != NULL)
+typedef struct rlmBonePaletteUpload
+{
+	const Matrix* source;
+	int count;
+	rlmBonePaletteFormat format;
+	int offset;
+	unsigned int serial;
+}rlmBonePaletteUpload;
+
+static rlmBonePaletteUpload BonePaletteUploads[RLM_BONE_PALETTE_UPLOADS] = { 0 };
+
+static unsigned int BonePaletteBuffer = 0;
+static int BonePaletteCapacity = 0;
+static int BonePaletteOffset = 0;
+static int BonePaletteAlignment = 0;
+static unsigned int BonePaletteSerial = 1;	// bumped by every draw call, poses can change between them
+
+static unsigned int rlmFindBonePaletteBlock(unsigned int program, const char* name)
+{
+#if defined(GRAPHICS_API_OPENGL_43)
+	GLuint storageIndex = glGetProgramResourceIndex(program, GL_SHADER_STORAGE_BLOCK, name);
+	if (storageIndex != GL_INVALID_INDEX)
 	{
-		for (int i = 0; i < MAX_MESH_VERTEX_BUFFERS; i++)
-			rlUnloadVertexBuffer(mesh->gpuMesh.vboIds[i]);
+		glShaderStorageBlockBinding(program, storageIndex, RLM_BONE_PALETTE_BINDING);
+		return GL_SHADER_STORAGE_BUFFER;
 	}
-	MemFree(mesh->gpuMesh.vboIds);
+#endif
 
-	mesh->gpuMesh.vaoId = 0;
-	mesh->gpuMesh.vboIds = NULL;
+	GLuint blockIndex = glGetUniformBlockIndex(program, name);
+	if (blockIndex != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(program, blockIndex, RLM_BONE_PALETTE_BINDING);
+		return GL_UNIFORM_BUFFER;
+	}
 
-	rlUnloadMeshBuffer(mesh->meshBuffers);
+	return 0;
 }
 
-rlmMaterialDef rlmGetDefaultMaterial()
+#endif
+
+static const rlmBoneProgram* rlmGetBoneProgram(unsigned int program)
 {
-	rlmMaterialDef material = { 0 };
-	material.name = (char*)MemAlloc(32);
-	material.name[0] = '\0';
-	strcpy(material.name, "rlmDefaultMaterial");
+	rlmBoneProgram* entry = &BonePrograms[(program * 2654435761u) & (RLM_BONE_PROGRAMS - 1)];
+	if (entry->program == program)
+		return entry;
+
+	entry->program = program;
+	entry->format = RLM_BONE_PALETTE_MATRIX;
+	entry->location = rlGetLocationUniform(program, "boneMatrices");
+	entry->scaleLocation = -1;
+	entry->target = 0;
+	entry->strideLoc = -1;
+
+	if (entry->location < 0)
+	{
+		entry->format = RLM_BONE_PALETTE_AFFINE;
+		entry->location = rlGetLocationUniform(program, "boneMatrices3x4");
+	}
 
-	if (DefaultMaterialShaderSet)
+	if (entry->location < 0)
 	{
-		material.shader.id = DefaultMaterialShader.id;
-		material.shader.locs = DefaultMaterialShader.locs;
-		material.ownsShader = false;
+		entry->format = RLM_BONE_PALETTE_DUAL_QUAT;
+		entry->location = rlGetLocationUniform(program, "boneDualQuats");
+		entry->scaleLocation = rlGetLocationUniform(program, "boneScales");
 	}
-	else
+
+#if defined(RLM_SUPPORT_BONE_PALETTE)
+	if (entry->location < 0)
 	{
-		material.shader.id = rlGetShaderIdDefault();
-		material.shader.locs = rlGetShaderLocsDefault();
-		material.ownsShader = true;
+		entry->format = RLM_BONE_PALETTE_MATRIX;
+		entry->target = rlmFindBonePaletteBlock(program, "rlmBonePalette");
+		if (entry->target == 0)
+		{
+			entry->format = RLM_BONE_PALETTE_AFFINE;
+			entry->target = rlmFindBonePaletteBlock(program, "rlmBonePalette3x4");
+		}
+
+		if (entry->target != 0)
+			entry->strideLoc = rlGetLocationUniform(program, "bonePaletteStride");
 	}
+#endif
 
-	material.baseChannel.ownsTexture = false;
-	material.baseChannel.textureId = rlGetTextureIdDefault();
-	material.baseChannel.textureLoc = -1;
+	return entry;
+}
 
-	material.baseChannel.color = WHITE;
-	material.baseChannel.colorLoc = -SHADER_LOC_COLOR_DIFFUSE;
+static void rlmForgetBoneProgram(unsigned int program)
+{
+	rlmBoneProgram* entry = &BonePrograms[(program * 2654435761u) & (RLM_BONE_PROGRAMS - 1)];
+	if (entry->program == program)
+		entry->program = 0;
+}
 
-	material.extraChannels = 0;
-	material.extraChannels = NULL;
+#if defined(RLM_SUPPORT_INSTANCING)
 
-	return material;
+// instance attribute locations per program, so instanced draws don't look them up for every group
+#define RLM_INSTANCE_PROGRAMS 16	// power of two
+
+typedef struct rlmInstanceProgram
+{
+	unsigned int program;	// 0 for an empty entry
+	int transformLoc;	// "instanceTransform", -1 when the shader doesn't take instances
+	int tintLoc;		// "instanceTint"
+}rlmInstanceProgram;
+
+static rlmInstanceProgram InstancePrograms[RLM_INSTANCE_PROGRAMS] = { 0 };
+
+static const rlmInstanceProgram* rlmGetInstanceProgram(unsigned int program)
+{
+	rlmInstanceProgram* entry = &InstancePrograms[(program * 2654435761u) & (RLM_INSTANCE_PROGRAMS - 1)];
+	if (entry->program == program)
+		return entry;
+
+	entry->program = program;
+	entry->transformLoc = rlGetLocationAttrib(program, "instanceTransform");
+	entry->tintLoc = rlGetLocationAttrib(program, "instanceTint");
+
+	return entry;
 }
 
-void rlmUnloadMaterial(rlmMaterialDef* material)
+static void rlmForgetInstanceProgram(unsigned int program)
 {
-	if (!material)
-		return;
+	rlmInstanceProgram* entry = &InstancePrograms[(program * 2654435761u) & (RLM_INSTANCE_PROGRAMS - 1)];
+	if (entry->program == program)
+		entry->program = 0;
+}
 
-	MemFree(material->name);
-	material->name = NULL;
+#endif
 
-	if (material->ownsShader)
+#if defined(RLM_SUPPORT_BONE_PALETTE)
+
+// returns the byte offset of room for size bytes, after orphaning or growing the buffer if needed
+static int rlmReserveBonePalette(int size)
+{
+	if (BonePaletteAlignment == 0)
 	{
-		if (material->shader.id != rlGetShaderIdDefault())
-		{
-			rlUnloadShaderProgram(material->shader.id);
-			MemFree(material->shader.locs);
-		}
-		material->shader.locs = NULL;
+		GLint alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+#if defined(GRAPHICS_API_OPENGL_43)
+		GLint storageAlignment = 0;
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+		if (storageAlignment > alignment)
+			alignment = storageAlignment;
+#endif
+		BonePaletteAlignment = alignment > 0 ? alignment : 256;
 	}
 
-	if (material->baseChannel.ownsTexture)
+	int offset = ((BonePaletteOffset + BonePaletteAlignment - 1) / BonePaletteAlignment) * BonePaletteAlignment;
+	if (BonePaletteBuffer == 0 || offset + size > BonePaletteCapacity)
 	{
-		rlUnloadTexture(material->baseChannel.textureId);
-		material->baseChannel.textureId = 0;
+		if (BonePaletteBuffer == 0)
+			glGenBuffers(1, &BonePaletteBuffer);
+
+		int capacity = BonePaletteCapacity > 0 ? BonePaletteCapacity : RLM_BONE_PALETTE_MIN_SIZE;
+		while (capacity < size)
+			capacity *= 2;
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, BonePaletteBuffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, capacity, NULL, GL_STREAM_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		BonePaletteCapacity = capacity;
+
+		// everything written so far is in the old storage
+		memset(BonePaletteUploads, 0, sizeof(BonePaletteUploads));
+		offset = 0;
 	}
 
-	for (int i = 0; i < material->materialChannels; i++)
+	BonePaletteOffset = offset + size;
+	return offset;
+}
+
+// writes the palettes one after the other, each starting stride bones after the last, returns the byte offset or -1
+static int rlmWriteBonePalettes(const Matrix* const* palettes, int paletteCount, int count, int stride, rlmBonePaletteFormat format)
+{
+	int boneSize = rlmGetBonePaletteSize(format, 1) * (int)sizeof(float);
+	int size = ((paletteCount - 1) * stride + count) * boneSize;
+	int offset = rlmReserveBonePalette(size);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, BonePaletteBuffer);
+
+	// the ring never hands out a range twice before orphaning, so there is nothing to wait for
+	float* destination = (float*)glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (destination)
 	{
-		if (material->extraChannels[i].ownsTexture)
-			rlUnloadTexture(material->extraChannels[i].textureId);
-		material->extraChannels[i].textureId = 0;
+		for (int palette = 0; palette < paletteCount; palette++)
+			rlmWriteBonePalette(palettes[palette], count, format, destination + (palette * stride * boneSize) / (int)sizeof(float));
+
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
 	}
 
-	if (material->values)
-		MemFree(material->values);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
 
-	material->values = NULL;
-	material->materialValues = 0;
+	BoneUploadStats.uploads += paletteCount;
+	BoneUploadStats.bytes += paletteCount * count * boneSize;
+
+	return destination ? offset : -1;
 }
 
-void rlmAddMaterialChannel(rlmMaterialDef* material, Texture2D texture, int shaderLoc, int slot, bool isCubeMap)
+static void rlmBindBonePaletteRange(const rlmBoneProgram* bones, int offset, int count, int stride)
 {
-	if (!material)
-		return;
+	glBindBufferRange(bones->target, RLM_BONE_PALETTE_BINDING, BonePaletteBuffer, offset, rlmGetBonePaletteSize(bones->format, count) * sizeof(float));
+	BoneUploadStats.paletteBinds++;
 
-	if (material->materialChannels == 0 || !material->extraChannels)
-	{
-		material->materialChannels = 1;
-		material->extraChannels = (rlmMaterialChannel*)MemAlloc(sizeof(rlmMaterialChannel));
+	if (bones->strideLoc >= 0)
+		rlmStateSetUniform(bones->strideLoc, &stride, SHADER_UNIFORM_INT, 1);
+}
+
+static void rlmBindBonePalette(const rlmBoneProgram* bones, const Matrix* matrices, int count)
+{
+	rlmBonePaletteUpload* upload = &BonePaletteUploads[(((size_t)matrices >> 4) + bones->format) & (RLM_BONE_PALETTE_UPLOADS - 1)];
+
+	// the default bones never change, so they stay valid until the buffer is orphaned
+	bool current = upload->serial == BonePaletteSerial || matrices == DefaultBoneMatricies;
+	if (upload->source != matrices || upload->count != count || upload->format != bones->format || !current)
+	{
+		// uniform blocks are declared with a fixed size, so always leave room for all of it
+		int reserve = count > MAX_BONE_NUM ? count : MAX_BONE_NUM;
+		int offset = rlmWriteBonePalettes(&matrices, 1, count, reserve, bones->format);
+		if (offset < 0)
+			return;
+
+		upload->source = matrices;
+		upload->count = count;
+		upload->format = bones->format;
+		upload->offset = offset;
+		upload->serial = BonePaletteSerial;
+	}
+
+	int bound = bones->target == GL_UNIFORM_BUFFER && count < MAX_BONE_NUM ? MAX_BONE_NUM : count;
+	rlmBindBonePaletteRange(bones, upload->offset, bound, 0);
+}
+
+#endif
+
+// call at the start of every draw call, bone palettes written before it are not reused
+static void rlmBeginBonePaletteDraw()
+{
+#if defined(RLM_SUPPORT_BONE_PALETTE)
+	BonePaletteSerial++;
+	if (BonePaletteSerial == 0)
+		BonePaletteSerial = 1;
+#endif
+}
+
+static bool rlmShaderTakesBones(const Shader* shader)
+{
+	if (shader->locs[SHADER_LOC_BONE_MATRICES] >= 0)
+		return true;
+
+	const rlmBoneProgram* bones = rlmGetBoneProgram(shader->id);
+	return bones->location >= 0 || bones->target != 0;
+}
+
+// in whatever form the shader declared, through the palette buffer when it has the block
+static void rlmSetShaderBones(const Shader* shader, const Matrix* matrices, int count)
+{
+	if (shader->locs[SHADER_LOC_BONE_MATRICES] >= 0)
+	{
+		rlmStateSetBoneMatrices(shader->locs[SHADER_LOC_BONE_MATRICES], matrices, count);
+		return;
+	}
+
+	const rlmBoneProgram* bones = rlmGetBoneProgram(shader->id);
+#if defined(RLM_SUPPORT_BONE_PALETTE)
+	if (bones->target != 0)
+	{
+		rlmBindBonePalette(bones, matrices, count);
+		return;
+	}
+#endif
+
+	if (bones->location >= 0)
+		rlmStateSetCompactBones(bones, matrices, count);
+}
+
+#if defined(RLM_SUPPORT_MULTIDRAW)
+static void rlmForgetMultiDrawProgram(unsigned int program);
+static void rlmReleaseMultiDrawEntry(rlmMesh* mesh);
+static void rlmBindMultiDrawIdentity(const Shader* shader);
+static void rlmResetMultiDrawProgram();
+#endif
+
+static void rlmStateForgetProgram(unsigned int program)
+{
+	for (int i = 0; i < RLM_STATE_UNIFORM_CACHE_SIZE; i++)
+	{
+		if (StateCache.uniforms[i].program == program)
+			StateCache.uniforms[i].program = 0;
+	}
+
+	if (StateCache.program == program)
+		StateCache.program = RLM_STATE_UNKNOWN_PROGRAM;
+
+	rlmForgetBoneProgram(program);
+
+#if defined(RLM_SUPPORT_INSTANCING)
+	rlmForgetInstanceProgram(program);
+#endif
+
+#if defined(RLM_SUPPORT_MULTIDRAW)
+	rlmForgetMultiDrawProgram(program);
+#endif
+}
+
+// put GL back how raylib expects it, at the end of every draw call
+static void rlmStateRestore()
+{
+	rlmStateCheckReady();
+
+	for (int slot = RLM_STATE_TEXTURE_SLOTS - 1; slot >= 0; slot--)
+		rlmStateUnbindTexture(slot, StateCache.cubeMaps[slot]);
+
+	rlmStateSetActiveSlot(0);
+
+	if (StateCache.program != 0)
+		rlDisableShader();
+
+	rlmStateForgetBindings();
+}
+
+void rlmResetStateCache()
+{
+	memset(StateCache.uniforms, 0, sizeof(StateCache.uniforms));
+	rlmStateForgetBindings();
+	StateCacheReady = true;
+
+	memset(BonePrograms, 0, sizeof(BonePrograms));
+#if defined(RLM_SUPPORT_INSTANCING)
+	memset(InstancePrograms, 0, sizeof(InstancePrograms));
+#endif
+
+#if defined(RLM_SUPPORT_MULTIDRAW)
+	rlmResetMultiDrawProgram();
+#endif
+}
+
+void rlmForgetShader(Shader shader)
+{
+	if (shader.id == 0)
+		return;
+
+	rlmStateCheckReady();
+	rlmStateForgetProgram(shader.id);
+}
+
+void rlmSetDefaultMaterialShader(Shader shader)
+{
+	DefaultMaterialShader = shader;
+	DefaultMaterialShaderSet = true;
+}
+
+void rlmClearDefaultMaterialShader()
+{
+	DefaultMaterialShader = (Shader){ 0 };
+	DefaultMaterialShaderSet = false;
+}
+
+static bool UseSIMDAnimation = true;
+
+void rlmSetAnimationSIMD(bool enabled)
+{
+	UseSIMDAnimation = enabled;
+}
+
+bool rlmIsAnimationSIMDSupported()
+{
+#if defined(RLM_USE_SSE2)
+	return true;
+#else
+	return false;
+#endif
+}
+
+static void rlUnloadMeshBuffer(rlmMeshBuffers* buffers)
+{
+	if (!buffers)
+		return;
+
+	MemFree(buffers->vertices);
+	MemFree(buffers->texcoords);
+	MemFree(buffers->texcoords2);
+	MemFree(buffers->normals);
+	MemFree(buffers->tangents);
+	MemFree(buffers->colors);
+	MemFree(buffers->indices);
+	MemFree(buffers->indices32);
+	MemFree(buffers->boneIds);
+	MemFree(buffers->boneWeights);
+
+	MemFree(buffers);
+}
+
+static int rlmGetMeshIndexCount(const rlmMeshBuffers* buffers)
+{
+	return (buffers->indices || buffers->indices32) ? buffers->triangleCount * 3 : buffers->vertexCount;
+}
+
+// unindexed meshes index themselves
+static unsigned int rlmGetMeshIndex(const rlmMeshBuffers* buffers, int i)
+{
+	if (buffers->indices32)
+		return buffers->indices32[i];
+
+	return buffers->indices ? buffers->indices[i] : (unsigned int)i;
+}
+
+// a new array with element i taken from order[i] of the old one, which is freed
+static void* rlmGatherVertexArray(void* data, int elementSize, const unsigned int* order, int count)
+{
+	if (!data)
+		return NULL;
+
+	unsigned char* gathered = (unsigned char*)MemAlloc(count * elementSize);
+	for (int i = 0; i < count; i++)
+		memcpy(gathered + i * elementSize, (const unsigned char*)data + order[i] * elementSize, elementSize);
+
+	MemFree(data);
+	return gathered;
+}
+
+static void rlmGatherMeshBuffers(rlmMeshBuffers* buffers, const unsigned int* order, int count)
+{
+	buffers->vertices = (float*)rlmGatherVertexArray(buffers->vertices, 3 * sizeof(float), order, count);
+	buffers->texcoords = (float*)rlmGatherVertexArray(buffers->texcoords, 2 * sizeof(float), order, count);
+	buffers->texcoords2 = (float*)rlmGatherVertexArray(buffers->texcoords2, 2 * sizeof(float), order, count);
+	buffers->normals = (float*)rlmGatherVertexArray(buffers->normals, 3 * sizeof(float), order, count);
+	buffers->tangents = (float*)rlmGatherVertexArray(buffers->tangents, 4 * sizeof(float), order, count);
+	buffers->colors = (unsigned char*)rlmGatherVertexArray(buffers->colors, 4, order, count);
+	buffers->boneIds = (unsigned char*)rlmGatherVertexArray(buffers->boneIds, 4, order, count);
+	buffers->boneWeights = (float*)rlmGatherVertexArray(buffers->boneWeights, 4 * sizeof(float), order, count);
+	buffers->vertexCount = count;
+}
+
+// vertex layouts
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES3)
+#define RLM_SUPPORT_HALF_FLOAT_VERTICES
+#endif
+
+// vertex attribute types rlgl has no names for
+#define RLM_VERTEX_TYPE_BYTE 0x1400
+#define RLM_VERTEX_TYPE_HALF_FLOAT 0x140B
+
+#define RLM_VERTEX_ATTRIBUTES 8
+
+typedef struct rlmVertexAttributeFormat
+{
+	int location;
+	int size;		// components the shader gets
+	int type;
+	bool normalized;
+	int bytes;		// space taken in the vertex, padded to 4 so every attribute stays aligned
+	int stream;		// which interleaved buffer
+	int offset;
+	int stride;
+}rlmVertexAttributeFormat;
+
+static int DefaultVertexLayout = RLM_VERTEX_SEPARATE;
+
+void rlmSetDefaultVertexLayout(int vertexLayout)
+{
+	DefaultVertexLayout = vertexLayout;
+}
+
+int rlmGetDefaultVertexLayout()
+{
+	return DefaultVertexLayout;
+}
+
+static int rlmGetSupportedVertexLayout(int layout)
+{
+	if (layout & RLM_VERTEX_HOT_COLD)
+		layout |= RLM_VERTEX_INTERLEAVED;
+
+#if !defined(RLM_SUPPORT_HALF_FLOAT_VERTICES)
+	layout &= ~(RLM_VERTEX_HALF_POSITIONS | RLM_VERTEX_HALF_TEXCOORDS);
+#endif
+
+	return layout;
+}
+
+// attribute locations as bits, positions and texcoords are always uploaded
+static unsigned int rlmGetMeshBufferAttributes(const rlmMeshBuffers* buffers)
+{
+	unsigned int attributes = (1u << RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION) | (1u << RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD);
+
+	if (buffers->normals)
+		attributes |= 1u << RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL;
+	if (buffers->colors)
+		attributes |= 1u << RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR;
+	if (buffers->tangents)
+		attributes |= 1u << RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT;
+	if (buffers->texcoords2)
+		attributes |= 1u << RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2;
+#ifdef RL_SUPPORT_MESH_GPU_SKINNING
+	if (buffers->boneIds)
+		attributes |= 1u << RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS;
+	if (buffers->boneWeights)
+		attributes |= 1u << RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS;
+#endif
+
+	return attributes;
+}
+
+static unsigned int rlmGetGPUMeshAttributes(const rlmGPUMesh* mesh)
+{
+	unsigned int attributes = 0;
+	for (int i = 0; i < MAX_MESH_VERTEX_BUFFERS; i++)
+	{
+		if (i != RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES && mesh->vboIds[i] != 0)
+			attributes |= 1u << i;
+	}
+
+	return attributes;
+}
+
+// formats of the given attributes in the order they are stored, the attributes a depth pass needs come first
+// returns how many were written, strides gets the size of each interleaved buffer
+static int rlmGetVertexFormat(int layout, unsigned int attributes, rlmVertexAttributeFormat* formats, int* strides)
+{
+	static const int order[] = {
+		RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION,
+#ifdef RL_SUPPORT_MESH_GPU_SKINNING
+		RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS,
+		RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS,
+#endif
+		RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD,
+		RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL,
+		RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR,
+		RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT,
+		RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2,
+	};
+
+	strides[0] = strides[1] = 0;
+	int count = 0;
+
+	for (int i = 0; i < (int)(sizeof(order) / sizeof(order[0])); i++)
+	{
+		int location = order[i];
+		if (!(attributes & (1u << location)))
+			continue;
+
+		rlmVertexAttributeFormat format = { location, 4, RL_FLOAT, false, 16, 0, 0, 0 };
+		bool hot = location == RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION;
+
+		switch (location)
+		{
+		case RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION:
+			format.size = 3;
+			format.bytes = 12;
+			if (layout & RLM_VERTEX_HALF_POSITIONS)
+			{
+				format.type = RLM_VERTEX_TYPE_HALF_FLOAT;
+				format.bytes = 8;
+			}
+			break;
+
+		case RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD:
+		case RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2:
+			format.size = 2;
+			format.bytes = 8;
+			if (layout & RLM_VERTEX_HALF_TEXCOORDS)
+			{
+				format.type = RLM_VERTEX_TYPE_HALF_FLOAT;
+				format.bytes = 4;
+			}
+			break;
+
+		case RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL:
+		case RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT:
+			format.size = location == RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL ? 3 : 4;
+			format.bytes = format.size * (int)sizeof(float);
+			if (layout & RLM_VERTEX_PACKED_NORMALS)
+			{
+				format.type = RLM_VERTEX_TYPE_BYTE;
+				format.normalized = true;
+				format.bytes = 4;
+			}
+			break;
+
+		case RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR:
+			format.type = RL_UNSIGNED_BYTE;
+			format.normalized = true;
+			format.bytes = 4;
+			break;
+
+#ifdef RL_SUPPORT_MESH_GPU_SKINNING
+		case RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS:
+			format.type = RL_UNSIGNED_BYTE;
+			format.bytes = 4;
+			hot = true;
+			break;
+
+		case RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS:
+			if (layout & RLM_VERTEX_PACKED_WEIGHTS)
+			{
+				format.type = RL_UNSIGNED_BYTE;
+				format.normalized = true;
+				format.bytes = 4;
+			}
+			hot = true;
+			break;
+#endif
+		}
+
+		if (layout & RLM_VERTEX_INTERLEAVED)
+		{
+			format.stream = ((layout & RLM_VERTEX_HOT_COLD) && !hot) ? 1 : 0;
+			format.offset = strides[format.stream];
+			strides[format.stream] += format.bytes;
+		}
+		else
+		{
+			format.stride = format.bytes;
+		}
+
+		formats[count++] = format;
+	}
+
+	if (layout & RLM_VERTEX_INTERLEAVED)
+	{
+		for (int i = 0; i < count; i++)
+			formats[i].stride = strides[formats[i].stream];
+	}
+
+	return count;
+}
+
+int rlmGetVertexLayoutSize(int vertexLayout, const rlmMeshBuffers* buffers)
+{
+	if (!buffers)
+		return 0;
+
+	rlmVertexAttributeFormat formats[RLM_VERTEX_ATTRIBUTES];
+	int strides[2];
+	int count = rlmGetVertexFormat(rlmGetSupportedVertexLayout(vertexLayout), rlmGetMeshBufferAttributes(buffers), formats, strides);
+
+	int size = 0;
+	for (int i = 0; i < count; i++)
+		size += formats[i].bytes;
+
+	return size;
+}
+
+// round to nearest, values past the half range are clamped and tiny ones become subnormals
+static unsigned short rlmFloatToHalf(float value)
+{
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	unsigned int sign = (bits >> 16) & 0x8000u;
+	unsigned int mantissa = bits & 0x7fffffu;
+	int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+
+	// nan included
+	if (exponent >= 31)
+		return (unsigned short)(sign | 0x7bffu);
+
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+			return (unsigned short)sign;
+
+		// the implicit bit becomes part of the mantissa
+		mantissa |= 0x800000u;
+		int shift = 14 - exponent;
+		unsigned int half = mantissa >> shift;
+		if ((mantissa >> (shift - 1)) & 1u)
+			half++;
+
+		return (unsigned short)(sign | half);
+	}
+
+	// a carry out of the mantissa moves into the exponent
+	unsigned int half = ((unsigned int)exponent << 10) | (mantissa >> 13);
+	if (mantissa & 0x1000u)
+		half++;
+	if (half > 0x7bffu)
+		half = 0x7bffu;
+
+	return (unsigned short)(sign | half);
+}
+
+static signed char rlmPackSnorm8(float value)
+{
+	return (signed char)roundf(Clamp(value, -1.0f, 1.0f) * 127.0f);
+}
+
+// rounding can leave the sum a little off 255, the largest weight takes the difference so skinned vertices do not scale
+static void rlmPackBoneWeights(const float* weights, unsigned char* packed)
+{
+	int total = 0;
+	int largest = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		packed[i] = (unsigned char)roundf(Clamp(weights[i], 0.0f, 1.0f) * 255.0f);
+		total += packed[i];
+		if (packed[i] > packed[largest])
+			largest = i;
+	}
+
+	if (total != 255 && abs(total - 255) <= 2)
+		packed[largest] = (unsigned char)(packed[largest] + 255 - total);
+}
+
+// writes one attribute of every vertex into data, missing buffers are left as zeros like an empty GPU buffer
+static void rlmPackVertexAttribute(const rlmMeshBuffers* buffers, const rlmVertexAttributeFormat* format, unsigned char* data)
+{
+	const float* source = NULL;
+	const unsigned char* bytes = NULL;
+
+	switch (format->location)
+	{
+	case RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION: source = buffers->vertices; break;
+	case RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD: source = buffers->texcoords; break;
+	case RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL: source = buffers->normals; break;
+	case RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR: bytes = buffers->colors; break;
+	case RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT: source = buffers->tangents; break;
+	case RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2: source = buffers->texcoords2; break;
+#ifdef RL_SUPPORT_MESH_GPU_SKINNING
+	case RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS: bytes = buffers->boneIds; break;
+	case RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS: source = buffers->boneWeights; break;
+#endif
+	}
+
+	if (source == NULL && bytes == NULL)
+		return;
+
+	int components = format->size;
+	for (int v = 0; v < buffers->vertexCount; v++)
+	{
+		unsigned char* out = data + v * format->stride + format->offset;
+
+		if (bytes)
+		{
+			memcpy(out, bytes + v * 4, 4);
+			continue;
+		}
+
+		const float* in = source + v * components;
+		switch (format->type)
+		{
+		case RL_FLOAT:
+			memcpy(out, in, components * sizeof(float));
+			break;
+
+		case RLM_VERTEX_TYPE_HALF_FLOAT:
+			for (int c = 0; c < components; c++)
+			{
+				unsigned short half = rlmFloatToHalf(in[c]);
+				memcpy(out + c * sizeof(unsigned short), &half, sizeof(unsigned short));
+			}
+			break;
+
+		case RLM_VERTEX_TYPE_BYTE:
+			for (int c = 0; c < components; c++)
+				out[c] = (unsigned char)rlmPackSnorm8(in[c]);
+			break;
+
+		case RL_UNSIGNED_BYTE:
+			rlmPackBoneWeights(in, out);
+			break;
+		}
+	}
+}
+
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+// points the bound vertex array at the mesh's buffers with the formats of its layout
+static void rlmSetVertexAttributes(const rlmGPUMesh* gpuMesh)
+{
+	rlmVertexAttributeFormat formats[RLM_VERTEX_ATTRIBUTES];
+	int strides[2];
+	int count = rlmGetVertexFormat(gpuMesh->vertexLayout, rlmGetGPUMeshAttributes(gpuMesh), formats, strides);
+
+	for (int i = 0; i < count; i++)
+	{
+		rlEnableVertexBuffer(gpuMesh->vboIds[formats[i].location]);
+		rlSetVertexAttribute(formats[i].location, formats[i].size, formats[i].type, formats[i].normalized, formats[i].stride, formats[i].offset);
+		rlEnableVertexAttribute(formats[i].location);
+	}
+}
+
+// the same defaults the separate layout gives missing attributes
+static void rlmSetMissingAttributeDefaults(unsigned int attributes)
+{
+	static const struct { int location; float value[4]; int type; int count; } defaults[] = {
+		{ RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, { 1.0f, 1.0f, 1.0f, 0.0f }, SHADER_ATTRIB_VEC3, 3 },
+		{ RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, { 1.0f, 1.0f, 1.0f, 1.0f }, SHADER_ATTRIB_VEC4, 4 },
+		{ RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT, { 0.0f, 0.0f, 0.0f, 0.0f }, SHADER_ATTRIB_VEC4, 4 },
+		{ RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2, { 0.0f, 0.0f, 0.0f, 0.0f }, SHADER_ATTRIB_VEC2, 2 },
+#ifdef RL_SUPPORT_MESH_GPU_SKINNING
+		{ RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS, { 0.0f, 0.0f, 0.0f, 0.0f }, SHADER_ATTRIB_VEC4, 4 },
+		{ RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS, { 0.0f, 0.0f, 0.0f, 0.0f }, SHADER_ATTRIB_VEC4, 4 },
+#endif
+	};
+
+	for (int i = 0; i < (int)(sizeof(defaults) / sizeof(defaults[0])); i++)
+	{
+		if (attributes & (1u << defaults[i].location))
+			continue;
+
+		rlSetVertexAttributeDefault(defaults[i].location, defaults[i].value, defaults[i].type, defaults[i].count);
+		rlDisableVertexAttribute(defaults[i].location);
+	}
+}
+
+// the layout's buffers, written and bound into the vertex array that is bound
+static void rlmUploadPackedVertices(rlmMesh* mesh, bool dynamic)
+{
+	const rlmMeshBuffers* buffers = mesh->meshBuffers;
+	unsigned int attributes = rlmGetMeshBufferAttributes(buffers);
+
+	rlmVertexAttributeFormat formats[RLM_VERTEX_ATTRIBUTES];
+	int strides[2];
+	int count = rlmGetVertexFormat(mesh->gpuMesh.vertexLayout, attributes, formats, strides);
+
+	if (mesh->gpuMesh.vertexLayout & RLM_VERTEX_INTERLEAVED)
+	{
+		for (int stream = 0; stream < 2; stream++)
+		{
+			if (strides[stream] == 0)
+				continue;
+
+			int size = buffers->vertexCount * strides[stream];
+			unsigned char* data = (unsigned char*)MemAlloc(size);
+			for (int i = 0; i < count; i++)
+			{
+				if (formats[i].stream == stream)
+					rlmPackVertexAttribute(buffers, &formats[i], data);
+			}
+
+			unsigned int vboId = rlLoadVertexBuffer(data, size, dynamic);
+			MemFree(data);
+
+			for (int i = 0; i < count; i++)
+			{
+				if (formats[i].stream == stream)
+					mesh->gpuMesh.vboIds[formats[i].location] = vboId;
+			}
+		}
+	}
+	else
+	{
+		for (int i = 0; i < count; i++)
+		{
+			int size = buffers->vertexCount * formats[i].bytes;
+			unsigned char* data = (unsigned char*)MemAlloc(size);
+			rlmPackVertexAttribute(buffers, &formats[i], data);
+
+			mesh->gpuMesh.vboIds[formats[i].location] = rlLoadVertexBuffer(data, size, dynamic);
+			MemFree(data);
+		}
+	}
+
+	rlmSetVertexAttributes(&mesh->gpuMesh);
+	rlmSetMissingAttributeDefaults(attributes);
+}
+#endif
+
+// mesh arena, meshes with the same vertex format share the vertex array and buffers of a page
+// each buffer is a heap of blocks in offset order, freed blocks merge with free neighbours
+// a heap with enough room but no block big enough packs its blocks together, the buffer ids stay the same so the vertex array does too
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_43)
+#define RLM_SUPPORT_MESH_ARENA
+#endif
+
+static bool UseMeshArena = false;
+
+void rlmSetUseMeshArena(bool enabled)
+{
+	UseMeshArena = enabled;
+}
+
+bool rlmGetUseMeshArena()
+{
+#if defined(RLM_SUPPORT_MESH_ARENA)
+	return UseMeshArena;
+#else
+	return false;
+#endif
+}
+
+#if defined(RLM_SUPPORT_MESH_ARENA)
+
+#define RLM_ARENA_PAGE_VERTEX_BYTES (8 * 1024 * 1024)
+#define RLM_ARENA_PAGE_INDEX_BYTES (2 * 1024 * 1024)
+#define RLM_ARENA_NULL -1
+
+typedef struct rlmArenaBlock
+{
+	int offset;		// in elements, vertices or indices
+	int count;
+	int slot;		// RLM_ARENA_NULL when free
+}rlmArenaBlock;
+
+typedef struct rlmArenaHeap
+{
+	unsigned int bufferId;
+	int elementSize;
+	int capacity;
+	int used;
+
+	rlmArenaBlock* blocks;
+	int blockCount;
+	int blockCapacity;
+}rlmArenaHeap;
+
+typedef struct rlmArenaPage
+{
+	int vertexLayout;
+	unsigned int attributes;
+	bool indices32;
+
+	unsigned int vaoId;
+	rlmArenaHeap vertices;
+	rlmArenaHeap indices;
+}rlmArenaPage;
+
+// what a mesh or mesh LOD has in a page, LODs only have indices and draw with the vertices of their mesh's slot
+typedef struct rlmArenaSlot
+{
+	int page;			// RLM_ARENA_NULL when free
+	int vertexSlot;		// next free slot when free
+	int baseVertex;
+	int vertexCount;
+	int firstIndex;
+	int indexCount;
+}rlmArenaSlot;
+
+static rlmArenaPage* ArenaPages = NULL;
+static int ArenaPageCount = 0;
+
+static rlmArenaSlot* ArenaSlots = NULL;
+static int ArenaSlotCapacity = 0;
+static int ArenaFreeSlot = RLM_ARENA_NULL;
+
+static void rlmCopyBuffer(unsigned int source, unsigned int destination, int sourceOffset, int destinationOffset, int size)
+{
+	glBindBuffer(GL_COPY_READ_BUFFER, source);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, destination);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, destinationOffset, size);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+static void rlmInitArenaHeap(rlmArenaHeap* heap, unsigned int bufferId, int elementSize, int capacity)
+{
+	heap->bufferId = bufferId;
+	heap->elementSize = elementSize;
+	heap->capacity = capacity;
+	heap->used = 0;
+
+	heap->blockCapacity = 16;
+	heap->blocks = (rlmArenaBlock*)MemAlloc(heap->blockCapacity * sizeof(rlmArenaBlock));
+	heap->blocks[0] = (rlmArenaBlock){ 0, capacity, RLM_ARENA_NULL };
+	heap->blockCount = 1;
+}
+
+static void rlmInsertArenaBlock(rlmArenaHeap* heap, int index, rlmArenaBlock block)
+{
+	if (heap->blockCount == heap->blockCapacity)
+	{
+		heap->blockCapacity *= 2;
+		heap->blocks = (rlmArenaBlock*)MemRealloc(heap->blocks, heap->blockCapacity * sizeof(rlmArenaBlock));
+	}
+
+	memmove(heap->blocks + index + 1, heap->blocks + index, (heap->blockCount - index) * sizeof(rlmArenaBlock));
+	heap->blocks[index] = block;
+	heap->blockCount++;
+}
+
+static void rlmRemoveArenaBlock(rlmArenaHeap* heap, int index)
+{
+	memmove(heap->blocks + index, heap->blocks + index + 1, (heap->blockCount - index - 1) * sizeof(rlmArenaBlock));
+	heap->blockCount--;
+}
+
+// first fit, returns the block index or RLM_ARENA_NULL
+static int rlmFindArenaBlock(const rlmArenaHeap* heap, int count)
+{
+	for (int i = 0; i < heap->blockCount; i++)
+	{
+		if (heap->blocks[i].slot == RLM_ARENA_NULL && heap->blocks[i].count >= count)
+			return i;
+	}
+
+	return RLM_ARENA_NULL;
+}
+
+// moves every used block to the front, through a scratch copy of the part that moves since a buffer can't copy onto itself
+// the slots get their new offsets, so meshes in the page draw from the right place after
+static void rlmCompactArenaHeap(rlmArenaHeap* heap, bool indices)
+{
+	int firstFree = RLM_ARENA_NULL;
+	int end = 0;
+	for (int i = 0; i < heap->blockCount; i++)
+	{
+		if (heap->blocks[i].slot == RLM_ARENA_NULL)
+		{
+			if (firstFree == RLM_ARENA_NULL)
+				firstFree = i;
+		}
+		else
+			end = heap->blocks[i].offset + heap->blocks[i].count;
+	}
+
+	if (firstFree == RLM_ARENA_NULL || heap->blocks[firstFree].offset >= end)
+		return;
+
+	int start = heap->blocks[firstFree].offset;
+	int size = heap->elementSize;
+
+	unsigned int scratch = 0;
+	glGenBuffers(1, &scratch);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, scratch);
+	glBufferData(GL_COPY_WRITE_BUFFER, (end - start) * size, NULL, GL_STREAM_COPY);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	rlmCopyBuffer(heap->bufferId, scratch, start * size, 0, (end - start) * size);
+
+	int count = firstFree;
+	int offset = start;
+	for (int i = firstFree; i < heap->blockCount; i++)
+	{
+		rlmArenaBlock block = heap->blocks[i];
+		if (block.slot == RLM_ARENA_NULL)
+			continue;
+
+		rlmCopyBuffer(scratch, heap->bufferId, (block.offset - start) * size, offset * size, block.count * size);
+
+		if (indices)
+			ArenaSlots[block.slot].firstIndex = offset;
+		else
+			ArenaSlots[block.slot].baseVertex = offset;
+
+		heap->blocks[count++] = (rlmArenaBlock){ offset, block.count, block.slot };
+		offset += block.count;
+	}
+
+	if (offset < heap->capacity)
+		heap->blocks[count++] = (rlmArenaBlock){ offset, heap->capacity - offset, RLM_ARENA_NULL };
+	heap->blockCount = count;
+
+	glDeleteBuffers(1, &scratch);
+}
+
+// returns the offset or RLM_ARENA_NULL, compacts the heap when the room is there but not in one piece
+static int rlmAllocateArenaBlock(rlmArenaHeap* heap, int count, int slot, bool indices)
+{
+	int index = rlmFindArenaBlock(heap, count);
+	if (index == RLM_ARENA_NULL && heap->capacity - heap->used >= count)
+	{
+		rlmCompactArenaHeap(heap, indices);
+		index = rlmFindArenaBlock(heap, count);
+	}
+
+	if (index == RLM_ARENA_NULL)
+		return RLM_ARENA_NULL;
+
+	rlmArenaBlock* block = &heap->blocks[index];
+	rlmArenaBlock rest = { block->offset + count, block->count - count, RLM_ARENA_NULL };
+	block->count = count;
+	block->slot = slot;
+	int offset = block->offset;
+
+	if (rest.count > 0)
+		rlmInsertArenaBlock(heap, index + 1, rest);
+
+	heap->used += count;
+	return offset;
+}
+
+static void rlmFreeArenaBlock(rlmArenaHeap* heap, int offset)
+{
+	int low = 0;
+	int high = heap->blockCount - 1;
+	while (low < high)
+	{
+		int middle = (low + high) / 2;
+		if (heap->blocks[middle].offset < offset)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	int index = low;
+	if (heap->blockCount == 0 || heap->blocks[index].offset != offset || heap->blocks[index].slot == RLM_ARENA_NULL)
+		return;
+
+	heap->used -= heap->blocks[index].count;
+	heap->blocks[index].slot = RLM_ARENA_NULL;
+
+	if (index + 1 < heap->blockCount && heap->blocks[index + 1].slot == RLM_ARENA_NULL)
+	{
+		heap->blocks[index].count += heap->blocks[index + 1].count;
+		rlmRemoveArenaBlock(heap, index + 1);
+	}
+
+	if (index > 0 && heap->blocks[index - 1].slot == RLM_ARENA_NULL)
+	{
+		heap->blocks[index - 1].count += heap->blocks[index].count;
+		rlmRemoveArenaBlock(heap, index);
+	}
+}
+
+static int rlmAddArenaSlot()
+{
+	if (ArenaFreeSlot == RLM_ARENA_NULL)
+	{
+		int capacity = ArenaSlotCapacity > 0 ? ArenaSlotCapacity * 2 : 64;
+		ArenaSlots = (rlmArenaSlot*)MemRealloc(ArenaSlots, capacity * sizeof(rlmArenaSlot));
+
+		// chain the new slots into the free list
+		for (int i = ArenaSlotCapacity; i < capacity; i++)
+		{
+			ArenaSlots[i].page = RLM_ARENA_NULL;
+			ArenaSlots[i].vertexSlot = i + 1 < capacity ? i + 1 : RLM_ARENA_NULL;
+		}
+
+		ArenaFreeSlot = ArenaSlotCapacity;
+		ArenaSlotCapacity = capacity;
+	}
+
+	int slot = ArenaFreeSlot;
+	ArenaFreeSlot = ArenaSlots[slot].vertexSlot;
+	return slot;
+}
+
+static void rlmFreeArenaSlot(int slot)
+{
+	if (slot < 0 || slot >= ArenaSlotCapacity || ArenaSlots[slot].page == RLM_ARENA_NULL)
+		return;
+
+	rlmArenaSlot* arenaSlot = &ArenaSlots[slot];
+	if (arenaSlot->page < ArenaPageCount)
+	{
+		rlmArenaPage* page = &ArenaPages[arenaSlot->page];
+		if (arenaSlot->vertexCount > 0)
+			rlmFreeArenaBlock(&page->vertices, arenaSlot->baseVertex);
+		if (arenaSlot->indexCount > 0)
+			rlmFreeArenaBlock(&page->indices, arenaSlot->firstIndex);
+	}
+
+	arenaSlot->page = RLM_ARENA_NULL;
+	arenaSlot->vertexSlot = ArenaFreeSlot;
+	ArenaFreeSlot = slot;
+}
+
+// a page sized for the format, or for the mesh when it is bigger than that
+static int rlmAddArenaPage(int vertexLayout, unsigned int attributes, bool indices32, int vertexCount, int indexCount)
+{
+	rlmVertexAttributeFormat formats[RLM_VERTEX_ATTRIBUTES];
+	int strides[2];
+	int formatCount = rlmGetVertexFormat(vertexLayout, attributes, formats, strides);
+	int indexSize = indices32 ? sizeof(unsigned int) : sizeof(unsigned short);
+
+	int vertexCapacity = RLM_ARENA_PAGE_VERTEX_BYTES / strides[0];
+	if (vertexCapacity < vertexCount)
+		vertexCapacity = vertexCount;
+
+	int indexCapacity = RLM_ARENA_PAGE_INDEX_BYTES / indexSize;
+	if (indexCapacity < indexCount)
+		indexCapacity = indexCount;
+
+	ArenaPages = (rlmArenaPage*)MemRealloc(ArenaPages, (ArenaPageCount + 1) * sizeof(rlmArenaPage));
+	rlmArenaPage* page = &ArenaPages[ArenaPageCount];
+	page->vertexLayout = vertexLayout;
+	page->attributes = attributes;
+	page->indices32 = indices32;
+
+	page->vaoId = rlLoadVertexArray();
+	rlEnableVertexArray(page->vaoId);
+
+	unsigned int vertexBuffer = rlLoadVertexBuffer(NULL, vertexCapacity * strides[0], true);
+	for (int i = 0; i < formatCount; i++)
+	{
+		rlSetVertexAttribute(formats[i].location, formats[i].size, formats[i].type, formats[i].normalized, formats[i].stride, formats[i].offset);
+		rlEnableVertexAttribute(formats[i].location);
+	}
+	rlmSetMissingAttributeDefaults(attributes);
+
+	unsigned int indexBuffer = rlLoadVertexBufferElement(NULL, indexCapacity * indexSize, true);
+
+	rlDisableVertexArray();
+	rlDisableVertexBuffer();
+	rlDisableVertexBufferElement();
+
+	rlmInitArenaHeap(&page->vertices, vertexBuffer, strides[0], vertexCapacity);
+	rlmInitArenaHeap(&page->indices, indexBuffer, indexSize, indexCapacity);
+
+	TraceLog(LOG_INFO, "rlModels : mesh arena page %i added, %i vertices of %i bytes and %i indices", ArenaPageCount, vertexCapacity, strides[0], indexCapacity);
+	return ArenaPageCount++;
+}
+
+// the first page of the format with room for both, even if it has to compact to get it
+static int rlmFindArenaPage(int vertexLayout, unsigned int attributes, bool indices32, int vertexCount, int indexCount)
+{
+	for (int i = 0; i < ArenaPageCount; i++)
+	{
+		const rlmArenaPage* page = &ArenaPages[i];
+		if (page->vertexLayout != vertexLayout || page->attributes != attributes || page->indices32 != indices32)
+			continue;
+
+		if (page->vertices.capacity - page->vertices.used >= vertexCount && page->indices.capacity - page->indices.used >= indexCount)
+			return i;
+	}
+
+	return rlmAddArenaPage(vertexLayout, attributes, indices32, vertexCount, indexCount);
+}
+
+// converts to the page's index size on the way, with no indices it writes 0, 1, 2...
+static void rlmWriteArenaIndices(const rlmArenaPage* page, int firstIndex, const unsigned short* indices, const unsigned int* indices32, int count)
+{
+	int size = page->indices.elementSize;
+	void* data = MemAlloc(count * size);
+
+	for (int i = 0; i < count; i++)
+	{
+		unsigned int index = indices32 ? indices32[i] : (indices ? indices[i] : (unsigned int)i);
+		if (page->indices32)
+			((unsigned int*)data)[i] = index;
+		else
+			((unsigned short*)data)[i] = (unsigned short)index;
+	}
+
+	rlUpdateVertexBuffer(page->indices.bufferId, data, count * size, firstIndex * size);
+	MemFree(data);
+}
+
+// the mesh's vertices and indices copied into a page, unindexed meshes get indices so everything draws the same way
+// the page is picked with enough free indices for the LODs the mesh already has, nothing is reserved,
+// they fit because rlmUploadMeshToArena uploads them straight after, levels added later only fit if the page still has room
+static bool rlmUploadArenaMesh(rlmMesh* mesh, int vertexLayout)
+{
+	const rlmMeshBuffers* buffers = mesh->meshBuffers;
+	if (buffers->vertexCount <= 0)
+		return false;
+
+	// one interleaved buffer per page, so every mesh in it has the same stride
+	int layout = (rlmGetSupportedVertexLayout(vertexLayout) | RLM_VERTEX_INTERLEAVED) & ~RLM_VERTEX_HOT_COLD;
+	unsigned int attributes = rlmGetMeshBufferAttributes(buffers);
+
+	// indices are relative to the base vertex, so only meshes too big for 16 bits need 32
+	bool indices32 = buffers->vertexCount > 65536;
+	int indexCount = rlmGetMeshIndexCount(buffers);
+
+	int lodIndexCount = 0;
+	for (int i = 0; i < mesh->lodCount; i++)
+	{
+		if (mesh->lods[i].gpuMesh.vboIds == NULL)
+			lodIndexCount += mesh->lods[i].triangleCount * 3;
+	}
+
+	rlmVertexAttributeFormat formats[RLM_VERTEX_ATTRIBUTES];
+	int strides[2];
+	int formatCount = rlmGetVertexFormat(layout, attributes, formats, strides);
+
+	int pageIndex = rlmFindArenaPage(layout, attributes, indices32, buffers->vertexCount, indexCount + lodIndexCount);
+	rlmArenaPage* page = &ArenaPages[pageIndex];
+
+	int slot = rlmAddArenaSlot();
+	ArenaSlots[slot] = (rlmArenaSlot){ pageIndex, slot, 0, buffers->vertexCount, 0, indexCount };
+	ArenaSlots[slot].baseVertex = rlmAllocateArenaBlock(&page->vertices, buffers->vertexCount, slot, false);
+	ArenaSlots[slot].firstIndex = rlmAllocateArenaBlock(&page->indices, indexCount, slot, true);
+
+	unsigned char* data = (unsigned char*)MemAlloc(buffers->vertexCount * strides[0]);
+	for (int i = 0; i < formatCount; i++)
+		rlmPackVertexAttribute(buffers, &formats[i], data);
+
+	rlUpdateVertexBuffer(page->vertices.bufferId, data, buffers->vertexCount * strides[0], ArenaSlots[slot].baseVertex * strides[0]);
+	MemFree(data);
+
+	rlmWriteArenaIndices(page, ArenaSlots[slot].firstIndex, buffers->indices, buffers->indices32, indexCount);
+
+	// the ids are the page's, so the buffers are never deleted with the mesh
+	mesh->gpuMesh.vboIds = (unsigned int*)MemAlloc(MAX_MESH_VERTEX_BUFFERS * sizeof(unsigned int));
+	for (int i = 0; i < formatCount; i++)
+		mesh->gpuMesh.vboIds[formats[i].location] = page->vertices.bufferId;
+	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES] = page->indices.bufferId;
+
+	mesh->gpuMesh.vaoId = page->vaoId;
+	mesh->gpuMesh.vertexLayout = layout;
+	mesh->gpuMesh.indices32 = indices32;
+	mesh->gpuMesh.arenaSlot = slot + 1;
+	mesh->gpuMesh.isIndexed = true;
+	mesh->gpuMesh.elementCount = indexCount;
+
+	return true;
+}
+
+// LOD levels are an index range in the page of their mesh
+static void rlmUploadArenaMeshLOD(rlmMesh* mesh, rlmMeshLOD* lod)
+{
+	int meshSlot = mesh->gpuMesh.arenaSlot - 1;
+	int pageIndex = ArenaSlots[meshSlot].page;
+	rlmArenaPage* page = &ArenaPages[pageIndex];
+	int indexCount = lod->triangleCount * 3;
+
+	// levels added after the mesh was uploaded can find the page full
+	if (page->indices.capacity - page->indices.used < indexCount)
+	{
+		TraceLog(LOG_WARNING, "rlModels : no room for a LOD of mesh %s in its mesh arena page, the level is drawn from the full mesh", mesh->name ? mesh->name : "");
+		return;
+	}
+
+	int slot = rlmAddArenaSlot();
+	int firstIndex = rlmAllocateArenaBlock(&page->indices, indexCount, slot, true);
+	ArenaSlots[slot] = (rlmArenaSlot){ pageIndex, meshSlot, 0, 0, firstIndex, indexCount };
+	rlmWriteArenaIndices(page, firstIndex, lod->indices, lod->indices32, indexCount);
+
+	lod->gpuMesh.vboIds = (unsigned int*)MemAlloc(MAX_MESH_VERTEX_BUFFERS * sizeof(unsigned int));
+	memcpy(lod->gpuMesh.vboIds, mesh->gpuMesh.vboIds, MAX_MESH_VERTEX_BUFFERS * sizeof(unsigned int));
+
+	lod->gpuMesh.vaoId = page->vaoId;
+	lod->gpuMesh.vertexLayout = mesh->gpuMesh.vertexLayout;
+	lod->gpuMesh.indices32 = page->indices32;
+	lod->gpuMesh.arenaSlot = slot + 1;
+	lod->gpuMesh.isIndexed = true;
+	lod->gpuMesh.elementCount = indexCount;
+
+	MemFree(lod->indices);
+	MemFree(lod->indices32);
+	lod->indices = NULL;
+	lod->indices32 = NULL;
+}
+
+static void rlmGetArenaDrawOffsets(const rlmGPUMesh* mesh, int* firstIndex, int* baseVertex)
+{
+	const rlmArenaSlot* slot = &ArenaSlots[mesh->arenaSlot - 1];
+	*firstIndex = slot->firstIndex;
+	*baseVertex = ArenaSlots[slot->vertexSlot].baseVertex;
+}
+
+#endif
+
+// interleaved attributes share a buffer, so each id is only deleted once
+// arena meshes only give back their range, the page keeps the buffers
+static void rlmUnloadGPUMeshBuffers(rlmGPUMesh* gpuMesh)
+{
+	if (gpuMesh->arenaSlot > 0)
+	{
+#if defined(RLM_SUPPORT_MESH_ARENA)
+		rlmFreeArenaSlot(gpuMesh->arenaSlot - 1);
+#endif
+		MemFree(gpuMesh->vboIds);
+
+		gpuMesh->vaoId = 0;
+		gpuMesh->vboIds = NULL;
+		gpuMesh->arenaSlot = 0;
+		return;
+	}
+
+	rlUnloadVertexArray(gpuMesh->vaoId);
+
+	if (gpuMesh->vboIds != NULL)
+	{
+		for (int i = 0; i < MAX_MESH_VERTEX_BUFFERS; i++)
+		{
+			bool shared = false;
+			for (int j = 0; j < i && !shared; j++)
+				shared = gpuMesh->vboIds[j] == gpuMesh->vboIds[i];
+
+			if (!shared)
+				rlUnloadVertexBuffer(gpuMesh->vboIds[i]);
+		}
+	}
+	MemFree(gpuMesh->vboIds);
+
+	gpuMesh->vaoId = 0;
+	gpuMesh->vboIds = NULL;
+}
+
+// mesh LODs
+static bool UseMeshLODs = true;
+static float MeshLODHysteresis = 0.1f;
+
+void rlmSetMeshLODSelection(bool enabled)
+{
+	UseMeshLODs = enabled;
+}
+
+void rlmSetMeshLODHysteresis(float fraction)
+{
+	MeshLODHysteresis = Clamp(fraction, 0.0f, 0.9f);
+}
+
+// a VAO over the vertex buffers of the mesh with the index buffer of the level
+static void rlmUploadMeshLOD(rlmMesh* mesh, rlmMeshLOD* lod)
+{
+	if (lod->gpuMesh.vboIds != NULL || (lod->indices == NULL && lod->indices32 == NULL) || mesh->gpuMesh.vboIds == NULL)
+		return;
+
+#if !defined(RLM_SUPPORT_32BIT_INDICES)
+	// rlgl would draw them as 16 bit indices, so the level stays on the CPU and the full mesh is drawn
+	if (lod->indices32 != NULL)
+		return;
+#endif
+
+#if defined(RLM_SUPPORT_MESH_ARENA)
+	if (mesh->gpuMesh.arenaSlot > 0)
+	{
+		rlmUploadArenaMeshLOD(mesh, lod);
+		return;
+	}
+#endif
+
+	lod->gpuMesh.vboIds = (unsigned int*)MemAlloc(MAX_MESH_VERTEX_BUFFERS * sizeof(unsigned int));
+	memcpy(lod->gpuMesh.vboIds, mesh->gpuMesh.vboIds, MAX_MESH_VERTEX_BUFFERS * sizeof(unsigned int));
+	lod->gpuMesh.vertexLayout = mesh->gpuMesh.vertexLayout;
+
+	lod->gpuMesh.isIndexed = true;
+	lod->gpuMesh.indices32 = lod->indices32 != NULL;
+	lod->gpuMesh.elementCount = lod->triangleCount * 3;
+	lod->gpuMesh.vaoId = 0;
+
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+	lod->gpuMesh.vaoId = rlLoadVertexArray();
+	bool useVAO = rlEnableVertexArray(lod->gpuMesh.vaoId);
+
+	if (useVAO)
+	{
+		// same layout rlmUploadMesh gives the base VAO
+		rlmSetVertexAttributes(&lod->gpuMesh);
+	}
+#endif
+
+	if (lod->indices32)
+		lod->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES] = rlLoadVertexBufferElement(lod->indices32, lod->triangleCount * 3 * sizeof(unsigned int), false);
+	else
+		lod->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES] = rlLoadVertexBufferElement(lod->indices, lod->triangleCount * 3 * sizeof(unsigned short), false);
+
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+	if (useVAO)
+		rlDisableVertexArray();
+#endif
+	rlDisableVertexBuffer();
+	rlDisableVertexBufferElement();
+
+	MemFree(lod->indices);
+	MemFree(lod->indices32);
+	lod->indices = NULL;
+	lod->indices32 = NULL;
+}
+
+static void rlmUnloadMeshLOD(rlmMeshLOD* lod)
+{
+	// only the index buffer belongs to the level
+	if (lod->gpuMesh.arenaSlot > 0)
+	{
+		rlmUnloadGPUMeshBuffers(&lod->gpuMesh);
+	}
+	else if (lod->gpuMesh.vboIds != NULL)
+	{
+		rlUnloadVertexArray(lod->gpuMesh.vaoId);
+		rlUnloadVertexBuffer(lod->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES]);
+		MemFree(lod->gpuMesh.vboIds);
+	}
+
+	MemFree(lod->indices);
+	MemFree(lod->indices32);
+	*lod = (rlmMeshLOD){ 0 };
+}
+
+static float rlmGetDefaultLODScreenSize(int level)
+{
+	return 0.5f / (float)(1 << level);
+}
+
+// one of indices or indices32
+static bool rlmAddMeshLODIndices(rlmMesh* mesh, const unsigned short* indices, const unsigned int* indices32, int triangleCount, float screenSize)
+{
+	if (!mesh || (!indices && !indices32) || triangleCount <= 0)
+		return false;
+
+	if (mesh->lodCount >= RLM_MAX_MESH_LODS)
+	{
+		TraceLog(LOG_WARNING, "rlModels : mesh %s already has %d LODs", mesh->name ? mesh->name : "", RLM_MAX_MESH_LODS);
+		return false;
+	}
+
+	rlmMeshLOD* lod = &mesh->lods[mesh->lodCount];
+	*lod = (rlmMeshLOD){ 0 };
+	lod->triangleCount = triangleCount;
+	lod->screenSize = screenSize;
+	if (indices32)
+	{
+		lod->indices32 = (unsigned int*)MemAlloc(triangleCount * 3 * sizeof(unsigned int));
+		memcpy(lod->indices32, indices32, triangleCount * 3 * sizeof(unsigned int));
+	}
+	else
+	{
+		lod->indices = (unsigned short*)MemAlloc(triangleCount * 3 * sizeof(unsigned short));
+		memcpy(lod->indices, indices, triangleCount * 3 * sizeof(unsigned short));
+	}
+
+	mesh->lodCount++;
+
+	// meshes that are not on the GPU yet upload their levels with rlmUploadMesh
+	rlmUploadMeshLOD(mesh, lod);
+	return true;
+}
+
+bool rlmAddMeshLOD(rlmMesh* mesh, const unsigned short* indices, int triangleCount, float screenSize)
+{
+	return rlmAddMeshLODIndices(mesh, indices, NULL, triangleCount, screenSize);
+}
+
+void rlmSetMeshLODScreenSize(rlmMesh* mesh, int level, float screenSize)
+{
+	if (!mesh || level < 1 || level > mesh->lodCount)
+		return;
+
+	mesh->lods[level - 1].screenSize = screenSize;
+}
+
+// the cell of weldDistance the position is in, or its exact bits when that is 0
+static void rlmGetWeldKey(const rlmMeshBuffers* buffers, int vertex, float weldDistance, unsigned int* key)
+{
+	const float* position = buffers->vertices + vertex * 3;
+	if (weldDistance > 0)
+	{
+		for (int i = 0; i < 3; i++)
+			key[i] = (unsigned int)(int)floorf(position[i] / weldDistance);
+	}
+	else
+	{
+		memcpy(key, position, 3 * sizeof(float));
+	}
+}
+
+static unsigned int rlmHashWeldKey(const unsigned int* key, unsigned int tableSize)
+{
+	unsigned int hash = (key[0] * 73856093u) ^ (key[1] * 19349663u) ^ (key[2] * 83492791u);
+
+	// whole number floats have no low bits set, so the high bits get mixed down before masking
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bu;
+	hash ^= hash >> 13;
+	return hash & (tableSize - 1);
+}
+
+// positions match when they are within weldDistance of each other, or bit for bit when that is 0
+static bool rlmVerticesMatch(const rlmMeshBuffers* buffers, int a, int b, float weldDistance)
+{
+	const float* positionA = buffers->vertices + a * 3;
+	const float* positionB = buffers->vertices + b * 3;
+	if (weldDistance > 0)
+	{
+		float dx = positionA[0] - positionB[0];
+		float dy = positionA[1] - positionB[1];
+		float dz = positionA[2] - positionB[2];
+		if (dx * dx + dy * dy + dz * dz > weldDistance * weldDistance)
+			return false;
+	}
+	else if (memcmp(positionA, positionB, 3 * sizeof(float)) != 0)
+	{
+		return false;
+	}
+
+	if (buffers->texcoords && memcmp(buffers->texcoords + a * 2, buffers->texcoords + b * 2, 2 * sizeof(float)) != 0)
+		return false;
+
+	if (buffers->texcoords2 && memcmp(buffers->texcoords2 + a * 2, buffers->texcoords2 + b * 2, 2 * sizeof(float)) != 0)
+		return false;
+
+	if (buffers->normals && memcmp(buffers->normals + a * 3, buffers->normals + b * 3, 3 * sizeof(float)) != 0)
+		return false;
+
+	if (buffers->tangents && memcmp(buffers->tangents + a * 4, buffers->tangents + b * 4, 4 * sizeof(float)) != 0)
+		return false;
+
+	if (buffers->colors && memcmp(buffers->colors + a * 4, buffers->colors + b * 4, 4) != 0)
+		return false;
+
+	if (buffers->boneIds && memcmp(buffers->boneIds + a * 4, buffers->boneIds + b * 4, 4) != 0)
+		return false;
+
+	if (buffers->boneWeights && memcmp(buffers->boneWeights + a * 4, buffers->boneWeights + b * 4, 4 * sizeof(float)) != 0)
+		return false;
+
+	return true;
+}
+
+// the first vertex kept so far that vertex matches, -1 when there is none
+static int rlmFindWeldedVertex(const rlmMeshBuffers* buffers, const unsigned int* table, unsigned int tableSize, const unsigned int* key, int vertex, float weldDistance)
+{
+	unsigned int slot = rlmHashWeldKey(key, tableSize);
+	while (table[slot] != ~0u)
+	{
+		if (rlmVerticesMatch(buffers, table[slot], vertex, weldDistance))
+			return (int)table[slot];
+		slot = (slot + 1) & (tableSize - 1);
+	}
+
+	return -1;
+}
+
+// indices for an unindexed mesh, vertices that match in every attribute point at the first one
+static void rlmBuildWeldedIndices(const rlmMeshBuffers* buffers, float weldDistance, unsigned int* indices)
+{
+	int vertexCount = buffers->vertexCount;
+
+	unsigned int tableSize = 1;
+	while (tableSize < (unsigned int)vertexCount * 2)
+		tableSize *= 2;
+
+	unsigned int* table = (unsigned int*)MemAlloc(tableSize * sizeof(unsigned int));
+	memset(table, 0xFF, tableSize * sizeof(unsigned int));
+
+	for (int i = 0; i < vertexCount; i++)
+	{
+		unsigned int key[3];
+		rlmGetWeldKey(buffers, i, weldDistance, key);
+
+		int match = -1;
+		if (weldDistance > 0)
+		{
+			// cells are weldDistance wide, so anything close enough is in this cell or one next to it
+			for (int n = 0; n < 27 && match < 0; n++)
+			{
+				unsigned int neighbor[3] = { key[0] + (unsigned int)(n % 3 - 1), key[1] + (unsigned int)(n / 3 % 3 - 1), key[2] + (unsigned int)(n / 9 - 1) };
+				match = rlmFindWeldedVertex(buffers, table, tableSize, neighbor, i, weldDistance);
+			}
+		}
+		else
+		{
+			match = rlmFindWeldedVertex(buffers, table, tableSize, key, i, weldDistance);
+		}
+
+		if (match >= 0)
+		{
+			indices[i] = (unsigned int)match;
+			continue;
+		}
+
+		indices[i] = i;
+
+		unsigned int slot = rlmHashWeldKey(key, tableSize);
+		while (table[slot] != ~0u)
+			slot = (slot + 1) & (tableSize - 1);
+		table[slot] = i;
+	}
+
+	MemFree(table);
+}
+
+// FIFO size the optimize report measures with, about what older GPUs have
+#define RLM_ACMR_CACHE_SIZE 16
+
+// every index of the buffers as 32 bits, returns the count, NULL when an index is past the vertices
+static unsigned int* rlmGetMeshBufferIndices(const rlmMeshBuffers* buffers, int* indexCount)
+{
+	*indexCount = rlmGetMeshIndexCount(buffers);
+	*indexCount -= *indexCount % 3;
+
+	unsigned int* indices = (unsigned int*)MemAlloc((*indexCount > 0 ? *indexCount : 1) * sizeof(unsigned int));
+	for (int i = 0; i < *indexCount; i++)
+	{
+		indices[i] = rlmGetMeshIndex(buffers, i);
+		if (indices[i] >= (unsigned int)buffers->vertexCount)
+		{
+			MemFree(indices);
+			return NULL;
+		}
+	}
+
+	return indices;
+}
+
+float rlmGetMeshBuffersACMR(const rlmMeshBuffers* buffers, int cacheSize)
+{
+	if (!buffers || buffers->vertexCount <= 0)
+		return 0.0f;
+
+	int indexCount = 0;
+	unsigned int* indices = rlmGetMeshBufferIndices(buffers, &indexCount);
+	if (!indices)
+		return 0.0f;
+
+	float acmr = rlmGetACMR(indices, indexCount, buffers->vertexCount, cacheSize);
+	MemFree(indices);
+	return acmr;
+}
+
+bool rlmOptimizeMeshBuffers(rlmMeshBuffers* buffers, float weldDistance, rlmMeshOptimizeReport* report)
+{
+	if (report)
+		*report = (rlmMeshOptimizeReport){ 0 };
+
+	if (!buffers || !buffers->vertices || buffers->vertexCount <= 0)
+		return false;
+
+	int vertexCount = buffers->vertexCount;
+	int indexCount = 0;
+	unsigned int* indices = rlmGetMeshBufferIndices(buffers, &indexCount);
+	if (!indices)
+	{
+		TraceLog(LOG_WARNING, "rlModels : mesh buffers have indices past their %d vertices, not optimized", vertexCount);
+		return false;
+	}
+
+	rlmMeshOptimizeReport result = { 0 };
+	result.vertexCountBefore = vertexCount;
+	result.triangleCountBefore = indexCount / 3;
+	result.acmrBefore = rlmGetACMR(indices, indexCount, vertexCount, RLM_ACMR_CACHE_SIZE);
+
+	// copies of a vertex, and the ones close enough to weld, point at the first of them
+	unsigned int* remap = (unsigned int*)MemAlloc(vertexCount * sizeof(unsigned int));
+	rlmBuildWeldedIndices(buffers, weldDistance, remap);
+
+	// dropping the triangles welding collapsed
+	int kept = 0;
+	for (int i = 0; i < indexCount; i += 3)
+	{
+		unsigned int a = remap[indices[i]];
+		unsigned int b = remap[indices[i + 1]];
+		unsigned int c = remap[indices[i + 2]];
+		if (a == b || b == c || a == c)
+			continue;
+
+		indices[kept++] = a;
+		indices[kept++] = b;
+		indices[kept++] = c;
+	}
+
+	if (kept == 0)
+	{
+		MemFree(indices);
+		MemFree(remap);
+		return false;
+	}
+	indexCount = kept;
+
+	unsigned int* ordered = (unsigned int*)MemAlloc(indexCount * sizeof(unsigned int));
+	rlmOptimizeVertexCache(ordered, indices, indexCount, vertexCount);
+
+	// vertices in the order the triangles use them, the welded and unused ones drop out
+	int usedCount = rlmOptimizeVertexFetch(remap, ordered, indexCount, vertexCount);
+
+	unsigned int* order = (unsigned int*)MemAlloc(usedCount * sizeof(unsigned int));
+	for (int v = 0; v < vertexCount; v++)
+	{
+		if (remap[v] != ~0u)
+			order[remap[v]] = v;
+	}
+	rlmGatherMeshBuffers(buffers, order, usedCount);
+
+	result.vertexCountAfter = usedCount;
+	result.triangleCountAfter = indexCount / 3;
+	result.acmrAfter = rlmGetACMR(ordered, indexCount, usedCount, RLM_ACMR_CACHE_SIZE);
+
+	MemFree(buffers->indices);
+	MemFree(buffers->indices32);
+	buffers->indices = NULL;
+	buffers->indices32 = NULL;
+	buffers->triangleCount = indexCount / 3;
+
+	if (usedCount > 65536)
+	{
+		buffers->indices32 = ordered;
+		ordered = NULL;
+	}
+	else
+	{
+		buffers->indices = (unsigned short*)MemAlloc(indexCount * sizeof(unsigned short));
+		for (int i = 0; i < indexCount; i++)
+			buffers->indices[i] = (unsigned short)ordered[i];
+	}
+
+	TraceLog(LOG_INFO, "rlModels : optimized mesh, %d to %d vertices, %d to %d triangles, ACMR %.3f to %.3f", result.vertexCountBefore, result.vertexCountAfter,
+		result.triangleCountBefore, result.triangleCountAfter, result.acmrBefore, result.acmrAfter);
+
+	MemFree(indices);
+	MemFree(remap);
+	MemFree(ordered);
+	MemFree(order);
+
+	if (report)
+		*report = result;
+
+	return true;
+}
+
+int rlmGenerateMeshLODs(rlmMesh* mesh, int levelCount, float reduction, float maxError)
+{
+	if (!mesh || levelCount <= 0)
+		return 0;
+
+	const rlmMeshBuffers* buffers = mesh->meshBuffers;
+	if (!buffers || !buffers->vertices || buffers->vertexCount <= 0)
+	{
+		TraceLog(LOG_WARNING, "rlModels : mesh LODs need the mesh buffers, keep the CPU data when loading");
+		return 0;
+	}
+
+	// levels of big meshes keep 32 bit indices
+	bool wide = buffers->vertexCount > 65536;
+
+	if (reduction <= 0 || reduction >= 1)
+		reduction = 0.5f;
+
+	for (int i = 0; i < mesh->lodCount; i++)
+		rlmUnloadMeshLOD(&mesh->lods[i]);
+	mesh->lodCount = 0;
+
+#if !defined(RLM_SUPPORT_32BIT_INDICES)
+	// the mesh is uploaded unindexed here, so there is no vertex order left for levels to index
+	if (wide)
+	{
+		TraceLog(LOG_WARNING, "rlModels : mesh %s needs 32 bit indices, which this graphics API can not draw, no LODs made", mesh->name ? mesh->name : "");
+		return 0;
+	}
+#endif
+
+	int indexCount = rlmGetMeshIndexCount(buffers);
+	unsigned int* source = (unsigned int*)MemAlloc(indexCount * sizeof(unsigned int));
+	unsigned int* reduced = (unsigned int*)MemAlloc(indexCount * sizeof(unsigned int));
+	unsigned short* indices16 = wide ? NULL : (unsigned short*)MemAlloc(indexCount * sizeof(unsigned short));
+
+	if (buffers->indices || buffers->indices32)
+	{
+		for (int i = 0; i < indexCount; i++)
+			source[i] = rlmGetMeshIndex(buffers, i);
+	}
+	else
+	{
+		rlmBuildWeldedIndices(buffers, 0.0f, source);
+	}
+
+	int baseTriangles = indexCount / 3;
+	if (levelCount > RLM_MAX_MESH_LODS)
+		levelCount = RLM_MAX_MESH_LODS;
+
+	// each level starts from the one before, so they nest and get cheaper to build
+	float target = (float)indexCount;
+	for (int level = 1; level <= levelCount; level++)
+	{
+		target *= reduction;
+
+		float error = 0;
+		int reducedCount = rlmSimplifyMesh(reduced, source, indexCount, buffers->vertices, buffers->vertexCount, ((int)target / 3) * 3, maxError, &error);
+
+		// not worth a level if it barely changed
+		if (reducedCount < 3 || reducedCount > indexCount * 9 / 10)
+			break;
+
+		if (wide)
+		{
+			rlmAddMeshLODIndices(mesh, NULL, reduced, reducedCount / 3, rlmGetDefaultLODScreenSize(level));
+		}
+		else
+		{
+			for (int i = 0; i < reducedCount; i++)
+				indices16[i] = (unsigned short)reduced[i];
+
+			rlmAddMeshLOD(mesh, indices16, reducedCount / 3, rlmGetDefaultLODScreenSize(level));
+		}
+		mesh->lods[mesh->lodCount - 1].error = error;
+
+		TraceLog(LOG_INFO, "rlModels : mesh %s LOD %d, %d of %d triangles, error %.4f", mesh->name ? mesh->name : "", level, reducedCount / 3, baseTriangles, error);
+
+		unsigned int* swap = source;
+		source = reduced;
+		reduced = swap;
+		indexCount = reducedCount;
+	}
+
+	MemFree(source);
+	MemFree(reduced);
+	MemFree(indices16);
+
+	return mesh->lodCount;
+}
+
+void rlmGenerateModelLODs(rlmModel* model, int levelCount, float reduction, float maxError)
+{
+	if (!model)
+		return;
+
+	for (int group = 0; group < model->groupCount; group++)
+	{
+		rlmModelGroup* groupPtr = model->groups + group;
+		for (int i = 0; i < groupPtr->meshCount; i++)
+			rlmGenerateMeshLODs(groupPtr->meshes + i, levelCount, reduction, maxError);
+	}
+}
+
+int rlmSelectMeshLOD(const rlmMesh* mesh, float screenSize, int currentLevel)
+{
+	if (!mesh || mesh->lodCount <= 0)
+		return 0;
+
+	if (currentLevel > mesh->lodCount)
+		currentLevel = 0;
+
+	// thresholds already crossed must be crossed back by the hysteresis margin before the level goes finer again, and the same going coarser
+	// without a current level the thresholds are used as they are
+	int level = 0;
+	for (int i = 0; i < mesh->lodCount; i++)
+	{
+		float threshold = mesh->lods[i].screenSize;
+		if (currentLevel >= 0)
+			threshold *= (i < currentLevel) ? 1.0f + MeshLODHysteresis : 1.0f - MeshLODHysteresis;
+
+		if (screenSize < threshold)
+			level = i + 1;
+	}
+
+	return level;
+}
+
+rlmMeshLODReport rlmGetMeshLODReport(const rlmMesh* mesh)
+{
+	rlmMeshLODReport report = { 0 };
+	if (!mesh)
+		return report;
+
+	report.levelCount = 1 + mesh->lodCount;
+
+	report.triangles[0] = (int)mesh->gpuMesh.elementCount / 3;
+	if (mesh->gpuMesh.isIndexed)
+		report.bytes[0] = (int)(mesh->gpuMesh.elementCount * (mesh->gpuMesh.indices32 ? sizeof(unsigned int) : sizeof(unsigned short)));
+
+	const rlmMeshBuffers* buffers = mesh->meshBuffers;
+	if (buffers)
+	{
+		report.triangles[0] = rlmGetMeshIndexCount(buffers) / 3;
+
+		int vertexSize = rlmGetVertexLayoutSize(mesh->gpuMesh.vboIds ? mesh->gpuMesh.vertexLayout : DefaultVertexLayout, buffers);
+		report.bytes[0] += buffers->vertexCount * vertexSize;
+	}
+
+	for (int i = 0; i < mesh->lodCount; i++)
+	{
+		report.triangles[i + 1] = mesh->lods[i].triangleCount;
+		report.bytes[i + 1] = mesh->lods[i].triangleCount * 3 * (int)(mesh->lods[i].gpuMesh.indices32 || mesh->lods[i].indices32 ? sizeof(unsigned int) : sizeof(unsigned short));
+		report.errors[i + 1] = mesh->lods[i].error;
+	}
+
+	return report;
+}
+
+// fraction of the screen height covered by the bounds, from the distance in view space
+static float rlmGetProjectedSize(BoundingBox bounds, Matrix matMesh, Matrix matView, Matrix matProjection)
+{
+	Vector3 center = Vector3Transform(Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f), matMesh);
+	float radius = Vector3Length(Vector3Subtract(bounds.max, bounds.min)) * 0.5f;
+
+	// the largest axis scale of the transform
+	float scaleX = matMesh.m0 * matMesh.m0 + matMesh.m1 * matMesh.m1 + matMesh.m2 * matMesh.m2;
+	float scaleY = matMesh.m4 * matMesh.m4 + matMesh.m5 * matMesh.m5 + matMesh.m6 * matMesh.m6;
+	float scaleZ = matMesh.m8 * matMesh.m8 + matMesh.m9 * matMesh.m9 + matMesh.m10 * matMesh.m10;
+	radius *= sqrtf(fmaxf(scaleX, fmaxf(scaleY, scaleZ)));
+
+	// orthographic projections don't shrink with distance
+	if (matProjection.m11 == 0)
+		return radius * matProjection.m5;
+
+	float distance = Vector3Length(Vector3Transform(center, matView));
+	if (distance <= radius)
+		return 1.0f;
+
+	return radius * matProjection.m5 / distance;
+}
+
+// the GPU mesh to draw for a mesh at this transform, and remembers the level for the hysteresis
+// the levels come from the caller when given, otherwise from the group, draws of one model at many transforms pass no history at all
+static rlmGPUMesh* rlmGetLODGPUMesh(rlmModelGroup* group, int meshIndex, int* groupLevels, bool lodHistory, Matrix matMesh, Matrix matView, Matrix matProjection)
+{
+	rlmMesh* mesh = &group->meshes[meshIndex];
+	if (!UseMeshLODs || mesh->lodCount <= 0)
+		return &mesh->gpuMesh;
+
+	int* lastLevel = NULL;
+	if (lodHistory)
+	{
+		if (groupLevels == NULL)
+		{
+			if (group->meshLODLevels == NULL)
+				group->meshLODLevels = (int*)MemAlloc(group->meshCount * sizeof(int));
+			groupLevels = group->meshLODLevels;
+		}
+		lastLevel = groupLevels + meshIndex;
+	}
+
+	float size = rlmGetProjectedSize(mesh->bounds, matMesh, matView, matProjection);
+	int level = rlmSelectMeshLOD(mesh, size, lastLevel ? *lastLevel : -1);
+	if (lastLevel)
+		*lastLevel = level;
+
+	// levels that were never uploaded fall back to the base mesh
+	if (level == 0 || mesh->lods[level - 1].gpuMesh.vboIds == NULL)
+		return &mesh->gpuMesh;
+
+	return &mesh->lods[level - 1].gpuMesh;
+}
+
+void rlmUploadMesh(rlmMesh* mesh, bool releaseGeoBuffers)
+{
+	if (UseMeshArena)
+		rlmUploadMeshToArena(mesh, releaseGeoBuffers, DefaultVertexLayout);
+	else
+		rlmUploadMeshEx(mesh, releaseGeoBuffers, DefaultVertexLayout);
+}
+
+bool rlmUploadMeshToArena(rlmMesh* mesh, bool releaseGeoBuffers, int vertexLayout)
+{
+#if defined(RLM_SUPPORT_MULTIDRAW)
+	// a new upload can get the vertex array name of the one that was packed
+	if (mesh->gpuMesh.vaoId == 0)
+		rlmReleaseMultiDrawEntry(mesh);
+#endif
+
+#if defined(RLM_SUPPORT_MESH_ARENA)
+	if (mesh->gpuMesh.vaoId == 0 && mesh->meshBuffers != NULL && rlmUploadArenaMesh(mesh, vertexLayout))
+	{
+		for (int i = 0; i < mesh->lodCount; i++)
+			rlmUploadMeshLOD(mesh, &mesh->lods[i]);
+
+		if (releaseGeoBuffers)
+		{
+			rlUnloadMeshBuffer(mesh->meshBuffers);
+			mesh->meshBuffers = NULL;
+		}
+		return true;
+	}
+#endif
+
+	// warns about the same things the arena skipped
+	rlmUploadMeshEx(mesh, releaseGeoBuffers, vertexLayout);
+	return false;
+}
+
+rlmMeshArenaStats rlmGetMeshArenaStats()
+{
+	rlmMeshArenaStats stats = { 0 };
+
+#if defined(RLM_SUPPORT_MESH_ARENA)
+	stats.pages = ArenaPageCount;
+
+	for (int i = 0; i < ArenaPageCount; i++)
+	{
+		const rlmArenaHeap* heaps[2] = { &ArenaPages[i].vertices, &ArenaPages[i].indices };
+		for (int h = 0; h < 2; h++)
+		{
+			const rlmArenaHeap* heap = heaps[h];
+			int bytes = heap->capacity * heap->elementSize;
+			int used = heap->used * heap->elementSize;
+
+			if (h == 0)
+			{
+				stats.vertexBytes += bytes;
+				stats.vertexBytesUsed += used;
+			}
+			else
+			{
+				stats.indexBytes += bytes;
+				stats.indexBytesUsed += used;
+			}
+
+			for (int b = 0; b < heap->blockCount; b++)
+			{
+				if (heap->blocks[b].slot != RLM_ARENA_NULL)
+					continue;
+
+				stats.freeBlocks++;
+				if (heap->blocks[b].count * heap->elementSize > stats.largestFreeBlock)
+					stats.largestFreeBlock = heap->blocks[b].count * heap->elementSize;
+			}
+		}
+	}
+
+	for (int i = 0; i < ArenaSlotCapacity; i++)
+	{
+		if (ArenaSlots[i].page != RLM_ARENA_NULL)
+			stats.allocations++;
+	}
+#endif
+
+	return stats;
+}
+
+void rlmDefragmentMeshArena()
+{
+#if defined(RLM_SUPPORT_MESH_ARENA)
+	for (int i = 0; i < ArenaPageCount; i++)
+	{
+		rlmCompactArenaHeap(&ArenaPages[i].vertices, false);
+		rlmCompactArenaHeap(&ArenaPages[i].indices, true);
+	}
+#endif
+}
+
+void rlmUnloadMeshArena()
+{
+#if defined(RLM_SUPPORT_MESH_ARENA)
+	for (int i = 0; i < ArenaPageCount; i++)
+	{
+		rlUnloadVertexArray(ArenaPages[i].vaoId);
+		rlUnloadVertexBuffer(ArenaPages[i].vertices.bufferId);
+		rlUnloadVertexBuffer(ArenaPages[i].indices.bufferId);
+		MemFree(ArenaPages[i].vertices.blocks);
+		MemFree(ArenaPages[i].indices.blocks);
+	}
+
+	MemFree(ArenaPages);
+	MemFree(ArenaSlots);
+	ArenaPages = NULL;
+	ArenaPageCount = 0;
+	ArenaSlots = NULL;
+	ArenaSlotCapacity = 0;
+	ArenaFreeSlot = RLM_ARENA_NULL;
+#endif
+}
+
+void rlmUploadMeshEx(rlmMesh* mesh, bool releaseGeoBuffers, int vertexLayout)
+{
+	if (mesh->gpuMesh.vaoId > 0)
+	{
+		// Check if mesh has already been loaded in GPU
+		TraceLog(LOG_WARNING, "VAO: [ID %i] Trying to re-load an already loaded mesh", mesh->gpuMesh.vaoId);
+		return;
+	}
+
+#if defined(RLM_SUPPORT_MULTIDRAW)
+	rlmReleaseMultiDrawEntry(mesh);
+#endif
+
+	if (mesh->meshBuffers == NULL)
+	{
+		// Check if mesh has already been loaded in GPU
+		TraceLog(LOG_WARNING, "Trying to upload a mesh with no mesh buffers");
+		return;
+	}
+
+#if !defined(RLM_SUPPORT_32BIT_INDICES)
+	if (mesh->meshBuffers->indices32 != NULL)
+	{
+		// every triangle corner gets its own vertex instead
+		TraceLog(LOG_WARNING, "rlModels : mesh %s needs 32 bit indices, which this graphics API can not draw, uploading it unindexed", mesh->name ? mesh->name : "");
+		rlmGatherMeshBuffers(mesh->meshBuffers, mesh->meshBuffers->indices32, mesh->meshBuffers->triangleCount * 3);
+		MemFree(mesh->meshBuffers->indices32);
+		mesh->meshBuffers->indices32 = NULL;
+
+		// the levels index the old vertex order
+		for (int i = 0; i < mesh->lodCount; i++)
+			rlmUnloadMeshLOD(&mesh->lods[i]);
+		mesh->lodCount = 0;
+	}
+#endif
+
+	mesh->gpuMesh.vboIds = (unsigned int*)MemAlloc(MAX_MESH_VERTEX_BUFFERS * sizeof(unsigned int));
+	mesh->gpuMesh.vertexLayout = rlmGetSupportedVertexLayout(vertexLayout);
+	mesh->gpuMesh.indices32 = mesh->meshBuffers->indices32 != NULL;
+
+	mesh->gpuMesh.vaoId = 0;        // Vertex Array Object
+	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION] = 0;     // Vertex buffer: positions
+	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD] = 0;     // Vertex buffer: texcoords
+	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL] = 0;       // Vertex buffer: normals
+	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR] = 0;        // Vertex buffer: colors
+	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT] = 0;      // Vertex buffer: tangents
+	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2] = 0;    // Vertex buffer: texcoords2
+	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES] = 0;      // Vertex buffer: indices
+
+#ifdef RL_SUPPORT_MESH_GPU_SKINNING
+	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS] = 0;      // Vertex buffer: boneIds
+	mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS] = 0;  // Vertex buffer: boneWeights
+#endif
+
+#if defined(GRAPHICS_API_OPENGL_33) || defined(GRAPHICS_API_OPENGL_ES2)
+	mesh->gpuMesh.vaoId = rlLoadVertexArray();
+	rlEnableVertexArray(mesh->gpuMesh.vaoId);
+
+	// NOTE: Vertex attributes must be uploaded considering default locations points and available vertex data
+
+	bool dynamic = !releaseGeoBuffers;
+
+	if (mesh->gpuMesh.vertexLayout != RLM_VERTEX_SEPARATE)
+	{
+		rlmUploadPackedVertices(mesh, dynamic);
+	}
+	else
+	{
+		// Enable vertex attributes: position (shader-location = 0)
+		void* vertices = mesh->meshBuffers->vertices;
+		mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION] = rlLoadVertexBuffer(vertices, mesh->meshBuffers->vertexCount * 3 * sizeof(float), dynamic);
+		rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 3, RL_FLOAT, 0, 0, 0);
+		rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+
+		// Enable vertex attributes: texcoords (shader-location = 1)
+		mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD] = rlLoadVertexBuffer(mesh->meshBuffers->texcoords, mesh->meshBuffers->vertexCount * 2 * sizeof(float), dynamic);
+		rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, 2, RL_FLOAT, 0, 0, 0);
+		rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD);
+
+		// WARNING: When setting default vertex attribute values, the values for each generic vertex attribute
+		// is part of current state, and it is maintained even if a different program object is used
+
+		if (mesh->meshBuffers->normals != NULL)
+		{
+			// Enable vertex attributes: normals (shader-location = 2)
+			void* normals = mesh->meshBuffers->normals;
+			mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL] = rlLoadVertexBuffer(normals, mesh->meshBuffers->vertexCount * 3 * sizeof(float), dynamic);
+			rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, 3, RL_FLOAT, 0, 0, 0);
+			rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL);
+		}
+		else
+		{
+			// Default vertex attribute: normal
+			// WARNING: Default value provided to shader if location available
+			float value[3] = { 1.0f, 1.0f, 1.0f };
+			rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, value, SHADER_ATTRIB_VEC3, 3);
+			rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL);
+		}
+
+		if (mesh->meshBuffers->colors != NULL)
+		{
+			// Enable vertex attribute: color (shader-location = 3)
+			mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR] = rlLoadVertexBuffer(mesh->meshBuffers->colors, mesh->meshBuffers->vertexCount * 4 * sizeof(unsigned char), dynamic);
+			rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, 4, RL_UNSIGNED_BYTE, 1, 0, 0);
+			rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR);
+		}
+		else
+		{
+			// Default vertex attribute: color
+			// WARNING: Default value provided to shader if location available
+			float value[4] = { 1.0f, 1.0f, 1.0f, 1.0f };    // WHITE
+			rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, value, SHADER_ATTRIB_VEC4, 4);
+			rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR);
+		}
+
+		if (mesh->meshBuffers->tangents != NULL)
+		{
+			// Enable vertex attribute: tangent (shader-location = 4)
+			mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT] = rlLoadVertexBuffer(mesh->meshBuffers->tangents, mesh->meshBuffers->vertexCount * 4 * sizeof(float), dynamic);
+			rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT, 4, RL_FLOAT, 0, 0, 0);
+			rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT);
+		}
+		else
+		{
+			// Default vertex attribute: tangent
+			// WARNING: Default value provided to shader if location available
+			float value[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT, value, SHADER_ATTRIB_VEC4, 4);
+			rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT);
+		}
+
+		if (mesh->meshBuffers->texcoords2 != NULL)
+		{
+			// Enable vertex attribute: texcoord2 (shader-location = 5)
+			mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2] = rlLoadVertexBuffer(mesh->meshBuffers->texcoords2, mesh->meshBuffers->vertexCount * 2 * sizeof(float), dynamic);
+			rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2, 2, RL_FLOAT, 0, 0, 0);
+			rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2);
+		}
+		else
+		{
+			// Default vertex attribute: texcoord2
+			// WARNING: Default value provided to shader if location available
+			float value[2] = { 0.0f, 0.0f };
+			rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2, value, SHADER_ATTRIB_VEC2, 2);
+			rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2);
+		}
+
+#ifdef RL_SUPPORT_MESH_GPU_SKINNING
+		if (mesh->meshBuffers->boneIds != NULL)
+		{
+			// Enable vertex attribute: boneIds (shader-location = 7)
+			mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS] = rlLoadVertexBuffer(mesh->meshBuffers->boneIds, mesh->meshBuffers->vertexCount * 4 * sizeof(unsigned char), dynamic);
+			rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS, 4, RL_UNSIGNED_BYTE, 0, 0, 0);
+			rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS);
+		}
+		else
+		{
+			// Default vertex attribute: boneIds
+			// WARNING: Default value provided to shader if location available
+			float value[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS, value, SHADER_ATTRIB_VEC4, 4);
+			rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS);
+		}
+
+		if (mesh->meshBuffers->boneWeights != NULL)
+		{
+			// Enable vertex attribute: boneWeights (shader-location = 8)
+			mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS] = rlLoadVertexBuffer(mesh->meshBuffers->boneWeights, mesh->meshBuffers->vertexCount * 4 * sizeof(float), dynamic);
+			rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS, 4, RL_FLOAT, 0, 0, 0);
+			rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS);
+		}
+		else
+		{
+			// Default vertex attribute: boneWeights
+			// WARNING: Default value provided to shader if location available
+			float value[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			rlSetVertexAttributeDefault(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS, value, SHADER_ATTRIB_VEC4, 2);
+			rlDisableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS);
+		}
+#endif
+	}
+
+	if (mesh->meshBuffers->indices32 != NULL)
+	{
+		mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES] = rlLoadVertexBufferElement(mesh->meshBuffers->indices32, mesh->meshBuffers->triangleCount * 3 * sizeof(unsigned int), dynamic);
+	}
+	else if (mesh->meshBuffers->indices != NULL)
+	{
+		mesh->gpuMesh.vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES] = rlLoadVertexBufferElement(mesh->meshBuffers->indices, mesh->meshBuffers->triangleCount * 3 * sizeof(unsigned short), dynamic);
+	}
+
+	if (mesh->gpuMesh.vaoId > 0) TRACELOG(LOG_INFO, "VAO: [ID %i] Mesh uploaded successfully to VRAM (GPU)", mesh->vaoId);
+	else TRACELOG(LOG_INFO, "VBO: Mesh uploaded successfully to VRAM (GPU)");
+
+	rlDisableVertexArray();
+#endif
+
+	mesh->gpuMesh.isIndexed = mesh->meshBuffers->indices != NULL || mesh->meshBuffers->indices32 != NULL;
+	mesh->gpuMesh.elementCount = rlmGetMeshIndexCount(mesh->meshBuffers);
+
+	for (int i = 0; i < mesh->lodCount; i++)
+		rlmUploadMeshLOD(mesh, &mesh->lods[i]);
+
+	if (releaseGeoBuffers)
+	{
+		rlUnloadMeshBuffer(mesh->meshBuffers);
+		mesh->meshBuffers = NULL;
+	}
+}
+
+void rlmUnloadMesh(rlmMesh* mesh)
+{
+	if (!mesh)
+		return;
+
+	MemFree(mesh->name);
+	mesh->name = NULL;
+
+#if defined(RLM_SUPPORT_MULTIDRAW)
+	rlmReleaseMultiDrawEntry(mesh);
+#endif
+
+	rlmUnloadGPUMeshBuffers(&mesh->gpuMesh);
+
+	rlUnloadMeshBuffer(mesh->meshBuffers);
+	mesh->meshBuffers = NULL;
+
+	for (int i = 0; i < mesh->lodCount; i++)
+		rlmUnloadMeshLOD(&mesh->lods[i]);
+	mesh->lodCount = 0;
+}
+
+rlmMaterialDef rlmGetDefaultMaterial()
+{
+	rlmMaterialDef material = { 0 };
+	material.name = (char*)MemAlloc(32);
+	material.name[0] = '\0';
+	strcpy(material.name, "rlmDefaultMaterial");
+
+	if (DefaultMaterialShaderSet)
+	{
+		material.shader.id = DefaultMaterialShader.id;
+		material.shader.locs = DefaultMaterialShader.locs;
+		material.ownsShader = false;
+	}
+	else
+	{
+		material.shader.id = rlGetShaderIdDefault();
+		material.shader.locs = rlGetShaderLocsDefault();
+		material.ownsShader = true;
+	}
+
+	material.baseChannel.ownsTexture = false;
+	material.baseChannel.textureId = rlGetTextureIdDefault();
+	material.baseChannel.textureLoc = -1;
+
+	material.baseChannel.color = WHITE;
+	material.baseChannel.colorLoc = -SHADER_LOC_COLOR_DIFFUSE;
+
+	material.extraChannels = 0;
+	material.extraChannels = NULL;
+
+	return material;
+}
+
+void rlmUnloadMaterial(rlmMaterialDef* material)
+{
+	if (!material)
+		return;
+
+	MemFree(material->name);
+	material->name = NULL;
+
+	if (material->ownsShader)
+	{
+		if (material->shader.id != rlGetShaderIdDefault())
+		{
+			rlmStateForgetProgram(material->shader.id);
+			rlUnloadShaderProgram(material->shader.id);
+			MemFree(material->shader.locs);
+		}
+		material->shader.locs = NULL;
+	}
+
+	if (material->baseChannel.ownsTexture)
+	{
+		rlUnloadTexture(material->baseChannel.textureId);
+		material->baseChannel.textureId = 0;
+	}
+
+	for (int i = 0; i < material->materialChannels; i++)
+	{
+		if (material->extraChannels[i].ownsTexture)
+			rlUnloadTexture(material->extraChannels[i].textureId);
+		material->extraChannels[i].textureId = 0;
+	}
+
+	if (material->values)
+		MemFree(material->values);
+
+	material->values = NULL;
+	material->materialValues = 0;
+}
+
+void rlmAddMaterialChannel(rlmMaterialDef* material, Texture2D texture, int shaderLoc, int slot, bool isCubeMap)
+{
+	if (!material)
+		return;
+
+	if (material->materialChannels == 0 || !material->extraChannels)
+	{
+		material->materialChannels = 1;
+		material->extraChannels = (rlmMaterialChannel*)MemAlloc(sizeof(rlmMaterialChannel));
+	}
+	else
+	{
+		material->materialChannels++;
+		material->extraChannels = (rlmMaterialChannel*)MemRealloc(material->extraChannels, sizeof(rlmMaterialChannel) * material->materialChannels);
+	}
+
+	material->extraChannels[material->materialChannels - 1].ownsTexture = false;
+	material->extraChannels[material->materialChannels - 1].cubeMap = isCubeMap;
+	material->extraChannels[material->materialChannels - 1].textureId = texture.id;
+	material->extraChannels[material->materialChannels - 1].textureLoc = shaderLoc;
+	material->extraChannels[material->materialChannels - 1].textureSlot = slot;
+	material->extraChannels[material->materialChannels - 1].color = WHITE;
+	material->extraChannels[material->materialChannels - 1].colorLoc = 0;
+}
+
+void rlmAddMaterialChannels(rlmMaterialDef* material, int count, Texture2D* textures, int* locs)
+{
+	if (!material)
+		return;
+
+	if (material->materialChannels == 0 || !material->extraChannels)
+	{
+		material->materialChannels = count;
+		material->extraChannels = (rlmMaterialChannel*)MemAlloc(sizeof(rlmMaterialChannel) * count);
+	}
+	else
+	{
+		material->materialChannels += count;
+		material->extraChannels = (rlmMaterialChannel*)MemRealloc(material->extraChannels, sizeof(rlmMaterialChannel) * material->materialChannels);
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		int index = material->materialChannels - count + i;
+
+		material->extraChannels[material->materialChannels - 1].cubeMap = false;
+		material->extraChannels[material->materialChannels - 1].ownsTexture = false;
+
+		material->extraChannels[material->materialChannels - 1].color = WHITE;
+		material->extraChannels[material->materialChannels - 1].colorLoc = -1;
+
+		material->extraChannels[material->materialChannels - 1].textureSlot = -1;
+
+		if (textures && locs)
+		{
+			material->extraChannels[material->materialChannels - 1].textureId = textures[i].id;
+			material->extraChannels[material->materialChannels - 1].textureLoc = locs[i];
+		}
+		else
+		{
+			material->extraChannels[material->materialChannels - 1].textureId = 0;
+			material->extraChannels[material->materialChannels - 1].textureLoc = -1;
+		}
+	}
+}
+
+int rlmAddMaterialValue(rlmMaterialDef* material, int shaderLoc, float value)
+{
+	if (!material)
+		return -1;
+
+	int index = 0;
+	if (!material->values || material->materialValues == 0)
+	{
+		material->values = (rlmMaterialValueF*)MemAlloc(sizeof(rlmMaterialValueF));
+		material->materialValues = 1;
+	}
+	else
+	{
+		index = material->materialValues;
+		material->materialValues++;
+		material->values = (rlmMaterialValueF*)MemRealloc(material->values, sizeof(rlmMaterialValueF) * material->materialValues);
+	}
+
+	material->values[index].shaderLoc = shaderLoc;
+	material->values[index].value = value;
+
+	return index;
+}
+
+void rlmSetMaterialValue(rlmMaterialDef* material, int valueIndex, float value)
+{
+	if (!material || valueIndex >= material->materialValues)
+		return;
+
+	material->values[valueIndex].value = value;
+}
+
+void rlmSetMaterialDefShader(rlmMaterialDef* material, Shader shader)
+{
+	if (!material)
+		return;
+
+	material->shader = shader;
+	material->ownsShader = false;
+}
+
+void rlmSetMaterialChannelTexture(rlmMaterialChannel* channel, Texture2D texture)
+{
+	if (!channel)
+		return;
+
+	channel->ownsTexture = false;
+	channel->textureId = texture.id;
+}
+
+void rlmCloneMaterial(const rlmMaterialDef* oldMaterial, rlmMaterialDef* newMaterial)
+{
+	if (!oldMaterial || !newMaterial)
+		return;
+
+	newMaterial->name = (char*)MemAlloc(32);
+	newMaterial->name[0] = '\0';
+
+	strcpy(newMaterial->name, oldMaterial->name);
+	newMaterial->baseChannel = oldMaterial->baseChannel;
+	newMaterial->baseChannel.ownsTexture = false;
+
+	newMaterial->shader = oldMaterial->shader;
+	newMaterial->ownsShader = false;
+
+	newMaterial->materialChannels = oldMaterial->materialChannels;
+
+	if (newMaterial->materialChannels > 0 && oldMaterial->extraChannels)
+	{
+		newMaterial->extraChannels = (rlmMaterialChannel*)MemAlloc(sizeof(rlmMaterialChannel) * newMaterial->materialChannels);
+
+		for (int i = 0; i < newMaterial->materialChannels; i++)
+		{
+			newMaterial->extraChannels[i] = oldMaterial->extraChannels[i];
+			newMaterial->extraChannels[i].ownsTexture = false;
+		}
+	}
+
+	newMaterial->materialValues = oldMaterial->materialValues;
+
+	if (newMaterial->materialValues > 0 && oldMaterial->materialValues)
+	{
+		newMaterial->values = (rlmMaterialValueF*)MemAlloc(sizeof(rlmMaterialValueF) * newMaterial->materialValues);
+
+		for (int i = 0; i < newMaterial->materialValues; i++)
+		{
+			newMaterial->values[i].shaderLoc = oldMaterial->values[i].shaderLoc;
+			newMaterial->values[i].value = oldMaterial->values[i].value;
+		}
+	}
+}
+
+rlmModel rlmCloneModel(rlmModel model)
+{
+	rlmModel newModel;
+
+	newModel.orientationTransform = model.orientationTransform;
+
+	newModel.groupCount = model.groupCount;
+
+	newModel.skeleton = model.skeleton;
+	newModel.ownsSkeleton = false;
+
+	newModel.animationLOD = model.animationLOD;
+
+	newModel.groups = (rlmModelGroup*)MemAlloc(sizeof(rlmModelGroup) * newModel.groupCount);
+	for (int group = 0; group < newModel.groupCount; group++)
+	{
+		rlmModelGroup* newGroup = newModel.groups + group;
+		const rlmModelGroup* oldGroup = model.groups + group;
+
+		rlmCloneMaterial(&oldGroup->material, &newGroup->material);
+
+		newGroup->ownsMeshes = false;
+		newGroup->ownsMeshList = false;
+
+		newGroup->meshDisableFlags = (bool*)MemAlloc(sizeof(bool) * oldGroup->meshCount);
+		for (int i = 0; i < oldGroup->meshCount; i++)
+			newGroup->meshDisableFlags[i] = oldGroup->meshDisableFlags[i];
+
+		// clones keep their own LOD levels, since they are drawn at different distances
+		newGroup->meshLODLevels = NULL;
+
+		newGroup->batchCount = oldGroup->batchCount;
+		newGroup->batches = oldGroup->batches;
+		newGroup->ownsBatches = false;
+
+		newGroup->meshCount = oldGroup->meshCount;
+		newGroup->meshes = oldGroup->meshes;
+	}
+
+	return newModel;
+}
+
+void rlmSetModelShader(rlmModel* model, Shader shader)
+{
+	for (int group = 0; group < model->groupCount; group++)
+	{
+		rlmModelGroup* groupPtr = model->groups + group;
+
+		groupPtr->material.shader = shader;
+		groupPtr->material.ownsShader = false;
+	}
+}
+
+void rlmUnloadModel(rlmModel* model)
+{
+	if (!model)
+		return;
+
+	for (int group = 0; group < model->groupCount; group++)
+	{
+		rlmModelGroup* groupPtr = model->groups + group;
+
+		rlmUnloadMaterial(&groupPtr->material);
+
+		if (groupPtr->ownsMeshes)
+		{
+			for (int i = 0; i < groupPtr->meshCount; i++)
+				rlmUnloadMesh(groupPtr->meshes + i);
+		}
+
+		if (groupPtr->ownsMeshList)
+			MemFree(groupPtr->meshes);
+
+		rlmUnbatchModelGroup(groupPtr);
+
+		MemFree(groupPtr->meshDisableFlags);
+		MemFree(groupPtr->meshLODLevels);
+
+		groupPtr->meshDisableFlags = NULL;
+		groupPtr->meshLODLevels = NULL;
+		groupPtr->meshCount = 0;
+		groupPtr->meshes = 0;
+	}
+
+	model->groupCount = 0;
+	MemFree(model->groups);
+	model->groups = NULL;
+
+	if (model->ownsSkeleton && model->skeleton)
+	{
+		MemFree(model->skeleton->bones);
+		model->skeleton->bones = NULL;
+		MemFree(model->skeleton->bindingFrame.boneTransforms);
+		model->skeleton->bindingFrame.boneTransforms = NULL;
+
+		MemFree(model->skeleton->inverseBindingFrame.boneTransforms);
+		model->skeleton->inverseBindingFrame.boneTransforms = NULL;
+
+		MemFree(model->skeleton->boneOrder);
+		MemFree(model->skeleton->slotParents);
+		MemFree(model->skeleton->slotSubtreeEnds);
+		MemFree(model->skeleton->boneSlots);
+		MemFree(model->skeleton->slotDepths);
+		MemFree(model->skeleton->depthSortedBones);
+		MemFree(model->skeleton->depthBoneCounts);
+		MemFree(model->skeleton->boneNameHash);
+
+		MemFree(model->skeleton);
+	}
+
+	model->ownsSkeleton = false;
+	model->skeleton = NULL;
+}
+
+static void rlmApplyMaterialChannelCached(rlmMaterialChannel* channel, Shader* shader)
+{
+	rlmStateBindTexture(channel->textureSlot, channel->textureId, channel->cubeMap);
+	rlmStateSetUniform(channel->textureLoc, &channel->textureSlot, SHADER_UNIFORM_INT, 1);
+
+	int locToUse = channel->colorLoc;
+	if (locToUse < 0)
+		locToUse = shader->locs[locToUse * -1];
+
+	// if (locToUse > 0)
+	{
+		float values[4] = {
+			   (float)channel->color.r / 255.0f,
+			   (float)channel->color.g / 255.0f,
+			   (float)channel->color.b / 255.0f,
+			   (float)channel->color.a / 255.0f
+		};
+		rlmStateSetUniform(locToUse, values, SHADER_UNIFORM_VEC4, 1);
+	}
+}
+
+// skips anything already bound or set earlier in the same draw call
+static void rlmApplyMaterialDefCached(rlmMaterialDef* material)
+{
+	rlmStateUseProgram(material->shader.id);
+
+	rlmApplyMaterialChannelCached(&material->baseChannel, &material->shader);
+
+	for (int index = 0; index < material->materialChannels; index++)
+		rlmApplyMaterialChannelCached(&material->extraChannels[index], &material->shader);
+
+	for (int i = 0; i < material->materialValues; i++)
+		rlmStateSetUniform(material->values[i].shaderLoc, &material->values[i].value, SHADER_UNIFORM_FLOAT, 1);
+}
+
+void rlmApplyMaterialChannel(rlmMaterialChannel* channel, Shader* shader, int index)
+{
+	if (!channel)
+		return;
+
+	// called from outside a draw, so nothing bound or set can be trusted
+	rlmStateBeginDraw();
+	rlmApplyMaterialChannelCached(channel, shader);
+}
+
+void rlmResetMaterialChannel(rlmMaterialChannel* channel)
+{
+	if (!channel)
+		return;
+
+	rlActiveTextureSlot(channel->textureSlot);
+	if (channel->cubeMap)
+		rlDisableTextureCubemap();
+	else
+		rlDisableTexture();
+
+	rlmStateForgetBindings();
+}
+
+void rlmApplyMaterialDef(rlmMaterialDef* material)
+{
+	if (!material)
+		return;
+
+	rlmStateBeginDraw();
+	rlmApplyMaterialDefCached(material);
+}
+
+void rlmResetMaterialDef(rlmMaterialDef* material)
+{
+	if (!material)
+		return;
+
+	int index = 0;
+	rlmResetMaterialChannel(&material->baseChannel);
+
+	for (index = 1; index < material->materialChannels + 1; index++)
+		rlmResetMaterialChannel(&material->extraChannels[index - 1]);
+}
+
+Matrix rlmPQSToMatrix(const rlmPQSTransorm* transform)
+{
+	Matrix matScale = MatrixScale(transform->scale.x, transform->scale.y, transform->scale.z);
+
+	Vector3 axis = { 0 };
+	float angle = 0;
+
+	QuaternionToAxisAngle(transform->rotation, &axis, &angle);
+	Matrix matRotation = MatrixRotate(axis, angle);
+	Matrix matTranslation = MatrixTranslate(transform->position.x, transform->position.y, transform->position.z);
+
+	return MatrixMultiply(MatrixMultiply(matScale, matRotation), matTranslation);
+}
+
+rlmPQSTransorm rlmPQSFromMatrix(Matrix matrix)
+{
+	rlmPQSTransorm transform;
+
+	MatrixDecompose(matrix, &transform.position, &transform.rotation, &transform.scale);
+
+	return transform;
+}
+
+// without a vertex array each attribute is pointed at its buffer at the location the shader has for it
+static void rlmSetMeshAttribute(const rlmGPUMesh* mesh, const rlmVertexAttributeFormat* formats, int formatCount, int location, int shaderLoc)
+{
+	if (shaderLoc < 0)
+		return;
+
+	const rlmVertexAttributeFormat* format = NULL;
+	for (int i = 0; i < formatCount && format == NULL; i++)
+	{
+		if (formats[i].location == location)
+			format = &formats[i];
+	}
+
+	// missing attributes keep the float format they always had
+	rlmVertexAttributeFormat fallback[RLM_VERTEX_ATTRIBUTES];
+	if (format == NULL)
+	{
+		int strides[2];
+		if (rlmGetVertexFormat(RLM_VERTEX_SEPARATE, 1u << location, fallback, strides) == 0)
+			return;
+		format = &fallback[0];
+	}
+
+	rlEnableVertexBuffer(mesh->vboIds[location]);
+	rlSetVertexAttribute(shaderLoc, format->size, format->type, format->normalized, format->stride, format->offset);
+}
+
+static void rlmBindMeshAttributes(rlmGPUMesh* mesh, Shader* shader)
+{
+#if defined(RLM_SUPPORT_MULTIDRAW)
+	// before the vertex array is bound, making the transform buffer the first time binds the shared one
+	rlmBindMultiDrawIdentity(shader);
+#endif
+
+	// Try binding vertex array objects (VAO) or use VBOs if not possible
+	// WARNING: UploadMesh() enables all vertex attributes available in mesh and sets default attribute values
+	// for shader expected vertex attributes that are not provided by the mesh (i.e. colors)
+	// This could be a dangerous approach because different meshes with different shaders can enable/disable some attributes
+	if (!rlEnableVertexArray(mesh->vaoId))
+	{
+		rlmVertexAttributeFormat formats[RLM_VERTEX_ATTRIBUTES];
+		int strides[2];
+		int formatCount = rlmGetVertexFormat(mesh->vertexLayout, rlmGetGPUMeshAttributes(mesh), formats, strides);
+
+		// Bind mesh VBO data: vertex position (shader-location = 0)
+		rlmSetMeshAttribute(mesh, formats, formatCount, RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, shader->locs[SHADER_LOC_VERTEX_POSITION]);
+		rlmStateEnableAttribute(shader->locs[SHADER_LOC_VERTEX_POSITION], true);
+
+		// Bind mesh VBO data: vertex texcoords (shader-location = 1)
+		rlmSetMeshAttribute(mesh, formats, formatCount, RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, shader->locs[SHADER_LOC_VERTEX_TEXCOORD01]);
+		rlmStateEnableAttribute(shader->locs[SHADER_LOC_VERTEX_TEXCOORD01], true);
+
+		if (shader->locs[SHADER_LOC_VERTEX_NORMAL] != -1)
+		{
+			// Bind mesh VBO data: vertex normals (shader-location = 2)
+			rlmSetMeshAttribute(mesh, formats, formatCount, RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, shader->locs[SHADER_LOC_VERTEX_NORMAL]);
+			rlmStateEnableAttribute(shader->locs[SHADER_LOC_VERTEX_NORMAL], true);
+		}
+
+		// Bind mesh VBO data: vertex colors (shader-location = 3, if available)
+		if (shader->locs[SHADER_LOC_VERTEX_COLOR] != -1)
+		{
+			if (mesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR] != 0)
+			{
+				rlmSetMeshAttribute(mesh, formats, formatCount, RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, shader->locs[SHADER_LOC_VERTEX_COLOR]);
+				rlmStateEnableAttribute(shader->locs[SHADER_LOC_VERTEX_COLOR], true);
+			}
+			else
+			{
+				// Set default value for defined vertex attribute in shader but not provided by mesh
+				// WARNING: It could result in GPU undefined behavior
+				static float value[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+				rlSetVertexAttributeDefault(shader->locs[SHADER_LOC_VERTEX_COLOR], value, SHADER_ATTRIB_VEC4, 4);
+				rlmStateEnableAttribute(shader->locs[SHADER_LOC_VERTEX_COLOR], false);
+			}
+		}
+
+		// Bind mesh VBO data: vertex tangents (shader-location = 4, if available)
+		if (shader->locs[SHADER_LOC_VERTEX_TANGENT] != -1)
+		{
+			rlmSetMeshAttribute(mesh, formats, formatCount, RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT, shader->locs[SHADER_LOC_VERTEX_TANGENT]);
+			rlmStateEnableAttribute(shader->locs[SHADER_LOC_VERTEX_TANGENT], true);
+		}
+
+		// Bind mesh VBO data: vertex texcoords2 (shader-location = 5, if available)
+		if (shader->locs[SHADER_LOC_VERTEX_TEXCOORD02] != -1)
+		{
+			rlmSetMeshAttribute(mesh, formats, formatCount, RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2, shader->locs[SHADER_LOC_VERTEX_TEXCOORD02]);
+			rlmStateEnableAttribute(shader->locs[SHADER_LOC_VERTEX_TEXCOORD02], true);
+		}
+
+#ifdef RL_SUPPORT_MESH_GPU_SKINNING
+		// Bind mesh VBO data: vertex bone ids (shader-location = 6, if available)
+		if (shader->locs[SHADER_LOC_VERTEX_BONEIDS] != -1)
+		{
+			rlmSetMeshAttribute(mesh, formats, formatCount, RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS, shader->locs[SHADER_LOC_VERTEX_BONEIDS]);
+			rlmStateEnableAttribute(shader->locs[SHADER_LOC_VERTEX_BONEIDS], true);
+		}
+
+		// Bind mesh VBO data: vertex bone weights (shader-location = 7, if available)
+		if (shader->locs[SHADER_LOC_VERTEX_BONEWEIGHTS] != -1)
+		{
+			rlmSetMeshAttribute(mesh, formats, formatCount, RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS, shader->locs[SHADER_LOC_VERTEX_BONEWEIGHTS]);
+			rlmStateEnableAttribute(shader->locs[SHADER_LOC_VERTEX_BONEWEIGHTS], true);
+		}
+#endif
+
+		if (mesh->isIndexed)
+			rlEnableVertexBufferElement(mesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES]);
+	}
+}
+
+// the wide indices go straight to GL
+static void rlmDrawElements(const rlmGPUMesh* mesh, int offset, int count)
+{
+#if defined(RLM_SUPPORT_MESH_ARENA)
+	if (mesh->arenaSlot > 0)
+	{
+		int firstIndex = 0;
+		int baseVertex = 0;
+		rlmGetArenaDrawOffsets(mesh, &firstIndex, &baseVertex);
+
+		if (mesh->indices32)
+			glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_INT, (const void*)((size_t)(firstIndex + offset) * sizeof(unsigned int)), baseVertex);
+		else
+			glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_SHORT, (const void*)((size_t)(firstIndex + offset) * sizeof(unsigned short)), baseVertex);
+		return;
+	}
+#endif
+
+#if defined(RLM_SUPPORT_32BIT_INDICES)
+	if (mesh->indices32)
+	{
+		glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (const void*)((size_t)offset * sizeof(unsigned int)));
+		return;
+	}
+#else
+	(void)mesh;	// only 16 bit indices get uploaded
+#endif
+
+	rlDrawVertexArrayElements(offset, count, 0);
+}
+
+static void rlmDrawGPUMesh(rlmGPUMesh* mesh, Shader* shader)
+{
+	rlmBindMeshAttributes(mesh, shader);
+
+	// Draw mesh
+	if (mesh->isIndexed)
+		rlmDrawElements(mesh, 0, mesh->elementCount);
+	else
+		rlDrawVertexArray(0, mesh->elementCount);
+
+	// Disable all possible vertex array objects (or VBOs)
+	rlDisableVertexArray();
+	rlDisableVertexBuffer();
+	rlDisableVertexBufferElement();
+}
+
+// meshes in the same arena page share a vertex array, so it is left bound from one to the next
+// boundVaoId is the arena vertex array still bound, 0 when nothing is, unbind it once the last mesh is drawn
+static void rlmDrawGPUMeshShared(rlmGPUMesh* mesh, Shader* shader, unsigned int* boundVaoId)
+{
+	if (mesh->arenaSlot == 0)
+	{
+		rlmDrawGPUMesh(mesh, shader);
+		*boundVaoId = 0;
+		return;
+	}
+
+	if (mesh->vaoId != *boundVaoId)
+	{
+		rlmBindMeshAttributes(mesh, shader);
+		*boundVaoId = mesh->vaoId;
+	}
+
+	rlmDrawElements(mesh, 0, mesh->elementCount);
+}
+
+void rlmDrawMesh(rlmGPUMesh* mesh, Shader* shader)
+{
+	if (!mesh || !shader)
+		return;
+
+	rlmDrawGPUMesh(mesh, shader);
+
+	// the caller may change attributes before the next call
+	for (int i = 0; i < RLM_STATE_VERTEX_ATTRIBUTES; i++)
+		StateCache.attributes[i] = -1;
+}
+
+static bool rlmIsPQSIdentity(const rlmPQSTransorm* transform)
+{
+	return transform->position.x == 0 && transform->position.y == 0 && transform->position.z == 0 &&
+		transform->rotation.x == 0 && transform->rotation.y == 0 && transform->rotation.z == 0 && transform->rotation.w == 1 &&
+		transform->scale.x == 1 && transform->scale.y == 1 && transform->scale.z == 1;
+}
+
+// frustum culling
+static bool UseFrustumCulling = true;
+static rlmCullingStats CullingStats = { 0 };
+
+void rlmSetFrustumCulling(bool enabled)
+{
+	UseFrustumCulling = enabled;
+}
+
+rlmCullingStats rlmGetCullingStats()
+{
+	return CullingStats;
+}
+
+void rlmResetCullingStats()
+{
+	CullingStats = (rlmCullingStats){ 0 };
+}
+
+// meshes built by hand may have no bounds, those are never culled
+static bool rlmIsBoxValid(const BoundingBox* box)
+{
+	if (box->min.x > box->max.x || box->min.y > box->max.y || box->min.z > box->max.z)
+		return false;
+
+	return box->min.x != box->max.x || box->min.y != box->max.y || box->min.z != box->max.z;
+}
+
+static BoundingBox rlmTransformBox(BoundingBox box, Matrix matrix)
+{
+	Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+	Vector3 extents = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+
+	Vector3 newCenter = Vector3Transform(center, matrix);
+	Vector3 newExtents = {
+		fabsf(matrix.m0) * extents.x + fabsf(matrix.m4) * extents.y + fabsf(matrix.m8) * extents.z,
+		fabsf(matrix.m1) * extents.x + fabsf(matrix.m5) * extents.y + fabsf(matrix.m9) * extents.z,
+		fabsf(matrix.m2) * extents.x + fabsf(matrix.m6) * extents.y + fabsf(matrix.m10) * extents.z,
+	};
+
+	return (BoundingBox){ Vector3Subtract(newCenter, newExtents), Vector3Add(newCenter, newExtents) };
+}
+
+static Vector4 rlmNormalizePlane(float x, float y, float z, float w)
+{
+	float length = sqrtf(x * x + y * y + z * z);
+	if (length > 0)
+		length = 1.0f / length;
+
+	return (Vector4){ x * length, y * length, z * length, w * length };
+}
+
+rlmFrustum rlmGetFrustumFromMatrix(Matrix viewProjection)
+{
+	const Matrix* m = &viewProjection;
+
+	rlmFrustum frustum;
+	frustum.planes[0] = rlmNormalizePlane(m->m3 + m->m0, m->m7 + m->m4, m->m11 + m->m8, m->m15 + m->m12);	// left
+	frustum.planes[1] = rlmNormalizePlane(m->m3 - m->m0, m->m7 - m->m4, m->m11 - m->m8, m->m15 - m->m12);	// right
+	frustum.planes[2] = rlmNormalizePlane(m->m3 + m->m1, m->m7 + m->m5, m->m11 + m->m9, m->m15 + m->m13);	// bottom
+	frustum.planes[3] = rlmNormalizePlane(m->m3 - m->m1, m->m7 - m->m5, m->m11 - m->m9, m->m15 - m->m13);	// top
+	frustum.planes[4] = rlmNormalizePlane(m->m3 + m->m2, m->m7 + m->m6, m->m11 + m->m10, m->m15 + m->m14);	// near
+	frustum.planes[5] = rlmNormalizePlane(m->m3 - m->m2, m->m7 - m->m6, m->m11 - m->m10, m->m15 - m->m14);	// far
+
+	return frustum;
+}
+
+rlmFrustum rlmGetCurrentFrustum()
+{
+	return rlmGetFrustumFromMatrix(MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+}
+
+bool rlmIsBoxInFrustum(const rlmFrustum* frustum, BoundingBox box)
+{
+	if (!frustum || !rlmIsBoxValid(&box))
+		return true;
+
+	Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+	Vector3 extents = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+
+	for (int i = 0; i < 6; i++)
+	{
+		const Vector4* plane = &frustum->planes[i];
+		float distance = plane->x * center.x + plane->y * center.y + plane->z * center.z + plane->w;
+		float radius = fabsf(plane->x) * extents.x + fabsf(plane->y) * extents.y + fabsf(plane->z) * extents.z;
+
+		if (distance + radius < 0)
+			return false;
+	}
+
+	return true;
+}
+
+#if defined(RLM_USE_SSE2)
+// tests 4 boxes against all the planes at once, returns a 4 bit mask of the visible ones
+static int rlmCullBoxes4(const rlmFrustum* frustum, const BoundingBox* boxes)
+{
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	__m128 minX = _mm_setr_ps(boxes[0].min.x, boxes[1].min.x, boxes[2].min.x, boxes[3].min.x);
+	__m128 minY = _mm_setr_ps(boxes[0].min.y, boxes[1].min.y, boxes[2].min.y, boxes[3].min.y);
+	__m128 minZ = _mm_setr_ps(boxes[0].min.z, boxes[1].min.z, boxes[2].min.z, boxes[3].min.z);
+	__m128 maxX = _mm_setr_ps(boxes[0].max.x, boxes[1].max.x, boxes[2].max.x, boxes[3].max.x);
+	__m128 maxY = _mm_setr_ps(boxes[0].max.y, boxes[1].max.y, boxes[2].max.y, boxes[3].max.y);
+	__m128 maxZ = _mm_setr_ps(boxes[0].max.z, boxes[1].max.z, boxes[2].max.z, boxes[3].max.z);
+
+	__m128 centerX = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+	__m128 centerY = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+	__m128 centerZ = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+	__m128 extentX = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+	__m128 extentY = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+	__m128 extentZ = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+	__m128 outside = _mm_setzero_ps();
+	for (int i = 0; i < 6; i++)
+	{
+		const Vector4* plane = &frustum->planes[i];
+
+		__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(plane->x)), _mm_mul_ps(centerY, _mm_set1_ps(plane->y))),
+			_mm_add_ps(_mm_mul_ps(centerZ, _mm_set1_ps(plane->z)), _mm_set1_ps(plane->w)));
+
+		__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(extentX, _mm_set1_ps(fabsf(plane->x))), _mm_mul_ps(extentY, _mm_set1_ps(fabsf(plane->y)))),
+			_mm_mul_ps(extentZ, _mm_set1_ps(fabsf(plane->z))));
+
+		outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+	}
+
+	return ~_mm_movemask_ps(outside) & 0xF;
+}
+#endif
+
+int rlmCullBoxes(const rlmFrustum* frustum, const BoundingBox* boxes, int count, bool* visible)
+{
+	if (!frustum || !boxes || !visible || count <= 0)
+		return 0;
+
+	int visibleCount = 0;
+	int i = 0;
+
+#if defined(RLM_USE_SSE2)
+	for (; i + 4 <= count; i += 4)
+	{
+		int mask = rlmCullBoxes4(frustum, boxes + i);
+
+		for (int lane = 0; lane < 4; lane++)
+		{
+			// boxes without bounds are always drawn
+			visible[i + lane] = (mask & (1 << lane)) != 0 || !rlmIsBoxValid(&boxes[i + lane]);
+			visibleCount += visible[i + lane] ? 1 : 0;
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		visible[i] = rlmIsBoxInFrustum(frustum, boxes[i]);
+		visibleCount += visible[i] ? 1 : 0;
+	}
+
+	return visibleCount;
+}
+
+// the mesh transform goes on after the model matrix, same as rlmDrawModel
+static BoundingBox rlmGetModelBoundsWithMatrix(const rlmModel* model, Matrix modelMatrix)
+{
+	BoundingBox bounds = { 0 };
+	bool first = true;
+
+	for (int group = 0; group < model->groupCount; group++)
+	{
+		const rlmModelGroup* groupPtr = model->groups + group;
+		for (int i = 0; i < groupPtr->meshCount; i++)
+		{
+			const rlmMesh* mesh = &groupPtr->meshes[i];
+			if (!rlmIsBoxValid(&mesh->bounds))
+				continue;
+
+			Matrix matMesh = modelMatrix;
+			if (!rlmIsPQSIdentity(&mesh->transform))
+				matMesh = MatrixMultiply(modelMatrix, rlmPQSToMatrix(&mesh->transform));
+
+			BoundingBox meshBounds = rlmTransformBox(mesh->bounds, matMesh);
+
+			if (first)
+			{
+				bounds = meshBounds;
+				first = false;
+			}
+			else
+			{
+				bounds.min = Vector3Min(bounds.min, meshBounds.min);
+				bounds.max = Vector3Max(bounds.max, meshBounds.max);
+			}
+		}
+	}
+
+	return bounds;
+}
+
+BoundingBox rlmGetModelBounds(rlmModel model)
+{
+	return rlmGetModelBoundsWithMatrix(&model, rlmPQSToMatrix(&model.orientationTransform));
+}
+
+BoundingBox rlmGetModelWorldBounds(rlmModel model, rlmPQSTransorm transform)
+{
+	return rlmGetModelBoundsWithMatrix(&model, MatrixMultiply(rlmPQSToMatrix(&model.orientationTransform), rlmPQSToMatrix(&transform)));
+}
+
+// the model level box, only usable when every mesh has bounds, meshes without them are never culled
+static bool rlmGetModelCullBox(const rlmModel* model, Matrix matModel, BoundingBox* box)
+{
+	int meshCount = 0;
+	for (int group = 0; group < model->groupCount; group++)
+	{
+		const rlmModelGroup* groupPtr = model->groups + group;
+		for (int i = 0; i < groupPtr->meshCount; i++)
+		{
+			if (!rlmIsBoxValid(&groupPtr->meshes[i].bounds))
+				return false;
+		}
+		meshCount += groupPtr->meshCount;
+	}
+
+	if (meshCount == 0)
+		return false;
+
+	*box = rlmGetModelBoundsWithMatrix(model, matModel);
+	return true;
+}
+
+// mesh transforms go on after the model matrix, so a box made without it can't just be moved to each instance
+static bool rlmModelHasMeshTransforms(const rlmModel* model)
+{
+	for (int group = 0; group < model->groupCount; group++)
+	{
+		const rlmModelGroup* groupPtr = model->groups + group;
+		for (int i = 0; i < groupPtr->meshCount; i++)
+		{
+			if (!rlmIsPQSIdentity(&groupPtr->meshes[i].transform))
+				return true;
+		}
+	}
+
+	return false;
+}
+
+static bool rlmIsMeshVisible(const rlmFrustum* frustum, const rlmMesh* mesh, Matrix matModel)
+{
+	if (!rlmIsBoxValid(&mesh->bounds))
+		return true;
+
+	Matrix matMesh = matModel;
+	if (!rlmIsPQSIdentity(&mesh->transform))
+		matMesh = MatrixMultiply(matModel, rlmPQSToMatrix(&mesh->transform));
+
+	return rlmIsBoxInFrustum(frustum, rlmTransformBox(mesh->bounds, matMesh));
+}
+
+// static batches
+static void rlmUnloadMeshBatch(rlmMeshBatch* batch)
+{
+	rlmUnloadGPUMeshBuffers(&batch->gpuMesh);
+
+	MemFree(batch->indexStarts);
+	MemFree(batch->indexCounts);
+	MemFree(batch->bounds);
+
+	*batch = (rlmMeshBatch){ 0 };
+}
+
+void rlmUnbatchModelGroup(rlmModelGroup* group)
+{
+	if (!group)
+		return;
+
+	if (group->ownsBatches)
+	{
+		for (int i = 0; i < group->batchCount; i++)
+			rlmUnloadMeshBatch(&group->batches[i]);
+
+		MemFree(group->batches);
+	}
+
+	group->batches = NULL;
+	group->batchCount = 0;
+	group->ownsBatches = false;
+}
+
+// copies the meshes from first to first + count into one set of buffers, with each mesh's transform applied
+static bool rlmBuildMeshBatch(rlmModelGroup* group, int first, int count, rlmMeshBatch* batch)
+{
+	int vertexCount = 0;
+	int indexCount = 0;
+	bool hasNormals = false, hasColors = false, hasTangents = false, hasTexcoords2 = false;
+
+	for (int i = first; i < first + count; i++)
+	{
+		const rlmMeshBuffers* buffers = group->meshes[i].meshBuffers;
+		vertexCount += buffers->vertexCount;
+		indexCount += rlmGetMeshIndexCount(buffers);
+
+		hasNormals |= buffers->normals != NULL;
+		hasColors |= buffers->colors != NULL;
+		hasTangents |= buffers->tangents != NULL;
+		hasTexcoords2 |= buffers->texcoords2 != NULL;
+	}
+
+	// the buffers are handed to rlmUploadMesh, which frees them
+	rlmMeshBuffers* merged = (rlmMeshBuffers*)MemAlloc(sizeof(rlmMeshBuffers));
+	merged->vertexCount = vertexCount;
+	merged->triangleCount = indexCount / 3;
+	merged->vertices = (float*)MemAlloc(vertexCount * 3 * sizeof(float));
+	merged->texcoords = (float*)MemAlloc(vertexCount * 2 * sizeof(float));
+	merged->indices = (unsigned short*)MemAlloc(indexCount * sizeof(unsigned short));
+	if (hasNormals)
+		merged->normals = (float*)MemAlloc(vertexCount * 3 * sizeof(float));
+	if (hasColors)
+		merged->colors = (unsigned char*)MemAlloc(vertexCount * 4);
+	if (hasTangents)
+		merged->tangents = (float*)MemAlloc(vertexCount * 4 * sizeof(float));
+	if (hasTexcoords2)
+		merged->texcoords2 = (float*)MemAlloc(vertexCount * 2 * sizeof(float));
+
+	batch->firstMesh = first;
+	batch->meshCount = count;
+	batch->indexStarts = (int*)MemAlloc(count * sizeof(int));
+	batch->indexCounts = (int*)MemAlloc(count * sizeof(int));
+	batch->bounds = (BoundingBox*)MemAlloc(count * sizeof(BoundingBox));
+
+	int baseVertex = 0;
+	int baseIndex = 0;
+	for (int m = 0; m < count; m++)
+	{
+		const rlmMesh* mesh = &group->meshes[first + m];
+		const rlmMeshBuffers* buffers = mesh->meshBuffers;
+
+		for (int v = 0; v < buffers->vertexCount; v++)
+		{
+			int out = baseVertex + v;
+
+			memcpy(merged->vertices + out * 3, buffers->vertices + v * 3, 3 * sizeof(float));
+
+			if (buffers->texcoords)
+				memcpy(merged->texcoords + out * 2, buffers->texcoords + v * 2, 2 * sizeof(float));
+
+			if (hasNormals)
+			{
+				Vector3 normal = { 0, 0, 1 };
+				if (buffers->normals)
+					normal = (Vector3){ buffers->normals[v * 3], buffers->normals[v * 3 + 1], buffers->normals[v * 3 + 2] };
+
+				memcpy(merged->normals + out * 3, &normal, 3 * sizeof(float));
+			}
+
+			if (hasColors)
+			{
+				if (buffers->colors)
+					memcpy(merged->colors + out * 4, buffers->colors + v * 4, 4);
+				else
+					memset(merged->colors + out * 4, 255, 4);
+			}
+
+			if (hasTangents && buffers->tangents)
+				memcpy(merged->tangents + out * 4, buffers->tangents + v * 4, 4 * sizeof(float));
+
+			if (hasTexcoords2 && buffers->texcoords2)
+				memcpy(merged->texcoords2 + out * 2, buffers->texcoords2 + v * 2, 2 * sizeof(float));
+		}
+
+		int meshIndexCount = rlmGetMeshIndexCount(buffers);
+		for (int i = 0; i < meshIndexCount; i++)
+		{
+			merged->indices[baseIndex + i] = (unsigned short)(baseVertex + rlmGetMeshIndex(buffers, i));
+		}
+
+		batch->indexStarts[m] = baseIndex;
+		batch->indexCounts[m] = meshIndexCount;
+		batch->bounds[m] = mesh->bounds;
+
+		baseVertex += buffers->vertexCount;
+		baseIndex += meshIndexCount;
+	}
+
+	rlmMesh batchMesh = { 0 };
+	batchMesh.meshBuffers = merged;
+	rlmUploadMesh(&batchMesh, true);
+
+	batch->gpuMesh = batchMesh.gpuMesh;
+	return batch->gpuMesh.vboIds != NULL;
+}
+
+bool rlmBatchModelGroup(rlmModelGroup* group)
+{
+	if (!group || group->meshCount <= 1)
+		return false;
+
+	for (int i = 0; i < group->meshCount; i++)
+	{
+		const rlmMeshBuffers* buffers = group->meshes[i].meshBuffers;
+		if (!buffers || !buffers->vertices)
+		{
+			TraceLog(LOG_WARNING, "rlModels : static batching needs the mesh buffers, keep the CPU data when loading");
+			return false;
+		}
+
+		// skinning happens in model space and posed draws ignore the mesh transform, so these are not static
+		if (buffers->boneWeights || buffers->boneIds)
+			return false;
+
+		if (buffers->vertexCount > 65536)
+			return false;
+
+		// rlmDrawModel puts the mesh transform on after the model matrix, which can't be baked into model space vertices
+		if (!rlmIsPQSIdentity(&group->meshes[i].transform))
+		{
+			TraceLog(LOG_WARNING, "rlModels : static batching skipped a group with mesh transforms, they would draw in a different place");
+			return false;
+		}
+	}
+
+	rlmUnbatchModelGroup(group);
+
+	// split where the vertices would go past what 16 bit indices can reach
+	rlmMeshBatch* batches = (rlmMeshBatch*)MemAlloc(group->meshCount * sizeof(rlmMeshBatch));
+	int batchCount = 0;
+
+	int first = 0;
+	while (first < group->meshCount)
+	{
+		int count = 0;
+		int vertexCount = 0;
+		while (first + count < group->meshCount && vertexCount + group->meshes[first + count].meshBuffers->vertexCount <= 65536)
+		{
+			vertexCount += group->meshes[first + count].meshBuffers->vertexCount;
+			count++;
+		}
+
+		if (!rlmBuildMeshBatch(group, first, count, &batches[batchCount]))
+		{
+			for (int i = 0; i <= batchCount; i++)
+				rlmUnloadMeshBatch(&batches[i]);
+			MemFree(batches);
+			return false;
+		}
+
+		batchCount++;
+		first += count;
+	}
+
+	group->batches = batches;
+	group->batchCount = batchCount;
+	group->ownsBatches = true;
+
+	TraceLog(LOG_INFO, "rlModels : batched %d meshes into %d draws", group->meshCount, batchCount);
+	return true;
+}
+
+int rlmBatchModel(rlmModel* model)
+{
+	if (!model)
+		return 0;
+
+	int batched = 0;
+	for (int group = 0; group < model->groupCount; group++)
+	{
+		if (rlmBatchModelGroup(model->groups + group))
+			batched++;
+	}
+
+	return batched;
+}
+
+// draws the runs of meshes that are enabled and on screen, each run is one draw
+static void rlmDrawMeshBatch(const rlmModelGroup* group, rlmMeshBatch* batch, Shader* shader, const rlmFrustum* frustum, Matrix matModel)
+{
+	rlmBindMeshAttributes(&batch->gpuMesh, shader);
+
+	int runStart = -1;
+	int runCount = 0;
+
+	for (int m = 0; m <= batch->meshCount; m++)
+	{
+		bool draw = false;
+		if (m < batch->meshCount)
+		{
+			int meshIndex = batch->firstMesh + m;
+			draw = group->meshDisableFlags == NULL || !group->meshDisableFlags[meshIndex];
+
+			if (draw && frustum && rlmIsBoxValid(&batch->bounds[m]))
+			{
+				draw = rlmIsBoxInFrustum(frustum, rlmTransformBox(batch->bounds[m], matModel));
+				if (draw)
+					CullingStats.meshesVisible++;
+				else
+					CullingStats.meshesCulled++;
+			}
+		}
+
+		if (draw)
+		{
+			if (runStart < 0)
+				runStart = batch->indexStarts[m];
+			runCount += batch->indexCounts[m];
+		}
+		else if (runStart >= 0)
+		{
+			rlmDrawElements(&batch->gpuMesh, runStart, runCount);
+			runStart = -1;
+			runCount = 0;
+		}
+	}
+
+	rlDisableVertexArray();
+	rlDisableVertexBuffer();
+	rlDisableVertexBufferElement();
+}
+
+static void rlmDrawModelLOD(rlmModel model, rlmPQSTransorm transform, int* lodLevels, bool lodHistory, bool allowCulling)
+{
+	// per call, the camera and the model transform
+	// NOTE: At this point the modelview matrix just contains the view matrix (camera)
+	// That's because BeginMode3D() sets it and there is no model-drawing function
+	// that modifies it, all use rlPushMatrix() and rlPopMatrix()
+	Matrix matView = rlGetMatrixModelview();
+	Matrix matProjection = rlGetMatrixProjection();
+
+	Matrix transformMatrix = rlmPQSToMatrix(&transform);
+	Matrix modelMatrix = MatrixMultiply(rlmPQSToMatrix(&model.orientationTransform), transformMatrix);
+
+	// add in the rlgl matrix stack
+	Matrix matModel = MatrixMultiply(modelMatrix, rlGetMatrixTransform());
+	Matrix matModelViewProjection = MatrixMultiply(MatrixMultiply(matModel, matView), matProjection);
+
+	// cull the whole model first, then each mesh before anything gets bound for it
+	bool cull = allowCulling && UseFrustumCulling;
+	rlmFrustum frustum = { 0 };
+	if (cull)
+	{
+		frustum = rlmGetFrustumFromMatrix(MatrixMultiply(matView, matProjection));
+
+		BoundingBox modelBox;
+		if (rlmGetModelCullBox(&model, matModel, &modelBox) && !rlmIsBoxInFrustum(&frustum, modelBox))
+		{
+			CullingStats.modelsCulled++;
+			return;
+		}
+		CullingStats.modelsVisible++;
+	}
+
+	bool normalMatrixReady = false;
+	Matrix matNormal = { 0 };
+
+	int boneCount = MAX_BONE_NUM;
+	if (model.skeleton)
+		boneCount = model.skeleton->boneCount;
+
+	unsigned int boundVaoId = 0;
+
+	rlmStateBeginDraw();
+
+	int meshStart = 0;
+	for (int group = 0; group < model.groupCount; group++)
+	{
+		rlmModelGroup* groupPtr = model.groups + group;
+		Shader* shader = &groupPtr->material.shader;
+
+		int* groupLevels = lodLevels ? lodLevels + meshStart : NULL;
+		meshStart += groupPtr->meshCount;
+
+		// a group with nothing on screen never binds its material
+		if (cull && groupPtr->batchCount == 0)
+		{
+			bool anyVisible = false;
+			int enabledCount = 0;
+			for (int i = 0; i < groupPtr->meshCount && !anyVisible; i++)
+			{
+				if (groupPtr->meshDisableFlags == NULL || !groupPtr->meshDisableFlags[i])
+				{
+					anyVisible = rlmIsMeshVisible(&frustum, &groupPtr->meshes[i], matModel);
+					enabledCount++;
+				}
+			}
+
+			// disabled meshes would not have been drawn anyway
+			if (!anyVisible)
+			{
+				CullingStats.meshesCulled += enabledCount;
+				continue;
+			}
+		}
+
+		// per group, the program changes here so the model level uniforms go up once for it
+		rlmApplyMaterialDefCached(&groupPtr->material);
+
+		if (shader->locs[SHADER_LOC_MATRIX_PROJECTION] != -1)
+			rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_PROJECTION], matProjection);
+
+		// Model transformation matrix is sent to shader uniform location: SHADER_LOC_MATRIX_MODEL
+		if (shader->locs[SHADER_LOC_MATRIX_MODEL] != -1)
+			rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_MODEL], matModel);
+
+		// Upload model normal matrix (if locations available)
+		if (shader->locs[SHADER_LOC_MATRIX_NORMAL] != -1)
+		{
+			if (!normalMatrixReady)
+			{
+				matNormal = MatrixTranspose(MatrixInvert(matModel));
+				normalMatrixReady = true;
+			}
+			rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_NORMAL], matNormal);
+		}
+
+		// if the shader wants bones, set identity matricies, so it can still draw, the state cache only sends them once per program
+		if (rlmShaderTakesBones(shader))
+		{
+			CheckGlobalBoneMatricies();
+			rlmSetShaderBones(shader, DefaultBoneMatricies, boneCount);
+		}
+
+		// batched groups only hold meshes without a transform, so they draw with the model matrices
+		if (groupPtr->batchCount > 0)
+		{
+			if (shader->locs[SHADER_LOC_MATRIX_VIEW] != -1)
+				rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_VIEW], matView);
+
+			rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_MVP], matModelViewProjection);
+
+			for (int batch = 0; batch < groupPtr->batchCount; batch++)
+				rlmDrawMeshBatch(groupPtr, &groupPtr->batches[batch], shader, cull ? &frustum : NULL, matModel);
+
+			boundVaoId = 0;
+			continue;
+		}
+
+		// per mesh, only meshes with their own transform need a different view and mvp
+		bool meshViewSet = false;
+		bool meshViewIdentity = false;
+
+		for (int i = 0; i < groupPtr->meshCount; i++)
+		{
+			if (groupPtr->meshDisableFlags != NULL && groupPtr->meshDisableFlags[i])
+				continue;
+
+			if (cull)
+			{
+				if (!rlmIsMeshVisible(&frustum, &groupPtr->meshes[i], matModel))
+				{
+					CullingStats.meshesCulled++;
+					continue;
+				}
+				CullingStats.meshesVisible++;
+			}
+
+			bool identity = rlmIsPQSIdentity(&groupPtr->meshes[i].transform);
+			if (!meshViewSet || !identity || !meshViewIdentity)
+			{
+				Matrix matMeshView = matView;
+				Matrix matMeshModelViewProjection = matModelViewProjection;
+				if (!identity)
+				{
+					matMeshView = MatrixMultiply(rlmPQSToMatrix(&groupPtr->meshes[i].transform), matView);
+					matMeshModelViewProjection = MatrixMultiply(MatrixMultiply(matModel, matMeshView), matProjection);
+				}
+
+				if (shader->locs[SHADER_LOC_MATRIX_VIEW] != -1)
+					rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_VIEW], matMeshView);
+
+				// Send combined model-view-projection matrix to shader
+				rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_MVP], matMeshModelViewProjection);
+
+				meshViewSet = true;
+				meshViewIdentity = identity;
+			}
+
+			rlmGPUMesh* gpuMesh = &groupPtr->meshes[i].gpuMesh;
+			if (groupPtr->meshes[i].lodCount > 0)
+			{
+				Matrix matMesh = identity ? matModel : MatrixMultiply(matModel, rlmPQSToMatrix(&groupPtr->meshes[i].transform));
+				gpuMesh = rlmGetLODGPUMesh(groupPtr, i, groupLevels, lodHistory, matMesh, matView, matProjection);
+			}
+
+			rlmDrawGPUMeshShared(gpuMesh, shader, &boundVaoId);
+		}
+	}
+
+	if (boundVaoId != 0)
+		rlDisableVertexArray();
+
+	// groups that share a material only pay for binding it once
+	rlmStateRestore();
+	rlSetTexture(0);
+}
+
+void rlmDrawModel(rlmModel model, rlmPQSTransorm transform)
+{
+	rlmDrawModelLOD(model, transform, NULL, true, true);
+}
+
+void rlmDrawModelEx(rlmModel model, rlmPQSTransorm transform, int* meshLODLevels)
+{
+	rlmDrawModelLOD(model, transform, meshLODLevels, meshLODLevels != NULL, true);
+}
+
+void rlmDrawModelUnculled(rlmModel model, rlmPQSTransorm transform, int* meshLODLevels)
+{
+	rlmDrawModelLOD(model, transform, meshLODLevels, meshLODLevels != NULL, false);
+}
+
+int rlmGetModelMeshCount(rlmModel model)
+{
+	int count = 0;
+	for (int group = 0; group < model.groupCount; group++)
+		count += model.groups[group].meshCount;
+
+	return count;
+}
+
+static void rlmDrawModelWithPoseLOD(rlmModel model, rlmPQSTransorm transform, rlmModelAnimationPose* pose, Shader* shader, bool lodHistory)
+{
+	Matrix transformMatrix = rlmPQSToMatrix(&transform);
+	Matrix modelMatrix = MatrixMultiply(rlmPQSToMatrix(&model.orientationTransform), transformMatrix);
+
+	// add in the rlgl matrix stack
+	Matrix matModel = MatrixMultiply(modelMatrix, rlGetMatrixTransform());
+
+	// these don't change per group
+	Matrix matView = rlGetMatrixModelview();
+	Matrix matProjection = rlGetMatrixProjection();
+	Matrix matModelViewProjection = MatrixMultiply(MatrixMultiply(matModel, matView), matProjection);
+
+	bool normalMatrixReady = false;
+	Matrix matNormal = { 0 };
+
+	unsigned int boundVaoId = 0;
+
+	rlmStateBeginDraw();
+	rlmBeginBonePaletteDraw();
+
+	// the caller bound the override shader, so make sure it is unbound at the end
+	if (shader)
+		StateCache.program = RLM_STATE_UNKNOWN_PROGRAM;
+
+	for (int group = 0; group < model.groupCount; group++)
+	{
+		rlmModelGroup* groupPtr = model.groups + group;
+
+		Shader* shaderToUse = &groupPtr->material.shader;
+		if (shader)
+		{
+			shaderToUse = shader; // shader override, assume it is already setup
+		}
+		else
+		{
+			rlmApplyMaterialDefCached(&groupPtr->material);
+		}
+
+		// if the shader wants bones, set some bone matricies, palette shaders share one upload for all the groups
+		if (rlmShaderTakesBones(shaderToUse))
+		{
+			// if we have a real pose, use it
+			if (model.skeleton && pose)
+			{
+				rlmSetShaderBones(shaderToUse, pose->boneMatricies, model.skeleton->boneCount);
+			}
+			else // otherwise just fill out a list of default bones.
+			{
+				int count = MAX_BONE_NUM;
+				if (model.skeleton)
+					count = model.skeleton->boneCount;
+
+				CheckGlobalBoneMatricies();
+				rlmSetShaderBones(shaderToUse, DefaultBoneMatricies, count);
+			}
+		}
+
+		// Upload view and projection matrices (if locations available)
+		if (shaderToUse->locs[SHADER_LOC_MATRIX_VIEW] != -1)
+			rlSetUniformMatrix(shaderToUse->locs[SHADER_LOC_MATRIX_VIEW], matView);
+
+		if (shaderToUse->locs[SHADER_LOC_MATRIX_PROJECTION] != -1)
+			rlSetUniformMatrix(shaderToUse->locs[SHADER_LOC_MATRIX_PROJECTION], matProjection);
+
+		// Model transformation matrix is sent to shader uniform location: SHADER_LOC_MATRIX_MODEL
+		if (shaderToUse->locs[SHADER_LOC_MATRIX_MODEL] != -1)
+			rlSetUniformMatrix(shaderToUse->locs[SHADER_LOC_MATRIX_MODEL], matModel);
+
+		// Upload model normal matrix (if locations available)
+		if (shaderToUse->locs[SHADER_LOC_MATRIX_NORMAL] != -1)
+		{
+			if (!normalMatrixReady)
+			{
+				matNormal = MatrixTranspose(MatrixInvert(matModel));
+				normalMatrixReady = true;
+			}
+			rlSetUniformMatrix(shaderToUse->locs[SHADER_LOC_MATRIX_NORMAL], matNormal);
+		}
+
+		// Send combined model-view-projection matrix to shader
+		rlSetUniformMatrix(shaderToUse->locs[SHADER_LOC_MATRIX_MVP], matModelViewProjection);
+
+		// draw the meshes
+		for (int i = 0; i < groupPtr->meshCount; i++)
+		{
+			if (groupPtr->meshDisableFlags == NULL || !groupPtr->meshDisableFlags[i])
+				rlmDrawGPUMeshShared(rlmGetLODGPUMesh(groupPtr, i, NULL, lodHistory, matModel, matView, matProjection), &groupPtr->material.shader, &boundVaoId);
+		}
+	}
+
+	if (boundVaoId != 0)
+		rlDisableVertexArray();
+
+	rlmStateRestore();
+	rlSetTexture(0);
+}
+
+void rlmDrawModelWithPose(rlmModel model, rlmPQSTransorm transform, rlmModelAnimationPose* pose)
+{
+	rlmDrawModelWithPoseLOD(model, transform, pose, NULL, true);
+}
+
+void rlmDrawModelWithPoseEx(rlmModel model, rlmPQSTransorm transform, rlmModelAnimationPose* pose, Shader* shader)
+{
+	rlmDrawModelWithPoseLOD(model, transform, pose, shader, true);
+}
+
+#if defined(RLM_SUPPORT_INSTANCING)
+
+// per instance vertex data, the matrix is column major like GLSL wants it
+typedef struct rlmInstanceData
+{
+	float16 transform;
+	Color tint;
+}rlmInstanceData;
+
+static unsigned int InstanceBufferId = 0;
+static int InstanceBufferCapacity = 0;
+static rlmInstanceData* InstanceStaging = NULL;
+static BoundingBox* InstanceCullBoxes = NULL;
+static bool* InstanceCullVisible = NULL;
+
+static Shader InstancingShader = { 0 };
+static bool InstancingShaderLoaded = false;
+
+// used for materials whose shaders don't take instance attributes, handles the base texture and diffuse color
+static const char* InstancingVertexShader =
+#if defined(GRAPHICS_API_OPENGL_ES3)
+"#version 300 es\n"
+#else
+"#version 330\n"
+#endif
+"in vec3 vertexPosition;\n"
+"in vec2 vertexTexCoord;\n"
+"in vec3 vertexNormal;\n"
+"in vec4 vertexColor;\n"
+"in mat4 instanceTransform;\n"
+"in vec4 instanceTint;\n"
+"uniform mat4 mvp;\n"
+"out vec2 fragTexCoord;\n"
+"out vec4 fragColor;\n"
+"out vec3 fragNormal;\n"
+"void main()\n"
+"{\n"
+"    fragTexCoord = vertexTexCoord;\n"
+"    fragColor = vertexColor*instanceTint;\n"
+"    fragNormal = normalize(mat3(instanceTransform)*vertexNormal);\n"
+"    gl_Position = mvp*instanceTransform*vec4(vertexPosition, 1.0);\n"
+"}\n";
+
+static const char* InstancingFragmentShader =
+#if defined(GRAPHICS_API_OPENGL_ES3)
+"#version 300 es\n"
+"precision mediump float;\n"
+#else
+"#version 330\n"
+#endif
+"in vec2 fragTexCoord;\n"
+"in vec4 fragColor;\n"
+"out vec4 finalColor;\n"
+"uniform sampler2D texture0;\n"
+"uniform vec4 colDiffuse;\n"
+"void main()\n"
+"{\n"
+"    finalColor = texture(texture0, fragTexCoord)*colDiffuse*fragColor;\n"
+"}\n";
+
+static Shader* rlmGetInstancingShader()
+{
+	if (!InstancingShaderLoaded)
+	{
+		InstancingShader = LoadShaderFromMemory(InstancingVertexShader, InstancingFragmentShader);
+		InstancingShaderLoaded = true;
+	}
+
+	return &InstancingShader;
+}
+
+// returns how many instances made it into the buffer, the ones outside the frustum are left out
+// posed instances can move outside of their bind pose bounds, so they are all kept
+static int rlmUploadInstanceData(const rlmModel* model, const rlmPQSTransorm* transforms, const Color* tints, int count, bool allowCulling)
+{
+	if (count > InstanceBufferCapacity)
+	{
+		int capacity = InstanceBufferCapacity > 0 ? InstanceBufferCapacity : 64;
+		while (capacity < count)
+			capacity *= 2;
+
+		if (InstanceBufferId != 0)
+			rlUnloadVertexBuffer(InstanceBufferId);
+
+		InstanceBufferId = rlLoadVertexBuffer(NULL, capacity * (int)sizeof(rlmInstanceData), true);
+		InstanceStaging = (rlmInstanceData*)MemRealloc(InstanceStaging, capacity * sizeof(rlmInstanceData));
+		InstanceCullBoxes = (BoundingBox*)MemRealloc(InstanceCullBoxes, capacity * sizeof(BoundingBox));
+		InstanceCullVisible = (bool*)MemRealloc(InstanceCullVisible, capacity * sizeof(bool));
+		InstanceBufferCapacity = capacity;
+	}
+
+	if (InstanceBufferId == 0 || !InstanceStaging || !InstanceCullBoxes || !InstanceCullVisible)
+		return 0;
+
+	// the orientation and the rlgl matrix stack are the same for every instance
+	Matrix orientation = rlmPQSToMatrix(&model->orientationTransform);
+	Matrix stack = rlGetMatrixTransform();
+
+	// with mesh transforms the box is made again for every instance
+	BoundingBox modelBox;
+	bool cull = allowCulling && UseFrustumCulling && rlmGetModelCullBox(model, MatrixIdentity(), &modelBox);
+	bool boxPerInstance = cull && rlmModelHasMeshTransforms(model);
+
+	for (int i = 0; i < count; i++)
+	{
+		Matrix matModel = MatrixMultiply(MatrixMultiply(orientation, rlmPQSToMatrix(&transforms[i])), stack);
+		InstanceStaging[i].transform = MatrixToFloatV(matModel);
+		InstanceStaging[i].tint = tints ? tints[i] : WHITE;
+
+		if (boxPerInstance)
+			InstanceCullBoxes[i] = rlmGetModelBoundsWithMatrix(model, matModel);
+		else if (cull)
+			InstanceCullBoxes[i] = rlmTransformBox(modelBox, matModel);
+	}
+
+	int visibleCount = count;
+	if (cull)
+	{
+		rlmFrustum frustum = rlmGetCurrentFrustum();
+		visibleCount = rlmCullBoxes(&frustum, InstanceCullBoxes, count, InstanceCullVisible);
+
+		// pack the visible ones to the front, in order
+		int packed = 0;
+		for (int i = 0; i < count; i++)
+		{
+			if (InstanceCullVisible[i])
+				InstanceStaging[packed++] = InstanceStaging[i];
+		}
+
+		CullingStats.modelsVisible += visibleCount;
+		CullingStats.modelsCulled += count - visibleCount;
+	}
+
+	if (visibleCount > 0)
+		rlUpdateVertexBuffer(InstanceBufferId, InstanceStaging, visibleCount * (int)sizeof(rlmInstanceData), 0);
+
+	return visibleCount;
+}
+
+static void rlmSetInstanceAttributes(int transformLoc, int tintLoc, bool enable)
+{
+	rlEnableVertexBuffer(InstanceBufferId);
+
+	for (int column = 0; column < 4; column++)
+	{
+		if (enable)
+		{
+			rlSetVertexAttribute(transformLoc + column, 4, RL_FLOAT, false, sizeof(rlmInstanceData), column * 4 * sizeof(float));
+			rlSetVertexAttributeDivisor(transformLoc + column, 1);
+			rlEnableVertexAttribute(transformLoc + column);
+		}
+		else
+		{
+			// the mesh VAO is shared with regular draws, so leave it how we found it
+			rlSetVertexAttributeDivisor(transformLoc + column, 0);
+			rlDisableVertexAttribute(transformLoc + column);
+		}
+	}
+
+	if (tintLoc >= 0)
+	{
+		if (enable)
+		{
+			rlSetVertexAttribute(tintLoc, 4, RL_UNSIGNED_BYTE, true, sizeof(rlmInstanceData), offsetof(rlmInstanceData, tint));
+			rlSetVertexAttributeDivisor(tintLoc, 1);
+			rlEnableVertexAttribute(tintLoc);
+		}
+		else
+		{
+			rlSetVertexAttributeDivisor(tintLoc, 0);
+			rlDisableVertexAttribute(tintLoc);
+		}
+	}
+}
+
+static void rlmDrawMeshInstanced(rlmGPUMesh* mesh, Shader* shader, int transformLoc, int tintLoc, int count)
+{
+	rlmBindMeshAttributes(mesh, shader);
+	rlmSetInstanceAttributes(transformLoc, tintLoc, true);
+
+	if (mesh->isIndexed)
+	{
+#if defined(RLM_SUPPORT_MESH_ARENA)
+		if (mesh->arenaSlot > 0)
+		{
+			int firstIndex = 0;
+			int baseVertex = 0;
+			rlmGetArenaDrawOffsets(mesh, &firstIndex, &baseVertex);
+
+			int indexSize = mesh->indices32 ? sizeof(unsigned int) : sizeof(unsigned short);
+			glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh->elementCount, mesh->indices32 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT, (const void*)((size_t)firstIndex * indexSize), count, baseVertex);
+		}
+		else
+#endif
+#if defined(RLM_SUPPORT_32BIT_INDICES)
+		if (mesh->indices32)
+			glDrawElementsInstanced(GL_TRIANGLES, mesh->elementCount, GL_UNSIGNED_INT, NULL, count);
+		else
+#endif
+			rlDrawVertexArrayElementsInstanced(0, mesh->elementCount, 0, count);
+	}
+	else
+		rlDrawVertexArrayInstanced(0, mesh->elementCount, count);
+
+	rlmSetInstanceAttributes(transformLoc, tintLoc, false);
+
+	rlDisableVertexArray();
+	rlDisableVertexBuffer();
+	rlDisableVertexBufferElement();
+}
+
+#endif
+
+void rlmDrawModelInstanced(rlmModel model, const rlmPQSTransorm* transforms, int count)
+{
+	rlmDrawModelInstancedEx(model, transforms, NULL, count);
+}
+
+#if defined(RLM_SUPPORT_INSTANCING)
+// poses can only be given on GL 4.3, where every instance reads its own palette from a storage buffer
+static void rlmDrawInstances(rlmModel model, const rlmPQSTransorm* transforms, const Color* tints, rlmModelAnimationPose* poses, int count, bool allowCulling)
+{
+	count = rlmUploadInstanceData(&model, transforms, tints, count, allowCulling && poses == NULL);
+	if (count <= 0)
+		return;
+
+	Matrix matView = rlGetMatrixModelview();
+	Matrix matProjection = rlGetMatrixProjection();
+
+	rlmStateBeginDraw();
+	rlmBeginBonePaletteDraw();
+
+#if defined(GRAPHICS_API_OPENGL_43)
+	// all the palettes go in one range, instance after instance
+	int paletteOffset = -1;
+	rlmBonePaletteFormat paletteFormat = RLM_BONE_PALETTE_MATRIX;
+	if (poses && model.skeleton && model.skeleton->boneCount > 0 && model.groupCount > 0)
+	{
+		const Matrix** palettes = (const Matrix**)MemAlloc(count * sizeof(Matrix*));
+		for (int i = 0; i < count; i++)
+			palettes[i] = poses[i].boneMatricies;
+
+		paletteFormat = rlmGetBoneProgram(model.groups[0].material.shader.id)->format;
+		paletteOffset = rlmWriteBonePalettes(palettes, count, model.skeleton->boneCount, model.skeleton->boneCount, paletteFormat);
+		MemFree(palettes);
+	}
+#endif
+
+	for (int group = 0; group < model.groupCount; group++)
+	{
+		rlmModelGroup* groupPtr = model.groups + group;
+
+		// use the material's shader if it takes instance transforms, otherwise the built in one with just the base channel
+		rlmMaterialDef material = groupPtr->material;
+		const rlmInstanceProgram* locations = rlmGetInstanceProgram(material.shader.id);
+		if (locations->transformLoc < 0)
+		{
+			material.shader = *rlmGetInstancingShader();
+			material.materialChannels = 0;
+			material.materialValues = 0;
+
+			locations = rlmGetInstanceProgram(material.shader.id);
+			if (locations->transformLoc < 0)
+				continue;
+		}
+		int transformLoc = locations->transformLoc;
+		int tintLoc = locations->tintLoc;
+
+		Shader* shader = &material.shader;
+		rlmApplyMaterialDefCached(&material);
+
+		if (rlmShaderTakesBones(shader))
+		{
+			int boneCount = MAX_BONE_NUM;
+			if (model.skeleton)
+				boneCount = model.skeleton->boneCount;
+
+			bool posed = false;
+#if defined(GRAPHICS_API_OPENGL_43)
+			// the shader finds its instance's bones at gl_InstanceID * bonePaletteStride
+			const rlmBoneProgram* bones = rlmGetBoneProgram(shader->id);
+			if (paletteOffset >= 0 && bones->target == GL_SHADER_STORAGE_BUFFER && bones->format == paletteFormat)
+			{
+				rlmBindBonePaletteRange(bones, paletteOffset, count * boneCount, boneCount);
+				posed = true;
+			}
+#endif
+			if (!posed)
+			{
+				CheckGlobalBoneMatricies();
+				rlmSetShaderBones(shader, DefaultBoneMatricies, boneCount);
+			}
+		}
+
+		if (shader->locs[SHADER_LOC_MATRIX_PROJECTION] != -1)
+			rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_PROJECTION], matProjection);
+
+		// the model matrix is per instance
+		if (shader->locs[SHADER_LOC_MATRIX_MODEL] != -1)
+			rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_MODEL], MatrixIdentity());
+
+		if (shader->locs[SHADER_LOC_MATRIX_NORMAL] != -1)
+			rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_NORMAL], MatrixIdentity());
+
+		for (int i = 0; i < groupPtr->meshCount; i++)
+		{
+			if (groupPtr->meshDisableFlags != NULL && groupPtr->meshDisableFlags[i])
+				continue;
+
+			// same as rlmDrawModel, the mesh transform goes in with the view
+			Matrix matMeshView = MatrixMultiply(rlmPQSToMatrix(&groupPtr->meshes[i].transform), matView);
+
+			if (shader->locs[SHADER_LOC_MATRIX_VIEW] != -1)
+				rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_VIEW], matMeshView);
+
+			rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_MVP], MatrixMultiply(matMeshView, matProjection));
+
+			rlmDrawMeshInstanced(&groupPtr->meshes[i].gpuMesh, shader, transformLoc, tintLoc, count);
+		}
+	}
+
+	rlmStateRestore();
+	rlSetTexture(0);
+}
+#endif
+
+// culling can be turned off per call, for instances that were already culled some other way
+static void rlmDrawModelInstancedCulled(rlmModel model, const rlmPQSTransorm* transforms, const Color* tints, int count, bool allowCulling)
+{
+	if (!transforms || count <= 0)
+		return;
+
+#if defined(RLM_SUPPORT_INSTANCING)
+	rlmDrawInstances(model, transforms, tints, NULL, count, allowCulling);
+#else
+	// no instancing on this GL version, so each instance is drawn on its own with its tint multiplied into the base channel color
+	// the instances share the model's groups, so the LODs are picked without hysteresis
+	Color* baseColors = NULL;
+	if (tints && model.groupCount > 0)
+	{
+		baseColors = (Color*)MemAlloc(model.groupCount * sizeof(Color));
+		for (int group = 0; group < model.groupCount; group++)
+			baseColors[group] = model.groups[group].material.baseChannel.color;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		if (baseColors)
+		{
+			for (int group = 0; group < model.groupCount; group++)
+			{
+				Color base = baseColors[group];
+				model.groups[group].material.baseChannel.color = (Color){
+					(unsigned char)(base.r * tints[i].r / 255),
+					(unsigned char)(base.g * tints[i].g / 255),
+					(unsigned char)(base.b * tints[i].b / 255),
+					(unsigned char)(base.a * tints[i].a / 255) };
+			}
+		}
+
+		rlmDrawModelLOD(model, transforms[i], NULL, false, allowCulling);
+	}
+
+	if (baseColors)
+	{
+		for (int group = 0; group < model.groupCount; group++)
+			model.groups[group].material.baseChannel.color = baseColors[group];
+		MemFree(baseColors);
+	}
+#endif
+}
+
+void rlmDrawModelInstancedEx(rlmModel model, const rlmPQSTransorm* transforms, const Color* tints, int count)
+{
+	rlmDrawModelInstancedCulled(model, transforms, tints, count, true);
+}
+
+void rlmDrawModelInstancedUnculled(rlmModel model, const rlmPQSTransorm* transforms, const Color* tints, int count)
+{
+	rlmDrawModelInstancedCulled(model, transforms, tints, count, false);
+}
+
+void rlmDrawModelInstancedWithPoses(rlmModel model, const rlmPQSTransorm* transforms, rlmModelAnimationPose* poses, int count)
+{
+	if (!transforms || !poses || count <= 0)
+		return;
+
+#if defined(RLM_SUPPORT_INSTANCING) && defined(GRAPHICS_API_OPENGL_43)
+	rlmDrawInstances(model, transforms, NULL, poses, count, true);
+#else
+	// uniform blocks are too small for a crowd, so each one is drawn on its own
+	for (int i = 0; i < count; i++)
+		rlmDrawModelWithPoseLOD(model, transforms[i], &poses[i], NULL, false);
+#endif
+}
+
+rlmBoneUploadStats rlmGetBoneUploadStats()
+{
+	return BoneUploadStats;
+}
+
+void rlmResetBoneUploadStats()
+{
+	BoneUploadStats = (rlmBoneUploadStats){ 0 };
+}
+
+void rlmUnloadBonePaletteResources()
+{
+#if defined(RLM_SUPPORT_BONE_PALETTE)
+	if (BonePaletteBuffer != 0)
+		glDeleteBuffers(1, &BonePaletteBuffer);
+
+	BonePaletteBuffer = 0;
+	BonePaletteCapacity = 0;
+	BonePaletteOffset = 0;
+
+	memset(BonePaletteUploads, 0, sizeof(BonePaletteUploads));
+#endif
+
+	MemFree(BoneStaging);
+	BoneStaging = NULL;
+	BoneStagingCapacity = 0;
+}
+
+void rlmUnloadInstancingResources()
+{
+#if defined(RLM_SUPPORT_INSTANCING)
+	if (InstanceBufferId != 0)
+		rlUnloadVertexBuffer(InstanceBufferId);
+
+	InstanceBufferId = 0;
+	InstanceBufferCapacity = 0;
+
+	MemFree(InstanceStaging);
+	InstanceStaging = NULL;
+
+	MemFree(InstanceCullBoxes);
+	InstanceCullBoxes = NULL;
+
+	MemFree(InstanceCullVisible);
+	InstanceCullVisible = NULL;
+
+	if (InstancingShaderLoaded)
+	{
+		rlmStateForgetProgram(InstancingShader.id);
+		UnloadShader(InstancingShader);
+	}
+
+	InstancingShader = (Shader){ 0 };
+	InstancingShaderLoaded = false;
+#endif
+}
+
+// render queue
+typedef struct rlmQueuePacket
+{
+	unsigned long long key;
+	rlmModelGroup* group;
+	int meshIndex;
+	rlmGPUMesh* gpuMesh;	// the base mesh or the LOD picked when it was submitted
+	Matrix matModel;
+	int poseOffset;		// first bone in the queue's copy of the pose, -1 for the default bones
+	int boneCount;
+	bool meshTransform;		// unposed draws apply the mesh transform like rlmDrawModel does
+	int multiDrawEntry;		// shared buffer entry when it can be multi drawn, -1 otherwise
+}rlmQueuePacket;
+
+typedef struct rlmQueueSortItem
+{
+	unsigned long long key;
+	int packet;
+}rlmQueueSortItem;
+
+static rlmQueuePacket* QueuePackets = NULL;
+static rlmQueueSortItem* QueueSortItems = NULL;
+static int QueuePacketCount = 0;
+static int QueuePacketCapacity = 0;
+static bool QueueActive = false;
+
+// poses are copied when submitted, so the caller can reuse one pose for every instance
+static Matrix* QueuePoses = NULL;
+static int QueuePoseCount = 0;
+static int QueuePoseCapacity = 0;
+
+void rlmBeginQueue()
+{
+	if (QueueActive)
+		TraceLog(LOG_WARNING, "rlModels : rlmBeginQueue called with %d packets still queued, they are dropped", QueuePacketCount);
+
+	QueuePacketCount = 0;
+	QueuePoseCount = 0;
+	QueueActive = true;
+}
+
+static rlmQueuePacket* rlmAddQueuePacket()
+{
+	if (QueuePacketCount >= QueuePacketCapacity)
+	{
+		int capacity = QueuePacketCapacity > 0 ? QueuePacketCapacity * 2 : 256;
+		QueuePackets = (rlmQueuePacket*)MemRealloc(QueuePackets, capacity * sizeof(rlmQueuePacket));
+		QueueSortItems = (rlmQueueSortItem*)MemRealloc(QueueSortItems, capacity * sizeof(rlmQueueSortItem));
+		QueuePacketCapacity = capacity;
+	}
+
+	return &QueuePackets[QueuePacketCount++];
+}
+
+// returns the offset of the copy, which stays valid until the next rlmBeginQueue
+static int rlmCopyQueuePose(const Matrix* bones, int boneCount)
+{
+	if (QueuePoseCount + boneCount > QueuePoseCapacity)
+	{
+		int capacity = QueuePoseCapacity > 0 ? QueuePoseCapacity : 1024;
+		while (capacity < QueuePoseCount + boneCount)
+			capacity *= 2;
+
+		QueuePoses = (Matrix*)MemRealloc(QueuePoses, capacity * sizeof(Matrix));
+		QueuePoseCapacity = capacity;
+	}
+
+	int offset = QueuePoseCount;
+	memcpy(QueuePoses + offset, bones, boneCount * sizeof(Matrix));
+	QueuePoseCount += boneCount;
+
+	return offset;
+}
+
+static void rlmSubmitPackets(rlmModel model, rlmPQSTransorm transform, rlmModelAnimationPose* pose, int* lodLevels, bool lodHistory)
+{
+	if (!QueueActive)
+	{
+		TraceLog(LOG_WARNING, "rlModels : rlmSubmit called outside of rlmBeginQueue/rlmFlushQueue");
+		return;
+	}
+
+	Matrix modelMatrix = MatrixMultiply(rlmPQSToMatrix(&model.orientationTransform), rlmPQSToMatrix(&transform));
+	Matrix matModel = MatrixMultiply(modelMatrix, rlGetMatrixTransform());
+
+	// posed meshes can move outside of their bind pose bounds, so only static draws are culled
+	bool cull = UseFrustumCulling && pose == NULL;
+	rlmFrustum frustum = { 0 };
+	if (cull)
+	{
+		frustum = rlmGetCurrentFrustum();
+
+		BoundingBox modelBox;
+		if (rlmGetModelCullBox(&model, matModel, &modelBox) && !rlmIsBoxInFrustum(&frustum, modelBox))
+		{
+			CullingStats.modelsCulled++;
+			return;
+		}
+		CullingStats.modelsVisible++;
+	}
+
+	Matrix matView = rlGetMatrixModelview();
+	Matrix matProjection = rlGetMatrixProjection();
+
+	int poseOffset = -1;
+	if (model.skeleton && pose && pose->boneMatricies)
+		poseOffset = rlmCopyQueuePose(pose->boneMatricies, model.skeleton->boneCount);
+
+	int meshStart = 0;
+	for (int group = 0; group < model.groupCount; group++)
+	{
+		rlmModelGroup* groupPtr = model.groups + group;
+
+		int* groupLevels = lodLevels ? lodLevels + meshStart : NULL;
+		meshStart += groupPtr->meshCount;
+
+		for (int i = 0; i < groupPtr->meshCount; i++)
+		{
+			if (groupPtr->meshDisableFlags != NULL && groupPtr->meshDisableFlags[i])
+				continue;
+
+			if (cull)
+			{
+				if (!rlmIsMeshVisible(&frustum, &groupPtr->meshes[i], matModel))
+				{
+					CullingStats.meshesCulled++;
+					continue;
+				}
+				CullingStats.meshesVisible++;
+			}
+
+			// same transform order as rlmDrawModel and rlmDrawModelWithPoseEx
+			Matrix matMesh = matModel;
+			if (pose == NULL && !rlmIsPQSIdentity(&groupPtr->meshes[i].transform))
+				matMesh = MatrixMultiply(matModel, rlmPQSToMatrix(&groupPtr->meshes[i].transform));
+
+			rlmQueuePacket* packet = rlmAddQueuePacket();
+			packet->key = 0;
+			packet->group = groupPtr;
+			packet->meshIndex = i;
+			packet->gpuMesh = rlmGetLODGPUMesh(groupPtr, i, groupLevels, lodHistory, matMesh, matView, matProjection);
+			packet->matModel = matModel;
+			packet->poseOffset = poseOffset;
+			packet->boneCount = model.skeleton ? model.skeleton->boneCount : MAX_BONE_NUM;
+			packet->meshTransform = pose == NULL;
+			packet->multiDrawEntry = -1;
+		}
+	}
+}
+
+void rlmSubmit(rlmModel model, rlmPQSTransorm transform)
+{
+	rlmSubmitPackets(model, transform, NULL, NULL, true);
+}
+
+void rlmSubmitWithPose(rlmModel model, rlmPQSTransorm transform, rlmModelAnimationPose* pose)
+{
+	rlmSubmitPackets(model, transform, pose, NULL, true);
+}
+
+void rlmSubmitEx(rlmModel model, rlmPQSTransorm transform, rlmModelAnimationPose* pose, int* meshLODLevels)
+{
+	rlmSubmitPackets(model, transform, pose, meshLODLevels, meshLODLevels != NULL);
+}
+
+// multi draw indirect, packed meshes are copied into shared buffers so one draw call covers a material's whole run of packets
+// gl_DrawID needs GL 4.6, so the draw index comes from a per instance attribute offset by each command's base instance
+#if defined(RLM_SUPPORT_MULTIDRAW)
+
+#define RLM_MULTIDRAW_ATTRIBUTES 6
+#define RLM_MULTIDRAW_TRANSFORM_BINDING 0
+#define RLM_MULTIDRAW_INDEX_LOCATION 15	// past every raylib attribute, so the shared vertex array keeps it set up for good
+
+typedef struct rlmMultiDrawEntry
+{
+	const rlmMesh* mesh;		// NULL once released, the slot and its space get reused
+	unsigned int sourceVaoId;	// to spot meshes that were reuploaded since they were packed
+	int firstIndex;
+	int indexCount;
+	int baseVertex;
+	int vertexCount;
+}rlmMultiDrawEntry;
+
+// same layout as DrawElementsIndirectCommand in the GL spec
+typedef struct rlmDrawElementsIndirectCommand
+{
+	unsigned int count;
+	unsigned int instanceCount;
+	unsigned int firstIndex;
+	int baseVertex;
+	unsigned int baseInstance;
+}rlmDrawElementsIndirectCommand;
+
+typedef struct rlmMultiDrawAttribute
+{
+	int location;
+	int size;
+	int type;
+	bool normalized;
+	int stride;
+	unsigned char fill;		// byte value for meshes that don't have the attribute
+}rlmMultiDrawAttribute;
+
+static const rlmMultiDrawAttribute MultiDrawAttributes[RLM_MULTIDRAW_ATTRIBUTES] = {
+	{ RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 3, RL_FLOAT, false, 3 * sizeof(float), 0 },
+	{ RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, 2, RL_FLOAT, false, 2 * sizeof(float), 0 },
+	{ RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, 3, RL_FLOAT, false, 3 * sizeof(float), 0 },
+	{ RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, 4, RL_UNSIGNED_BYTE, true, 4 * sizeof(unsigned char), 255 },
+	{ RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT, 4, RL_FLOAT, false, 4 * sizeof(float), 0 },
+	{ RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2, 2, RL_FLOAT, false, 2 * sizeof(float), 0 },
+};
+
+static bool UseMultiDraw = true;
+
+// shared geometry
+static unsigned int MultiDrawVaoId = 0;
+static unsigned int MultiDrawVertexBuffers[RLM_MULTIDRAW_ATTRIBUTES] = { 0 };
+static unsigned int MultiDrawIndexBuffer = 0;
+static int MultiDrawVertexCount = 0;
+static int MultiDrawVertexCapacity = 0;
+static int MultiDrawIndexCount = 0;
+static int MultiDrawIndexCapacity = 0;
+
+static rlmMultiDrawEntry* MultiDrawEntries = NULL;
+static int MultiDrawEntryCount = 0;
+static int MultiDrawEntryCapacity = 0;
+
+// left behind by released entries, reclaimed by repacking before the buffers grow
+static int MultiDrawFreeEntries = 0;
+static int MultiDrawFreeVertices = 0;
+static int MultiDrawFreeIndices = 0;
+
+// per draw data, refilled for every run
+static unsigned int MultiDrawCommandBuffer = 0;
+static unsigned int MultiDrawTransformBuffer = 0;
+static unsigned int MultiDrawIndexAttributeBuffer = 0;	// 0, 1, 2... as floats
+static int MultiDrawCapacity = 0;
+static rlmDrawElementsIndirectCommand* MultiDrawCommands = NULL;
+static float16* MultiDrawTransforms = NULL;
+
+// the draw index attribute of the last program asked about, reset every flush since program ids get reused
+static unsigned int MultiDrawLastProgram = 0;
+static int MultiDrawLastLocation = -1;
+
+static Shader MultiDrawShader = { 0 };
+static bool MultiDrawShaderLoaded = false;
+
+static const char* MultiDrawVertexShader =
+"#version 430\n"
+"in vec3 vertexPosition;\n"
+"in vec2 vertexTexCoord;\n"
+"in vec3 vertexNormal;\n"
+"in vec4 vertexColor;\n"
+"layout(location = 15) in float drawIndex;\n"
+"layout(std430, binding = 0) readonly buffer rlmDrawTransforms\n"
+"{\n"
+"    mat4 drawTransforms[];\n"
+"};\n"
+"uniform mat4 mvp;\n"
+"out vec2 fragTexCoord;\n"
+"out vec4 fragColor;\n"
+"out vec3 fragNormal;\n"
+"void main()\n"
+"{\n"
+"    mat4 drawTransform = drawTransforms[int(drawIndex)];\n"
+"    fragTexCoord = vertexTexCoord;\n"
+"    fragColor = vertexColor;\n"
+"    fragNormal = normalize(mat3(drawTransform)*vertexNormal);\n"
+"    gl_Position = mvp*drawTransform*vec4(vertexPosition, 1.0);\n"
+"}\n";
+
+static const char* MultiDrawFragmentShader =
+"#version 430\n"
+"in vec2 fragTexCoord;\n"
+"in vec4 fragColor;\n"
+"out vec4 finalColor;\n"
+"uniform sampler2D texture0;\n"
+"uniform vec4 colDiffuse;\n"
+"void main()\n"
+"{\n"
+"    finalColor = texture(texture0, fragTexCoord)*colDiffuse*fragColor;\n"
+"}\n";
+
+static int rlmGetBufferSize(unsigned int bufferId)
+{
+	GLint size = 0;
+	glBindBuffer(GL_COPY_READ_BUFFER, bufferId);
+	glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	return (int)size;
+}
+
+// a bigger buffer with the used part of the old one copied over, the old one is deleted
+static unsigned int rlmGrowBuffer(unsigned int bufferId, int usedSize, int newSize)
+{
+	unsigned int newId = 0;
+	glGenBuffers(1, &newId);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newId);
+	glBufferData(GL_COPY_WRITE_BUFFER, newSize, NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	if (bufferId != 0)
+	{
+		if (usedSize > 0)
+			rlmCopyBuffer(bufferId, newId, 0, 0, usedSize);
+
+		glDeleteBuffers(1, &bufferId);
+	}
+
+	return newId;
+}
+
+// the draw index goes at its reserved location once the vertex array and its buffer both exist
+static void rlmSetMultiDrawIndexAttribute()
+{
+	if (MultiDrawVaoId == 0 || MultiDrawIndexAttributeBuffer == 0)
+		return;
+
+	rlEnableVertexArray(MultiDrawVaoId);
+	rlEnableVertexBuffer(MultiDrawIndexAttributeBuffer);
+	rlSetVertexAttribute(RLM_MULTIDRAW_INDEX_LOCATION, 1, RL_FLOAT, false, 0, 0);
+	rlSetVertexAttributeDivisor(RLM_MULTIDRAW_INDEX_LOCATION, 1);
+	rlEnableVertexAttribute(RLM_MULTIDRAW_INDEX_LOCATION);
+
+	rlDisableVertexArray();
+	rlDisableVertexBuffer();
+}
+
+// the vertex array points at the buffers, so it is built again whenever they are replaced
+static void rlmBuildMultiDrawVertexArray()
+{
+	if (MultiDrawVaoId != 0)
+		rlUnloadVertexArray(MultiDrawVaoId);
+
+	MultiDrawVaoId = rlLoadVertexArray();
+	rlEnableVertexArray(MultiDrawVaoId);
+
+	for (int i = 0; i < RLM_MULTIDRAW_ATTRIBUTES; i++)
+	{
+		rlEnableVertexBuffer(MultiDrawVertexBuffers[i]);
+		rlSetVertexAttribute(MultiDrawAttributes[i].location, MultiDrawAttributes[i].size, MultiDrawAttributes[i].type, MultiDrawAttributes[i].normalized, 0, 0);
+		rlEnableVertexAttribute(MultiDrawAttributes[i].location);
+	}
+	rlEnableVertexBufferElement(MultiDrawIndexBuffer);
+
+	rlDisableVertexArray();
+	rlDisableVertexBuffer();
+	rlDisableVertexBufferElement();
+
+	rlmSetMultiDrawIndexAttribute();
+}
+
+static void rlmReserveMultiDrawGeometry(int vertexCount, int indexCount)
+{
+	if (vertexCount <= MultiDrawVertexCapacity && indexCount <= MultiDrawIndexCapacity)
+		return;
+
+	if (vertexCount > MultiDrawVertexCapacity)
+	{
+		int capacity = MultiDrawVertexCapacity > 0 ? MultiDrawVertexCapacity : 65536;
+		while (capacity < vertexCount)
+			capacity *= 2;
+
+		for (int i = 0; i < RLM_MULTIDRAW_ATTRIBUTES; i++)
+			MultiDrawVertexBuffers[i] = rlmGrowBuffer(MultiDrawVertexBuffers[i], MultiDrawVertexCount * MultiDrawAttributes[i].stride, capacity * MultiDrawAttributes[i].stride);
+
+		MultiDrawVertexCapacity = capacity;
+	}
+
+	if (indexCount > MultiDrawIndexCapacity)
+	{
+		int capacity = MultiDrawIndexCapacity > 0 ? MultiDrawIndexCapacity : 3 * 65536;
+		while (capacity < indexCount)
+			capacity *= 2;
+
+		MultiDrawIndexBuffer = rlmGrowBuffer(MultiDrawIndexBuffer, MultiDrawIndexCount * (int)sizeof(unsigned short), capacity * (int)sizeof(unsigned short));
+		MultiDrawIndexCapacity = capacity;
+	}
+
+	rlmBuildMultiDrawVertexArray();
+}
+
+static void rlmReserveMultiDrawCalls(int count)
+{
+	if (count <= MultiDrawCapacity)
+		return;
+
+	int capacity = MultiDrawCapacity > 0 ? MultiDrawCapacity : 256;
+	while (capacity < count)
+		capacity *= 2;
+
+	MultiDrawCommands = (rlmDrawElementsIndirectCommand*)MemRealloc(MultiDrawCommands, capacity * sizeof(rlmDrawElementsIndirectCommand));
+	MultiDrawTransforms = (float16*)MemRealloc(MultiDrawTransforms, capacity * sizeof(float16));
+
+	if (MultiDrawCommandBuffer != 0)
+		glDeleteBuffers(1, &MultiDrawCommandBuffer);
+
+	glGenBuffers(1, &MultiDrawCommandBuffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, MultiDrawCommandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, capacity * sizeof(rlmDrawElementsIndirectCommand), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	if (MultiDrawTransformBuffer != 0)
+		rlUnloadShaderBuffer(MultiDrawTransformBuffer);
+
+	// the first transform stays the identity, meshes drawn on their own with a multi draw shader read it
+	MultiDrawTransforms[0] = MatrixToFloatV(MatrixIdentity());
+	MultiDrawTransformBuffer = rlLoadShaderBuffer(capacity * sizeof(float16), NULL, RL_DYNAMIC_DRAW);
+	rlUpdateShaderBuffer(MultiDrawTransformBuffer, MultiDrawTransforms, sizeof(float16), 0);
+
+	// the indices never change, only the base instance of each command picks one
+	float* drawIndices = (float*)MemAlloc(capacity * sizeof(float));
+	for (int i = 0; i < capacity; i++)
+		drawIndices[i] = (float)i;
+
+	if (MultiDrawIndexAttributeBuffer != 0)
+		rlUnloadVertexBuffer(MultiDrawIndexAttributeBuffer);
+
+	MultiDrawIndexAttributeBuffer = rlLoadVertexBuffer(drawIndices, capacity * sizeof(float), false);
+	MemFree(drawIndices);
+
+	MultiDrawCapacity = capacity;
+
+	rlmSetMultiDrawIndexAttribute();
+}
+
+static const rlmMultiDrawEntry* rlmGetMultiDrawEntry(const rlmMesh* mesh)
+{
+	if (mesh->multiDrawSlot <= 0 || mesh->multiDrawSlot > MultiDrawEntryCount)
+		return NULL;
+
+	// copies of a mesh struct carry its slot along, so the entry has to point back at this mesh
+	const rlmMultiDrawEntry* entry = &MultiDrawEntries[mesh->multiDrawSlot - 1];
+	if (entry->mesh != mesh || entry->sourceVaoId != mesh->gpuMesh.vaoId || mesh->gpuMesh.arenaSlot > 0)
+		return NULL;
+
+	return entry;
+}
+
+static void rlmReleaseMultiDrawEntry(rlmMesh* mesh)
+{
+	if (mesh->multiDrawSlot > 0 && mesh->multiDrawSlot <= MultiDrawEntryCount)
+	{
+		rlmMultiDrawEntry* entry = &MultiDrawEntries[mesh->multiDrawSlot - 1];
+		if (entry->mesh == mesh)
+		{
+			entry->mesh = NULL;
+			entry->sourceVaoId = 0;
+			MultiDrawFreeEntries++;
+			MultiDrawFreeVertices += entry->vertexCount;
+			MultiDrawFreeIndices += entry->indexCount;
+		}
+	}
+
+	mesh->multiDrawSlot = 0;
+}
+
+// moves the live entries to the front of new buffers, so the space of released ones can be used again
+static void rlmRepackMultiDrawGeometry()
+{
+	unsigned int vertexBuffers[RLM_MULTIDRAW_ATTRIBUTES] = { 0 };
+	for (int i = 0; i < RLM_MULTIDRAW_ATTRIBUTES; i++)
+		vertexBuffers[i] = rlmGrowBuffer(0, 0, MultiDrawVertexCapacity * MultiDrawAttributes[i].stride);
+
+	unsigned int indexBuffer = rlmGrowBuffer(0, 0, MultiDrawIndexCapacity * (int)sizeof(unsigned short));
+
+	int vertexCount = 0;
+	int indexCount = 0;
+	for (int e = 0; e < MultiDrawEntryCount; e++)
+	{
+		rlmMultiDrawEntry* entry = &MultiDrawEntries[e];
+		if (entry->mesh == NULL)
+			continue;
+
+		for (int i = 0; i < RLM_MULTIDRAW_ATTRIBUTES; i++)
+		{
+			int stride = MultiDrawAttributes[i].stride;
+			rlmCopyBuffer(MultiDrawVertexBuffers[i], vertexBuffers[i], entry->baseVertex * stride, vertexCount * stride, entry->vertexCount * stride);
+		}
+
+		// the indices are relative to the base vertex, so they copy as they are
+		int indexSize = (int)sizeof(unsigned short);
+		rlmCopyBuffer(MultiDrawIndexBuffer, indexBuffer, entry->firstIndex * indexSize, indexCount * indexSize, entry->indexCount * indexSize);
+
+		entry->baseVertex = vertexCount;
+		entry->firstIndex = indexCount;
+		vertexCount += entry->vertexCount;
+		indexCount += entry->indexCount;
+	}
+
+	for (int i = 0; i < RLM_MULTIDRAW_ATTRIBUTES; i++)
+	{
+		glDeleteBuffers(1, &MultiDrawVertexBuffers[i]);
+		MultiDrawVertexBuffers[i] = vertexBuffers[i];
+	}
+
+	glDeleteBuffers(1, &MultiDrawIndexBuffer);
+	MultiDrawIndexBuffer = indexBuffer;
+
+	MultiDrawVertexCount = vertexCount;
+	MultiDrawIndexCount = indexCount;
+	MultiDrawFreeVertices = 0;
+	MultiDrawFreeIndices = 0;
+
+	rlmBuildMultiDrawVertexArray();
+}
+
+static bool rlmPackMeshForMultiDraw(rlmMesh* mesh)
+{
+	if (rlmGetMultiDrawEntry(mesh) != NULL)
+		return true;
+
+	rlmReleaseMultiDrawEntry(mesh);
+
+	const rlmGPUMesh* gpuMesh = &mesh->gpuMesh;
+	if (gpuMesh->vaoId == 0 || gpuMesh->vboIds == NULL || gpuMesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION] == 0)
+		return false;
+
+	// the shared buffers hold one float buffer per attribute and 16 bit indices
+	if (gpuMesh->vertexLayout != RLM_VERTEX_SEPARATE || gpuMesh->indices32)
+		return false;
+
+	// the CPU copy may be gone, so the sizes come from the buffers
+	int vertexCount = rlmGetBufferSize(gpuMesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION]) / (3 * (int)sizeof(float));
+	int indexCount = (int)gpuMesh->elementCount;
+	int indexBytes = indexCount * (int)sizeof(unsigned short);
+
+	if (vertexCount <= 0 || indexCount <= 0)
+		return false;
+
+	if (gpuMesh->isIndexed && rlmGetBufferSize(gpuMesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES]) < indexBytes)
+		return false;
+
+	// non indexed meshes get a 16 bit index list made for them
+	if (!gpuMesh->isIndexed && indexCount > 65536)
+		return false;
+
+	// reclaim released space before growing
+	bool full = MultiDrawVertexCount + vertexCount > MultiDrawVertexCapacity || MultiDrawIndexCount + indexCount > MultiDrawIndexCapacity;
+	if (full && (MultiDrawFreeVertices > 0 || MultiDrawFreeIndices > 0))
+		rlmRepackMultiDrawGeometry();
+
+	rlmReserveMultiDrawGeometry(MultiDrawVertexCount + vertexCount, MultiDrawIndexCount + indexCount);
+
+	for (int i = 0; i < RLM_MULTIDRAW_ATTRIBUTES; i++)
+	{
+		const rlmMultiDrawAttribute* attribute = &MultiDrawAttributes[i];
+		int size = vertexCount * attribute->stride;
+		int offset = MultiDrawVertexCount * attribute->stride;
+
+		unsigned int source = gpuMesh->vboIds[attribute->location];
+		if (source != 0 && rlmGetBufferSize(source) >= size)
+		{
+			rlmCopyBuffer(source, MultiDrawVertexBuffers[i], 0, offset, size);
+		}
+		else
+		{
+			unsigned char* fill = (unsigned char*)MemAlloc(size);
+			memset(fill, attribute->fill, size);
+			rlUpdateVertexBuffer(MultiDrawVertexBuffers[i], fill, size, offset);
+			MemFree(fill);
+		}
+	}
+
+	int indexOffset = MultiDrawIndexCount * (int)sizeof(unsigned short);
+	if (gpuMesh->isIndexed)
+	{
+		rlmCopyBuffer(gpuMesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES], MultiDrawIndexBuffer, 0, indexOffset, indexBytes);
+	}
+	else
+	{
+		unsigned short* indices = (unsigned short*)MemAlloc(indexBytes);
+		for (int i = 0; i < indexCount; i++)
+			indices[i] = (unsigned short)i;
+
+		// through the array buffer binding, the element binding would change whatever vertex array is bound
+		rlUpdateVertexBuffer(MultiDrawIndexBuffer, indices, indexBytes, indexOffset);
+		MemFree(indices);
+	}
+
+	// released slots are reused first, so the entry list doesn't grow with every reupload
+	int slot = -1;
+	if (MultiDrawFreeEntries > 0)
+	{
+		for (int e = 0; e < MultiDrawEntryCount && slot < 0; e++)
+		{
+			if (MultiDrawEntries[e].mesh == NULL)
+				slot = e;
+		}
+	}
+
+	if (slot >= 0)
+	{
+		MultiDrawFreeEntries--;
+	}
+	else
+	{
+		if (MultiDrawEntryCount >= MultiDrawEntryCapacity)
+		{
+			MultiDrawEntryCapacity = MultiDrawEntryCapacity > 0 ? MultiDrawEntryCapacity * 2 : 64;
+			MultiDrawEntries = (rlmMultiDrawEntry*)MemRealloc(MultiDrawEntries, MultiDrawEntryCapacity * sizeof(rlmMultiDrawEntry));
+		}
+		slot = MultiDrawEntryCount++;
+	}
+
+	rlmMultiDrawEntry* entry = &MultiDrawEntries[slot];
+	entry->mesh = mesh;
+	entry->sourceVaoId = gpuMesh->vaoId;
+	entry->firstIndex = MultiDrawIndexCount;
+	entry->indexCount = indexCount;
+	entry->baseVertex = MultiDrawVertexCount;
+	entry->vertexCount = vertexCount;
+
+	MultiDrawVertexCount += vertexCount;
+	MultiDrawIndexCount += indexCount;
+
+	mesh->multiDrawSlot = slot + 1;
+	return true;
+}
+
+static int rlmGetMultiDrawIndexLocation(unsigned int program)
+{
+	if (program != MultiDrawLastProgram)
+	{
+		MultiDrawLastProgram = program;
+		MultiDrawLastLocation = rlGetLocationAttrib(program, "drawIndex");
+	}
+
+	return MultiDrawLastLocation;
+}
+
+// meshes that are not packed, or not drawn in a run, still go through a multi draw shader one at a time
+// the draw index attribute is not in their vertex arrays, so it reads its default of 0, the identity transform
+static void rlmBindMultiDrawIdentity(const Shader* shader)
+{
+	if (rlmGetMultiDrawIndexLocation(shader->id) != RLM_MULTIDRAW_INDEX_LOCATION)
+		return;
+
+	rlmReserveMultiDrawCalls(1);
+
+	static const float drawIndex = 0.0f;
+	rlSetVertexAttributeDefault(RLM_MULTIDRAW_INDEX_LOCATION, &drawIndex, SHADER_ATTRIB_FLOAT, 1);
+	rlBindShaderBuffer(MultiDrawTransformBuffer, RLM_MULTIDRAW_TRANSFORM_BINDING);
+}
+
+static void rlmResetMultiDrawProgram()
+{
+	MultiDrawLastProgram = 0;
+	MultiDrawLastLocation = -1;
+}
+
+// program ids get reused once a shader is unloaded
+static void rlmForgetMultiDrawProgram(unsigned int program)
+{
+	if (program == MultiDrawLastProgram)
+		rlmResetMultiDrawProgram();
+}
+
+// the shared buffer entry a packet can be drawn from, -1 when it has to be drawn on its own
+static int rlmGetMultiDrawPacketEntry(const rlmQueuePacket* packet)
+{
+	if (!UseMultiDraw || packet->poseOffset >= 0)
+		return -1;
+
+	const Shader* shader = &packet->group->material.shader;
+	// shaders that put the draw index anywhere else would read a mesh attribute instead
+	if (rlmShaderTakesBones(shader) || rlmGetMultiDrawIndexLocation(shader->id) != RLM_MULTIDRAW_INDEX_LOCATION)
+		return -1;
+
+	// LODs have index buffers of their own
+	const rlmMesh* mesh = &packet->group->meshes[packet->meshIndex];
+	if (packet->gpuMesh != &mesh->gpuMesh)
+		return -1;
+
+	if (rlmGetMultiDrawEntry(mesh) == NULL)
+		return -1;
+
+	return mesh->multiDrawSlot - 1;
+}
+
+// draws the packets from item on that share its material and shared buffers in one call, returns how many were drawn
+static int rlmDrawMultiDrawRun(int item, Shader* shader, Matrix matView, Matrix matProjection)
+{
+	const rlmMaterialDef* material = &QueuePackets[QueueSortItems[item].packet].group->material;
+
+	int count = 0;
+	while (item + count < QueuePacketCount)
+	{
+		const rlmQueuePacket* packet = &QueuePackets[QueueSortItems[item + count].packet];
+		if (packet->multiDrawEntry < 0 || &packet->group->material != material)
+			break;
+		count++;
+	}
+
+	rlmReserveMultiDrawCalls(count + 1);
+	if (MultiDrawCommands == NULL || MultiDrawTransforms == NULL)
+		return 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		const rlmQueuePacket* packet = &QueuePackets[QueueSortItems[item + i].packet];
+		const rlmMultiDrawEntry* entry = &MultiDrawEntries[packet->multiDrawEntry];
+
+		MultiDrawCommands[i].count = (unsigned int)entry->indexCount;
+		MultiDrawCommands[i].instanceCount = 1;
+		MultiDrawCommands[i].firstIndex = (unsigned int)entry->firstIndex;
+		MultiDrawCommands[i].baseVertex = entry->baseVertex;
+		MultiDrawCommands[i].baseInstance = (unsigned int)i + 1;
+
+		// same order as the per packet path, which puts the mesh transform in with the view
+		const rlmPQSTransorm* meshTransform = &packet->group->meshes[packet->meshIndex].transform;
+		Matrix matMesh = packet->matModel;
+		if (packet->meshTransform && !rlmIsPQSIdentity(meshTransform))
+			matMesh = MatrixMultiply(packet->matModel, rlmPQSToMatrix(meshTransform));
+
+		MultiDrawTransforms[i + 1] = MatrixToFloatV(matMesh);
+	}
+
+	rlUpdateShaderBuffer(MultiDrawTransformBuffer, MultiDrawTransforms + 1, count * sizeof(float16), sizeof(float16));
+	rlBindShaderBuffer(MultiDrawTransformBuffer, RLM_MULTIDRAW_TRANSFORM_BINDING);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, MultiDrawCommandBuffer);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, count * sizeof(rlmDrawElementsIndirectCommand), MultiDrawCommands);
+
+	// the model matrix is per draw
+	if (shader->locs[SHADER_LOC_MATRIX_VIEW] != -1)
+		rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_VIEW], matView);
+
+	if (shader->locs[SHADER_LOC_MATRIX_PROJECTION] != -1)
+		rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_PROJECTION], matProjection);
+
+	if (shader->locs[SHADER_LOC_MATRIX_MODEL] != -1)
+		rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_MODEL], MatrixIdentity());
+
+	if (shader->locs[SHADER_LOC_MATRIX_NORMAL] != -1)
+		rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_NORMAL], MatrixIdentity());
+
+	rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_MVP], MatrixMultiply(matView, matProjection));
+
+	// the draw index is already set up at its reserved location
+	rlEnableVertexArray(MultiDrawVaoId);
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, NULL, count, 0);
+	rlDisableVertexArray();
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	return count;
+}
+
+#endif
+
+bool rlmIsMultiDrawSupported()
+{
+#if defined(RLM_SUPPORT_MULTIDRAW)
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool rlmPackModelForMultiDraw(rlmModel model)
+{
+#if defined(RLM_SUPPORT_MULTIDRAW)
+	int failed = 0;
+	for (int group = 0; group < model.groupCount; group++)
+	{
+		for (int i = 0; i < model.groups[group].meshCount; i++)
+		{
+			if (!rlmPackMeshForMultiDraw(&model.groups[group].meshes[i]))
+				failed++;
+		}
+	}
+
+	if (failed > 0)
+		TraceLog(LOG_WARNING, "rlModels : %d meshes could not be packed for multi draw, they are drawn on their own", failed);
+
+	return failed == 0;
+#else
+	(void)model;
+	return false;
+#endif
+}
+
+void rlmSetMultiDraw(bool enabled)
+{
+#if defined(RLM_SUPPORT_MULTIDRAW)
+	UseMultiDraw = enabled;
+#else
+	(void)enabled;
+#endif
+}
+
+Shader rlmGetMultiDrawShader()
+{
+#if defined(RLM_SUPPORT_MULTIDRAW)
+	if (!MultiDrawShaderLoaded)
+	{
+		MultiDrawShader = LoadShaderFromMemory(MultiDrawVertexShader, MultiDrawFragmentShader);
+		MultiDrawShaderLoaded = true;
+	}
+
+	return MultiDrawShader;
+#else
+	// nothing reads the draw transforms here, so it is only useful as a plain shader
+	return (Shader){ rlGetShaderIdDefault(), rlGetShaderLocsDefault() };
+#endif
+}
+
+void rlmUnloadMultiDrawResources()
+{
+#if defined(RLM_SUPPORT_MULTIDRAW)
+	if (MultiDrawVaoId != 0)
+		rlUnloadVertexArray(MultiDrawVaoId);
+
+	for (int i = 0; i < RLM_MULTIDRAW_ATTRIBUTES; i++)
+	{
+		if (MultiDrawVertexBuffers[i] != 0)
+			rlUnloadVertexBuffer(MultiDrawVertexBuffers[i]);
+		MultiDrawVertexBuffers[i] = 0;
+	}
+
+	if (MultiDrawIndexBuffer != 0)
+		rlUnloadVertexBuffer(MultiDrawIndexBuffer);
+
+	if (MultiDrawCommandBuffer != 0)
+		glDeleteBuffers(1, &MultiDrawCommandBuffer);
+
+	if (MultiDrawTransformBuffer != 0)
+		rlUnloadShaderBuffer(MultiDrawTransformBuffer);
+
+	if (MultiDrawIndexAttributeBuffer != 0)
+		rlUnloadVertexBuffer(MultiDrawIndexAttributeBuffer);
+
+	MultiDrawVaoId = 0;
+	MultiDrawIndexBuffer = 0;
+	MultiDrawCommandBuffer = 0;
+	MultiDrawTransformBuffer = 0;
+	MultiDrawIndexAttributeBuffer = 0;
+	MultiDrawVertexCount = 0;
+	MultiDrawVertexCapacity = 0;
+	MultiDrawIndexCount = 0;
+	MultiDrawIndexCapacity = 0;
+	MultiDrawCapacity = 0;
+
+	// the slots left in meshes no longer match an entry, so they are packed again from scratch
+	MemFree(MultiDrawEntries);
+	MultiDrawEntries = NULL;
+	MultiDrawEntryCount = 0;
+	MultiDrawEntryCapacity = 0;
+	MultiDrawFreeEntries = 0;
+	MultiDrawFreeVertices = 0;
+	MultiDrawFreeIndices = 0;
+
+	MemFree(MultiDrawCommands);
+	MultiDrawCommands = NULL;
+
+	MemFree(MultiDrawTransforms);
+	MultiDrawTransforms = NULL;
+
+	rlmResetMultiDrawProgram();
+
+	if (MultiDrawShaderLoaded)
+	{
+		rlmStateForgetProgram(MultiDrawShader.id);
+		UnloadShader(MultiDrawShader);
+	}
+
+	MultiDrawShader = (Shader){ 0 };
+	MultiDrawShaderLoaded = false;
+#endif
+}
+
+static unsigned long long rlmQueueKeyBits(unsigned int value, int bits)
+{
+	unsigned long long max = (1ull << bits) - 1;
+	return value > max ? max : value;
+}
+
+// positive floats sort the same as their bit patterns, so the top bits make a coarse depth
+static unsigned int rlmQueueDepthBits(float distanceSqr, int bits)
+{
+	unsigned int floatBits = 0;
+	memcpy(&floatBits, &distanceSqr, sizeof(floatBits));
+	return floatBits >> (32 - bits);
+}
+
+// opaque:      pass(1) shader(15) texture(16) vao(16) depth(16), front to back inside the same state
+// transparent: pass(1) inverse depth(24) shader(13) texture(13) vao(13), back to front first, state second
+static unsigned long long rlmBuildQueueKey(const rlmQueuePacket* packet, Vector3 viewPosition)
+{
+	const rlmMaterialDef* material = &packet->group->material;
+	unsigned int shaderId = material->shader.id;
+	unsigned int textureId = (unsigned int)material->baseChannel.textureId;
+	unsigned int vaoId = packet->gpuMesh->vaoId;
+
+#if defined(RLM_SUPPORT_MULTIDRAW)
+	// packed meshes all share one vertex array, so they sort by depth inside the material
+	if (packet->multiDrawEntry >= 0)
+		vaoId = MultiDrawVaoId;
+#endif
+
+	Vector3 position = { packet->matModel.m12, packet->matModel.m13, packet->matModel.m14 };
+	float distanceSqr = Vector3DistanceSqr(position, viewPosition);
+
+	bool transparent = material->baseChannel.color.a < 255;
+	if (!transparent)
+	{
+		return (rlmQueueKeyBits(shaderId, 15) << 48) |
+			(rlmQueueKeyBits(textureId, 16) << 32) |
+			(rlmQueueKeyBits(vaoId, 16) << 16) |
+			rlmQueueDepthBits(distanceSqr, 16);
+	}
+
+	unsigned long long inverseDepth = 0xFFFFFFull - rlmQueueDepthBits(distanceSqr, 24);
+
+	return (1ull << 63) |
+		(inverseDepth << 39) |
+		(rlmQueueKeyBits(shaderId, 13) << 26) |
+		(rlmQueueKeyBits(textureId, 13) << 13) |
+		rlmQueueKeyBits(vaoId, 13);
+}
+
+static int rlmCompareQueueItems(const void* lhs, const void* rhs)
+{
+	const rlmQueueSortItem* a = (const rlmQueueSortItem*)lhs;
+	const rlmQueueSortItem* b = (const rlmQueueSortItem*)rhs;
+
+	if (a->key != b->key)
+		return a->key < b->key ? -1 : 1;
+
+	// keep submission order for equal keys
+	return a->packet - b->packet;
+}
+
+static void rlmQueueApplyChannel(rlmMaterialChannel* channel, Shader* shader, rlmRenderQueueStats* stats)
+{
+	if (rlmStateBindTexture(channel->textureSlot, channel->textureId, channel->cubeMap))
+		stats->textureChanges++;
+
+	// uniforms go through the state cache too
+	rlmApplyMaterialChannelCached(channel, shader);
+}
+
+rlmRenderQueueStats rlmFlushQueue()
+{
+	rlmRenderQueueStats stats = { 0 };
+
+	if (!QueueActive)
+		return stats;
+
+	QueueActive = false;
+	stats.packets = QueuePacketCount;
+
+	if (QueuePacketCount == 0)
+		return stats;
+
+	Matrix matView = rlGetMatrixModelview();
+	Matrix matProjection = rlGetMatrixProjection();
+
+	Matrix invView = MatrixInvert(matView);
+	Vector3 viewPosition = { invView.m12, invView.m13, invView.m14 };
+
+#if defined(RLM_SUPPORT_MULTIDRAW)
+	rlmResetMultiDrawProgram();
+
+	for (int i = 0; i < QueuePacketCount; i++)
+		QueuePackets[i].multiDrawEntry = rlmGetMultiDrawPacketEntry(&QueuePackets[i]);
+#endif
+
+	for (int i = 0; i < QueuePacketCount; i++)
+	{
+		QueueSortItems[i].key = rlmBuildQueueKey(&QueuePackets[i], viewPosition);
+		QueueSortItems[i].packet = i;
+	}
+
+	qsort(QueueSortItems, QueuePacketCount, sizeof(rlmQueueSortItem), rlmCompareQueueItems);
+
+	const rlmMaterialDef* currentMaterial = NULL;
+	const rlmGPUMesh* currentMesh = NULL;
+	unsigned int currentArenaVaoId = 0;
+	bool blending = false;
+
+	rlmStateBeginDraw();
+	rlmBeginBonePaletteDraw();
+
+	for (int item = 0; item < QueuePacketCount; item++)
+	{
+		const rlmQueuePacket* packet = &QueuePackets[QueueSortItems[item].packet];
+		rlmMaterialDef* material = &packet->group->material;
+		Shader* shader = &material->shader;
+		rlmGPUMesh* mesh = packet->gpuMesh;
+
+		bool transparent = (QueueSortItems[item].key >> 63) != 0;
+		if (transparent != blending)
+		{
+			// opaque packets always come first
+			rlDisableDepthMask();
+			blending = true;
+		}
+
+		if (rlmStateUseProgram(shader->id))
+			stats.shaderChanges++;
+
+		if (material != currentMaterial)
+		{
+			rlmQueueApplyChannel(&material->baseChannel, shader, &stats);
+
+			for (int i = 0; i < material->materialChannels; i++)
+				rlmQueueApplyChannel(&material->extraChannels[i], shader, &stats);
+
+			for (int i = 0; i < material->materialValues; i++)
+				rlmStateSetUniform(material->values[i].shaderLoc, &material->values[i].value, SHADER_UNIFORM_FLOAT, 1);
+
+			currentMaterial = material;
+			stats.materialChanges++;
+		}
+
+#if defined(RLM_SUPPORT_MULTIDRAW)
+		if (packet->multiDrawEntry >= 0)
+		{
+			int drawn = rlmDrawMultiDrawRun(item, shader, matView, matProjection);
+			if (drawn > 0)
+			{
+				item += drawn - 1;
+				currentMesh = NULL;
+				currentArenaVaoId = 0;
+				stats.meshChanges++;
+				stats.drawCalls++;
+				stats.multiDrawPackets += drawn;
+				continue;
+			}
+		}
+#endif
+
+		if (rlmShaderTakesBones(shader))
+		{
+			if (packet->poseOffset >= 0)
+			{
+				rlmSetShaderBones(shader, QueuePoses + packet->poseOffset, packet->boneCount);
+			}
+			else
+			{
+				CheckGlobalBoneMatricies();
+				rlmSetShaderBones(shader, DefaultBoneMatricies, packet->boneCount);
+			}
+		}
+
+		Matrix matMeshView = matView;
+		if (packet->meshTransform)
+			matMeshView = MatrixMultiply(rlmPQSToMatrix(&packet->group->meshes[packet->meshIndex].transform), matView);
+
+		if (shader->locs[SHADER_LOC_MATRIX_VIEW] != -1)
+			rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_VIEW], matMeshView);
+
+		if (shader->locs[SHADER_LOC_MATRIX_PROJECTION] != -1)
+			rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_PROJECTION], matProjection);
+
+		if (shader->locs[SHADER_LOC_MATRIX_MODEL] != -1)
+			rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_MODEL], packet->matModel);
+
+		if (shader->locs[SHADER_LOC_MATRIX_NORMAL] != -1)
+			rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_NORMAL], MatrixTranspose(MatrixInvert(packet->matModel)));
+
+		rlSetUniformMatrix(shader->locs[SHADER_LOC_MATRIX_MVP], MatrixMultiply(MatrixMultiply(packet->matModel, matMeshView), matProjection));
+
+		// the VAO stays bound while the same mesh, or another mesh in the same arena page, is drawn again
+		if (mesh != currentMesh && (mesh->arenaSlot == 0 || mesh->vaoId != currentArenaVaoId))
+		{
+			rlmBindMeshAttributes(mesh, shader);
+			stats.meshChanges++;
+		}
+		currentMesh = mesh;
+		currentArenaVaoId = mesh->arenaSlot > 0 ? mesh->vaoId : 0;
+
+		if (mesh->isIndexed)
+			rlmDrawElements(mesh, 0, mesh->elementCount);
+		else
+			rlDrawVertexArray(0, mesh->elementCount);
+
+		stats.drawCalls++;
+	}
+
+	rlDisableVertexArray();
+	rlDisableVertexBuffer();
+	rlDisableVertexBufferElement();
+
+	if (blending)
+		rlEnableDepthMask();
+
+	rlmStateRestore();
+	rlSetTexture(0);
+
+	stats.stateChanges = stats.shaderChanges + stats.materialChanges + stats.textureChanges + stats.meshChanges;
+
+	QueuePacketCount = 0;
+	return stats;
+}
+
+void rlmUnloadQueue()
+{
+	MemFree(QueuePackets);
+	MemFree(QueueSortItems);
+	QueuePackets = NULL;
+	QueueSortItems = NULL;
+	QueuePacketCount = 0;
+	QueuePacketCapacity = 0;
+	QueueActive = false;
+
+	MemFree(QueuePoses);
+	QueuePoses = NULL;
+	QueuePoseCount = 0;
+	QueuePoseCapacity = 0;
+}
+
+// bounds tree, a dynamic AABB tree with fattened leaves and AVL style rotations to stay balanced
+#define RLM_BOUNDS_TREE_NULL -1
+#define RLM_BOUNDS_TREE_STACK 256
+
+rlmBoundsTree rlmLoadBoundsTree(float margin)
+{
+	rlmBoundsTree tree = { 0 };
+	tree.root = RLM_BOUNDS_TREE_NULL;
+	tree.freeList = RLM_BOUNDS_TREE_NULL;
+	tree.margin = margin > 0 ? margin : 0;
+
+	return tree;
+}
+
+void rlmUnloadBoundsTree(rlmBoundsTree* tree)
+{
+	if (!tree)
+		return;
+
+	MemFree(tree->nodes);
+	*tree = rlmLoadBoundsTree(tree->margin);
+}
+
+static float rlmGetBoxArea(BoundingBox box)
+{
+	Vector3 size = Vector3Subtract(box.max, box.min);
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+static BoundingBox rlmCombineBoxes(BoundingBox a, BoundingBox b)
+{
+	return (BoundingBox){ Vector3Min(a.min, b.min), Vector3Max(a.max, b.max) };
+}
+
+static bool rlmBoxContains(BoundingBox outer, BoundingBox inner)
+{
+	return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z
+		&& outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+}
+
+static bool rlmBoxesOverlap(BoundingBox a, BoundingBox b)
+{
+	return a.min.x <= b.max.x && a.max.x >= b.min.x
+		&& a.min.y <= b.max.y && a.max.y >= b.min.y
+		&& a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+static int rlmAllocateBoundsTreeNode(rlmBoundsTree* tree)
+{
+	if (tree->freeList == RLM_BOUNDS_TREE_NULL)
+	{
+		int capacity = tree->nodeCapacity > 0 ? tree->nodeCapacity * 2 : 64;
+		rlmBoundsTreeNode* nodes = (rlmBoundsTreeNode*)MemRealloc(tree->nodes, capacity * sizeof(rlmBoundsTreeNode));
+		if (!nodes)
+			return RLM_BOUNDS_TREE_NULL;
+
+		// chain the new nodes into the free list
+		for (int i = tree->nodeCapacity; i < capacity; i++)
+		{
+			nodes[i].parent = i + 1 < capacity ? i + 1 : RLM_BOUNDS_TREE_NULL;
+			nodes[i].height = -1;
+		}
+
+		tree->freeList = tree->nodeCapacity;
+		tree->nodes = nodes;
+		tree->nodeCapacity = capacity;
+	}
+
+	int id = tree->freeList;
+	rlmBoundsTreeNode* node = &tree->nodes[id];
+	tree->freeList = node->parent;
+
+	node->parent = RLM_BOUNDS_TREE_NULL;
+	node->child1 = RLM_BOUNDS_TREE_NULL;
+	node->child2 = RLM_BOUNDS_TREE_NULL;
+	node->height = 0;
+	node->userId = -1;
+	tree->nodeCount++;
+
+	return id;
+}
+
+static void rlmFreeBoundsTreeNode(rlmBoundsTree* tree, int id)
+{
+	tree->nodes[id].parent = tree->freeList;
+	tree->nodes[id].height = -1;
+	tree->freeList = id;
+	tree->nodeCount--;
+}
+
+// rotates the taller grandchild up when the children of a node are more than one level apart, returns the new subtree root
+static int rlmBalanceBoundsTreeNode(rlmBoundsTree* tree, int a)
+{
+	rlmBoundsTreeNode* nodes = tree->nodes;
+	rlmBoundsTreeNode* nodeA = &nodes[a];
+	if (nodeA->child1 == RLM_BOUNDS_TREE_NULL || nodeA->height < 2)
+		return a;
+
+	int b = nodeA->child1;
+	int c = nodeA->child2;
+	int balance = nodes[c].height - nodes[b].height;
+
+	if (balance > 1 || balance < -1)
+	{
+		// rotate the taller child up into the place of a
+		int up = balance > 1 ? c : b;
+		int other = balance > 1 ? b : c;
+		rlmBoundsTreeNode* nodeUp = &nodes[up];
+
+		int f = nodeUp->child1;
+		int g = nodeUp->child2;
+
+		nodeUp->child1 = a;
+		nodeUp->parent = nodeA->parent;
+		nodeA->parent = up;
+
+		if (nodeUp->parent != RLM_BOUNDS_TREE_NULL)
+		{
+			if (nodes[nodeUp->parent].child1 == a)
+				nodes[nodeUp->parent].child1 = up;
+			else
+				nodes[nodeUp->parent].child2 = up;
+		}
+		else
+		{
+			tree->root = up;
+		}
+
+		// the taller grandchild stays with the node that moved up, the other one goes down to a
+		int keep = nodes[f].height > nodes[g].height ? f : g;
+		int give = keep == f ? g : f;
+
+		nodeUp->child2 = keep;
+		if (balance > 1)
+			nodeA->child2 = give;
+		else
+			nodeA->child1 = give;
+		nodes[give].parent = a;
+
+		nodeA->bounds = rlmCombineBoxes(nodes[other].bounds, nodes[give].bounds);
+		nodeUp->bounds = rlmCombineBoxes(nodeA->bounds, nodes[keep].bounds);
+
+		nodeA->height = 1 + (nodes[other].height > nodes[give].height ? nodes[other].height : nodes[give].height);
+		nodeUp->height = 1 + (nodeA->height > nodes[keep].height ? nodeA->height : nodes[keep].height);
+
+		return up;
+	}
+
+	return a;
+}
+
+// walks up from a node fixing the bounds and heights, balancing as it goes
+static void rlmRefitBoundsTreeParents(rlmBoundsTree* tree, int index)
+{
+	while (index != RLM_BOUNDS_TREE_NULL)
+	{
+		index = rlmBalanceBoundsTreeNode(tree, index);
+
+		rlmBoundsTreeNode* node = &tree->nodes[index];
+		const rlmBoundsTreeNode* child1 = &tree->nodes[node->child1];
+		const rlmBoundsTreeNode* child2 = &tree->nodes[node->child2];
+
+		node->height = 1 + (child1->height > child2->height ? child1->height : child2->height);
+		node->bounds = rlmCombineBoxes(child1->bounds, child2->bounds);
+
+		index = node->parent;
+	}
+}
+
+static void rlmInsertBoundsTreeLeaf(rlmBoundsTree* tree, int leaf)
+{
+	if (tree->root == RLM_BOUNDS_TREE_NULL)
+	{
+		tree->root = leaf;
+		tree->nodes[leaf].parent = RLM_BOUNDS_TREE_NULL;
+		return;
+	}
+
+	// find the best sibling by the surface area cost of growing each node on the way down
+	BoundingBox leafBounds = tree->nodes[leaf].bounds;
+	int index = tree->root;
+	while (tree->nodes[index].child1 != RLM_BOUNDS_TREE_NULL)
+	{
+		const rlmBoundsTreeNode* node = &tree->nodes[index];
+
+		float area = rlmGetBoxArea(node->bounds);
+		float combinedArea = rlmGetBoxArea(rlmCombineBoxes(node->bounds, leafBounds));
+
+		// cost of making a new parent here, and the cost pushed down to the children if we go on
+		float cost = 2.0f * combinedArea;
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float childCosts[2];
+		int children[2] = { node->child1, node->child2 };
+		for (int i = 0; i < 2; i++)
+		{
+			const rlmBoundsTreeNode* child = &tree->nodes[children[i]];
+			float childCost = rlmGetBoxArea(rlmCombineBoxes(child->bounds, leafBounds));
+			if (child->child1 != RLM_BOUNDS_TREE_NULL)
+				childCost -= rlmGetBoxArea(child->bounds);
+
+			childCosts[i] = childCost + inheritanceCost;
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1])
+			break;
+
+		index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+	}
+
+	int sibling = index;
+	int oldParent = tree->nodes[sibling].parent;
+	int newParent = rlmAllocateBoundsTreeNode(tree);
+	if (newParent == RLM_BOUNDS_TREE_NULL)
+		return;
+
+	rlmBoundsTreeNode* parentNode = &tree->nodes[newParent];
+	parentNode->parent = oldParent;
+	parentNode->bounds = rlmCombineBoxes(leafBounds, tree->nodes[sibling].bounds);
+	parentNode->height = tree->nodes[sibling].height + 1;
+	parentNode->child1 = sibling;
+	parentNode->child2 = leaf;
+
+	if (oldParent != RLM_BOUNDS_TREE_NULL)
+	{
+		if (tree->nodes[oldParent].child1 == sibling)
+			tree->nodes[oldParent].child1 = newParent;
+		else
+			tree->nodes[oldParent].child2 = newParent;
+	}
+	else
+	{
+		tree->root = newParent;
+	}
+
+	tree->nodes[sibling].parent = newParent;
+	tree->nodes[leaf].parent = newParent;
+
+	rlmRefitBoundsTreeParents(tree, newParent);
+}
+
+static void rlmDetachBoundsTreeLeaf(rlmBoundsTree* tree, int leaf)
+{
+	if (leaf == tree->root)
+	{
+		tree->root = RLM_BOUNDS_TREE_NULL;
+		return;
+	}
+
+	// the sibling takes the place of the parent
+	int parent = tree->nodes[leaf].parent;
+	int grandParent = tree->nodes[parent].parent;
+	int sibling = tree->nodes[parent].child1 == leaf ? tree->nodes[parent].child2 : tree->nodes[parent].child1;
+
+	if (grandParent != RLM_BOUNDS_TREE_NULL)
+	{
+		if (tree->nodes[grandParent].child1 == parent)
+			tree->nodes[grandParent].child1 = sibling;
+		else
+			tree->nodes[grandParent].child2 = sibling;
+
+		tree->nodes[sibling].parent = grandParent;
+		rlmFreeBoundsTreeNode(tree, parent);
+
+		rlmRefitBoundsTreeParents(tree, grandParent);
+	}
+	else
+	{
+		tree->root = sibling;
+		tree->nodes[sibling].parent = RLM_BOUNDS_TREE_NULL;
+		rlmFreeBoundsTreeNode(tree, parent);
+	}
+}
+
+static BoundingBox rlmFattenBox(BoundingBox box, float margin)
+{
+	Vector3 grow = { margin, margin, margin };
+	return (BoundingBox){ Vector3Subtract(box.min, grow), Vector3Add(box.max, grow) };
+}
+
+static bool rlmIsBoundsTreeLeaf(const rlmBoundsTree* tree, int leaf)
+{
+	return tree && leaf >= 0 && leaf < tree->nodeCapacity && tree->nodes[leaf].height == 0 && tree->nodes[leaf].child1 == RLM_BOUNDS_TREE_NULL;
+}
+
+int rlmAddBoundsTreeLeaf(rlmBoundsTree* tree, BoundingBox bounds, int userId)
+{
+	if (!tree)
+		return -1;
+
+	int leaf = rlmAllocateBoundsTreeNode(tree);
+	if (leaf == RLM_BOUNDS_TREE_NULL)
+		return -1;
+
+	tree->nodes[leaf].bounds = rlmFattenBox(bounds, tree->margin);
+	tree->nodes[leaf].userId = userId;
+
+	rlmInsertBoundsTreeLeaf(tree, leaf);
+	tree->leafCount++;
+
+	return leaf;
+}
+
+void rlmRemoveBoundsTreeLeaf(rlmBoundsTree* tree, int leaf)
+{
+	if (!rlmIsBoundsTreeLeaf(tree, leaf))
+		return;
+
+	rlmDetachBoundsTreeLeaf(tree, leaf);
+	rlmFreeBoundsTreeNode(tree, leaf);
+	tree->leafCount--;
+}
+
+bool rlmMoveBoundsTreeLeaf(rlmBoundsTree* tree, int leaf, BoundingBox bounds)
+{
+	if (!rlmIsBoundsTreeLeaf(tree, leaf))
+		return false;
+
+	// small moves stay inside the fattened box and don't touch the tree
+	if (rlmBoxContains(tree->nodes[leaf].bounds, bounds))
+		return false;
+
+	rlmDetachBoundsTreeLeaf(tree, leaf);
+	tree->nodes[leaf].bounds = rlmFattenBox(bounds, tree->margin);
+	tree->nodes[leaf].parent = RLM_BOUNDS_TREE_NULL;
+	rlmInsertBoundsTreeLeaf(tree, leaf);
+
+	return true;
+}
+
+// 0 outside, 1 crossing a plane, 2 fully inside
+static int rlmClassifyBoxInFrustum(const rlmFrustum* frustum, BoundingBox box)
+{
+	Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+	Vector3 extents = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+
+	int result = 2;
+	for (int i = 0; i < 6; i++)
+	{
+		const Vector4* plane = &frustum->planes[i];
+		float distance = plane->x * center.x + plane->y * center.y + plane->z * center.z + plane->w;
+		float radius = fabsf(plane->x) * extents.x + fabsf(plane->y) * extents.y + fabsf(plane->z) * extents.z;
+
+		if (distance + radius < 0)
+			return 0;
+
+		if (distance - radius < 0)
+			result = 1;
+	}
+
+	return result;
+}
+
+int rlmQueryBoundsTreeFrustum(const rlmBoundsTree* tree, const rlmFrustum* frustum, int* userIds, int maxResults)
+{
+	if (!tree || !frustum || !userIds || tree->root == RLM_BOUNDS_TREE_NULL)
+		return 0;
+
+	int stack[RLM_BOUNDS_TREE_STACK];
+	bool insideStack[RLM_BOUNDS_TREE_STACK];
+	int stackSize = 0;
+	int count = 0;
+
+	stack[stackSize] = tree->root;
+	insideStack[stackSize++] = false;
+
+	while (stackSize > 0 && count < maxResults)
+	{
+		stackSize--;
+		const rlmBoundsTreeNode* node = &tree->nodes[stack[stackSize]];
+		bool inside = insideStack[stackSize];
+
+		// once a node is fully inside, nothing under it needs testing
+		if (!inside)
+		{
+			int result = rlmClassifyBoxInFrustum(frustum, node->bounds);
+			if (result == 0)
+				continue;
+
+			inside = result == 2;
+		}
+
+		if (node->child1 == RLM_BOUNDS_TREE_NULL)
+		{
+			userIds[count++] = node->userId;
+			continue;
+		}
+
+		if (stackSize + 2 > RLM_BOUNDS_TREE_STACK)
+		{
+			TraceLog(LOG_WARNING, "rlModels : bounds tree is too deep to query");
+			break;
+		}
+
+		stack[stackSize] = node->child1;
+		insideStack[stackSize++] = inside;
+		stack[stackSize] = node->child2;
+		insideStack[stackSize++] = inside;
 	}
-	else
+
+	return count;
+}
+
+int rlmQueryBoundsTreeBox(const rlmBoundsTree* tree, BoundingBox box, int* userIds, int maxResults)
+{
+	if (!tree || !userIds || tree->root == RLM_BOUNDS_TREE_NULL)
+		return 0;
+
+	int stack[RLM_BOUNDS_TREE_STACK];
+	int stackSize = 0;
+	int count = 0;
+
+	stack[stackSize++] = tree->root;
+
+	while (stackSize > 0 && count < maxResults)
 	{
-		material->materialChannels++;
-		material->extraChannels = (rlmMaterialChannel*)MemRealloc(material->extraChannels, sizeof(rlmMaterialChannel) * material->materialChannels);
+		const rlmBoundsTreeNode* node = &tree->nodes[stack[--stackSize]];
+		if (!rlmBoxesOverlap(node->bounds, box))
+			continue;
+
+		if (node->child1 == RLM_BOUNDS_TREE_NULL)
+		{
+			userIds[count++] = node->userId;
+			continue;
+		}
+
+		if (stackSize + 2 > RLM_BOUNDS_TREE_STACK)
+		{
+			TraceLog(LOG_WARNING, "rlModels : bounds tree is too deep to query");
+			break;
+		}
+
+		stack[stackSize++] = node->child1;
+		stack[stackSize++] = node->child2;
 	}
 
-	material->extraChannels[material->materialChannels - 1].ownsTexture = false;
-	material->extraChannels[material->materialChannels - 1].cubeMap = isCubeMap;
-	material->extraChannels[material->materialChannels - 1].textureId = texture.id;
-	material->extraChannels[material->materialChannels - 1].textureLoc = shaderLoc;
-	material->extraChannels[material->materialChannels - 1].textureSlot = slot;
-	material->extraChannels[material->materialChannels - 1].color = WHITE;
-	material->extraChannels[material->materialChannels - 1].colorLoc = 0;
+	return count;
 }
 
-void rlmAddMaterialChannels(rlmMaterialDef* material, int count, Texture2D* textures, int* locs)
+// slab test, returns the entry distance or -1 when missed
+static float rlmGetRayBoxDistance(Vector3 origin, Vector3 inverseDirection, float maxDistance, BoundingBox box)
 {
-	if (!material)
-		return;
+	float t1 = (box.min.x - origin.x) * inverseDirection.x;
+	float t2 = (box.max.x - origin.x) * inverseDirection.x;
+	float tMin = fminf(t1, t2);
+	float tMax = fmaxf(t1, t2);
+
+	t1 = (box.min.y - origin.y) * inverseDirection.y;
+	t2 = (box.max.y - origin.y) * inverseDirection.y;
+	tMin = fmaxf(tMin, fminf(t1, t2));
+	tMax = fminf(tMax, fmaxf(t1, t2));
+
+	t1 = (box.min.z - origin.z) * inverseDirection.z;
+	t2 = (box.max.z - origin.z) * inverseDirection.z;
+	tMin = fmaxf(tMin, fminf(t1, t2));
+	tMax = fminf(tMax, fmaxf(t1, t2));
+
+	if (tMax < 0 || tMin > tMax || tMin > maxDistance)
+		return -1;
 
-	if (material->materialChannels == 0 || !material->extraChannels)
+	return tMin > 0 ? tMin : 0;
+}
+
+int rlmQueryBoundsTreeRay(const rlmBoundsTree* tree, Ray ray, float maxDistance, int* userIds, int maxResults)
+{
+	if (!tree || !userIds || tree->root == RLM_BOUNDS_TREE_NULL)
+		return 0;
+
+	Vector3 inverseDirection = { 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+
+	int stack[RLM_BOUNDS_TREE_STACK];
+	int stackSize = 0;
+	int count = 0;
+
+	stack[stackSize++] = tree->root;
+
+	while (stackSize > 0 && count < maxResults)
 	{
-		material->materialChannels = count;
-		material->extraChannels = (rlmMaterialChannel*)MemAlloc(sizeof(rlmMaterialChannel) * count);
+		const rlmBoundsTreeNode* node = &tree->nodes[stack[--stackSize]];
+		if (rlmGetRayBoxDistance(ray.position, inverseDirection, maxDistance, node->bounds) < 0)
+			continue;
+
+		if (node->child1 == RLM_BOUNDS_TREE_NULL)
+		{
+			userIds[count++] = node->userId;
+			continue;
+		}
+
+		if (stackSize + 2 > RLM_BOUNDS_TREE_STACK)
+		{
+			TraceLog(LOG_WARNING, "rlModels : bounds tree is too deep to query");
+			break;
+		}
+
+		stack[stackSize++] = node->child1;
+		stack[stackSize++] = node->child2;
 	}
-	else
+
+	return count;
+}
+
+static int* TreeVisibleIds = NULL;
+static rlmPQSTransorm* TreeVisibleTransforms = NULL;
+static Color* TreeVisibleTints = NULL;
+static int TreeVisibleCapacity = 0;
+
+static int rlmQueryBoundsTreeVisible(const rlmBoundsTree* tree)
+{
+	if (!tree || tree->leafCount <= 0)
+		return 0;
+
+	if (tree->leafCount > TreeVisibleCapacity)
 	{
-		material->materialChannels += count;
-		material->extraChannels = (rlmMaterialChannel*)MemRealloc(material->extraChannels, sizeof(rlmMaterialChannel) * material->materialChannels);
+		int capacity = TreeVisibleCapacity > 0 ? TreeVisibleCapacity : 256;
+		while (capacity < tree->leafCount)
+			capacity *= 2;
+
+		TreeVisibleIds = (int*)MemRealloc(TreeVisibleIds, capacity * sizeof(int));
+		TreeVisibleTransforms = (rlmPQSTransorm*)MemRealloc(TreeVisibleTransforms, capacity * sizeof(rlmPQSTransorm));
+		TreeVisibleTints = (Color*)MemRealloc(TreeVisibleTints, capacity * sizeof(Color));
+		TreeVisibleCapacity = capacity;
 	}
 
+	if (!TreeVisibleIds || !TreeVisibleTransforms || !TreeVisibleTints)
+		return 0;
+
+	rlmFrustum frustum = rlmGetCurrentFrustum();
+	int count = rlmQueryBoundsTreeFrustum(tree, &frustum, TreeVisibleIds, TreeVisibleCapacity);
+
+	CullingStats.modelsCulled += tree->leafCount - count;
+	return count;
+}
+
+int rlmDrawBoundsTreeModels(const rlmBoundsTree* tree, const rlmModel* models, const rlmPQSTransorm* transforms)
+{
+	if (!models || !transforms)
+		return 0;
+
+	int count = rlmQueryBoundsTreeVisible(tree);
+
+	// the meshes of the surviving models still get culled on their own, models can repeat so the LODs have no hysteresis
+	for (int i = 0; i < count; i++)
+		rlmDrawModelLOD(models[TreeVisibleIds[i]], transforms[TreeVisibleIds[i]], NULL, false, true);
+
+	return count;
+}
+
+int rlmDrawBoundsTreeInstanced(const rlmBoundsTree* tree, rlmModel model, const rlmPQSTransorm* transforms, const Color* tints)
+{
+	if (!transforms)
+		return 0;
+
+	int count = rlmQueryBoundsTreeVisible(tree);
+	if (count <= 0)
+		return 0;
+
 	for (int i = 0; i < count; i++)
 	{
-		int index = material->materialChannels - count + i;
+		TreeVisibleTransforms[i] = transforms[TreeVisibleIds[i]];
+		if (tints)
+			TreeVisibleTints[i] = tints[TreeVisibleIds[i]];
+	}
 
-		material->extraChannels[material->materialChannels - 1].cubeMap = false;
-		material->extraChannels[material->materialChannels - 1].ownsTexture = false;
+	// already culled by the tree
+	rlmDrawModelInstancedCulled(model, TreeVisibleTransforms, tints ? TreeVisibleTints : NULL, count, false);
 
-		material->extraChannels[material->materialChannels - 1].color = WHITE;
-		material->extraChannels[material->materialChannels - 1].colorLoc = -1;
+	CullingStats.modelsVisible += count;
+	return count;
+}
 
-		material->extraChannels[material->materialChannels - 1].textureSlot = -1;
+void rlmUnloadBoundsTreeResources()
+{
+	MemFree(TreeVisibleIds);
+	MemFree(TreeVisibleTransforms);
+	MemFree(TreeVisibleTints);
+
+	TreeVisibleIds = NULL;
+	TreeVisibleTransforms = NULL;
+	TreeVisibleTints = NULL;
+	TreeVisibleCapacity = 0;
+}
 
-		if (textures && locs)
+static rlmPQSTransorm rlmInvertBindingTransform(const rlmPQSTransorm* bindingTransform)
+{
+	rlmPQSTransorm inverse;
+	inverse.rotation = QuaternionInvert(bindingTransform->rotation);
+	inverse.position = Vector3RotateByQuaternion(Vector3Negate(bindingTransform->position), inverse.rotation);
+	inverse.scale = Vector3Divide((Vector3) { 1, 1, 1 }, bindingTransform->scale);
+
+	return inverse;
+}
+
+// builds the same matrix as scale * translation * rotation from the raymath helpers, without making and multiplying three matrices
+static Matrix rlmComposeBoneMatrix(Quaternion rotation, Vector3 translation, Vector3 scale)
+{
+	float xx = rotation.x * rotation.x, yy = rotation.y * rotation.y, zz = rotation.z * rotation.z;
+	float xy = rotation.x * rotation.y, xz = rotation.x * rotation.z, yz = rotation.y * rotation.z;
+	float wx = rotation.w * rotation.x, wy = rotation.w * rotation.y, wz = rotation.w * rotation.z;
+
+	Matrix result;
+	result.m0 = (1 - 2 * (yy + zz)) * scale.x;
+	result.m4 = 2 * (xy - wz) * scale.x;
+	result.m8 = 2 * (xz + wy) * scale.x;
+	result.m12 = translation.x * scale.x;
+
+	result.m1 = 2 * (xy + wz) * scale.y;
+	result.m5 = (1 - 2 * (xx + zz)) * scale.y;
+	result.m9 = 2 * (yz - wx) * scale.y;
+	result.m13 = translation.y * scale.y;
+
+	result.m2 = 2 * (xz - wy) * scale.z;
+	result.m6 = 2 * (yz + wx) * scale.z;
+	result.m10 = (1 - 2 * (xx + yy)) * scale.z;
+	result.m14 = translation.z * scale.z;
+
+	result.m3 = 0;
+	result.m7 = 0;
+	result.m11 = 0;
+	result.m15 = 1;
+
+	return result;
+}
+
+static Matrix rlmGetBoneMatrixFromInverse(const rlmPQSTransorm* inverseBindingTransform, const rlmPQSTransorm* frameTransform)
+{
+	Vector3 boneTranslation = Vector3Add(Vector3RotateByQuaternion(Vector3Multiply(frameTransform->scale, inverseBindingTransform->position), frameTransform->rotation), frameTransform->position);
+	Quaternion boneRotation = QuaternionMultiply(frameTransform->rotation, inverseBindingTransform->rotation);
+	Vector3 boneScale = Vector3Multiply(frameTransform->scale, inverseBindingTransform->scale);
+
+	return rlmComposeBoneMatrix(boneRotation, boneTranslation, boneScale);
+}
+
+#if defined(RLM_USE_SSE2)
+// SoA view of 4 transforms, one register per component
+typedef struct rlmPQSTransform4
+{
+	__m128 px, py, pz;
+	__m128 qx, qy, qz, qw;
+	__m128 sx, sy, sz;
+}rlmPQSTransform4;
+
+static rlmPQSTransform4 rlmLoadPQSTransform4(const rlmPQSTransorm* transforms, const int* boneIds, int index)
+{
+	const float* t0 = (const float*)(transforms + (boneIds ? boneIds[index + 0] : index + 0));
+	const float* t1 = (const float*)(transforms + (boneIds ? boneIds[index + 1] : index + 1));
+	const float* t2 = (const float*)(transforms + (boneIds ? boneIds[index + 2] : index + 2));
+	const float* t3 = (const float*)(transforms + (boneIds ? boneIds[index + 3] : index + 3));
+
+	rlmPQSTransform4 result;
+
+	// px py pz qx
+	__m128 r0 = _mm_loadu_ps(t0), r1 = _mm_loadu_ps(t1), r2 = _mm_loadu_ps(t2), r3 = _mm_loadu_ps(t3);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	result.px = r0; result.py = r1; result.pz = r2; result.qx = r3;
+
+	// qy qz qw sx
+	r0 = _mm_loadu_ps(t0 + 4); r1 = _mm_loadu_ps(t1 + 4); r2 = _mm_loadu_ps(t2 + 4); r3 = _mm_loadu_ps(t3 + 4);
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+	result.qy = r0; result.qz = r1; result.qw = r2; result.sx = r3;
+
+	result.sy = _mm_setr_ps(t0[8], t1[8], t2[8], t3[8]);
+	result.sz = _mm_setr_ps(t0[9], t1[9], t2[9], t3[9]);
+
+	return result;
+}
+
+// lerps 4 bones between two keyframes, then builds their bone matrices, matches rlmPQSLerp + rlmGetBoneMatrixFromInverse
+static void rlmLerpBoneMatrices4(const rlmPQSTransorm* inverseBind, const rlmPQSTransorm* frame1, const rlmPQSTransorm* frame2, __m128 param, const int* boneIds, int index, Matrix* output)
+{
+	rlmPQSTransform4 a = rlmLoadPQSTransform4(frame1, boneIds, index);
+	rlmPQSTransform4 b = rlmLoadPQSTransform4(frame2, boneIds, index);
+	rlmPQSTransform4 inv = rlmLoadPQSTransform4(inverseBind, boneIds, index);
+
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+
+	// position and scale are plain lerps
+	__m128 px = _mm_add_ps(a.px, _mm_mul_ps(param, _mm_sub_ps(b.px, a.px)));
+	__m128 py = _mm_add_ps(a.py, _mm_mul_ps(param, _mm_sub_ps(b.py, a.py)));
+	__m128 pz = _mm_add_ps(a.pz, _mm_mul_ps(param, _mm_sub_ps(b.pz, a.pz)));
+
+	__m128 sx = _mm_add_ps(a.sx, _mm_mul_ps(param, _mm_sub_ps(b.sx, a.sx)));
+	__m128 sy = _mm_add_ps(a.sy, _mm_mul_ps(param, _mm_sub_ps(b.sy, a.sy)));
+	__m128 sz = _mm_add_ps(a.sz, _mm_mul_ps(param, _mm_sub_ps(b.sz, a.sz)));
+
+	// take the short way around, same as QuaternionSlerp
+	__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.qx, b.qx), _mm_mul_ps(a.qy, b.qy)), _mm_add_ps(_mm_mul_ps(a.qz, b.qz), _mm_mul_ps(a.qw, b.qw)));
+	__m128 sign = _mm_and_ps(dot, _mm_set1_ps(-0.0f));
+	dot = _mm_xor_ps(dot, sign);
+
+	__m128 bqx = _mm_xor_ps(b.qx, sign), bqy = _mm_xor_ps(b.qy, sign), bqz = _mm_xor_ps(b.qz, sign), bqw = _mm_xor_ps(b.qw, sign);
+
+	// nlerp, then renormalize
+	__m128 qx = _mm_add_ps(a.qx, _mm_mul_ps(param, _mm_sub_ps(bqx, a.qx)));
+	__m128 qy = _mm_add_ps(a.qy, _mm_mul_ps(param, _mm_sub_ps(bqy, a.qy)));
+	__m128 qz = _mm_add_ps(a.qz, _mm_mul_ps(param, _mm_sub_ps(bqz, a.qz)));
+	__m128 qw = _mm_add_ps(a.qw, _mm_mul_ps(param, _mm_sub_ps(bqw, a.qw)));
+
+	__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, qx), _mm_mul_ps(qy, qy)), _mm_add_ps(_mm_mul_ps(qz, qz), _mm_mul_ps(qw, qw))));
+	__m128 invLength = _mm_div_ps(one, length);
+	qx = _mm_mul_ps(qx, invLength);
+	qy = _mm_mul_ps(qy, invLength);
+	qz = _mm_mul_ps(qz, invLength);
+	qw = _mm_mul_ps(qw, invLength);
+
+	// nlerp is only close enough to slerp for small angles, any lane past the raymath threshold gets a real slerp
+	int nlerpMask = _mm_movemask_ps(_mm_cmpgt_ps(dot, _mm_set1_ps(0.95f)));
+	if (nlerpMask != 0xF)
+	{
+		float lanes[4][4];
+		_mm_storeu_ps(lanes[0], qx);
+		_mm_storeu_ps(lanes[1], qy);
+		_mm_storeu_ps(lanes[2], qz);
+		_mm_storeu_ps(lanes[3], qw);
+
+		float t = _mm_cvtss_f32(param);
+
+		for (int lane = 0; lane < 4; lane++)
 		{
-			material->extraChannels[material->materialChannels - 1].textureId = textures[i].id;
-			material->extraChannels[material->materialChannels - 1].textureLoc = locs[i];
+			if (nlerpMask & (1 << lane))
+				continue;
+
+			int boneId = boneIds ? boneIds[index + lane] : index + lane;
+			Quaternion q = QuaternionSlerp(frame1[boneId].rotation, frame2[boneId].rotation, t);
+			lanes[0][lane] = q.x;
+			lanes[1][lane] = q.y;
+			lanes[2][lane] = q.z;
+			lanes[3][lane] = q.w;
 		}
-		else
+
+		qx = _mm_loadu_ps(lanes[0]);
+		qy = _mm_loadu_ps(lanes[1]);
+		qz = _mm_loadu_ps(lanes[2]);
+		qw = _mm_loadu_ps(lanes[3]);
+	}
+
+	// bone translation, the inverse binding offset scaled and rotated into the frame, see Vector3RotateByQuaternion
+	__m128 vx = _mm_mul_ps(sx, inv.px);
+	__m128 vy = _mm_mul_ps(sy, inv.py);
+	__m128 vz = _mm_mul_ps(sz, inv.pz);
+
+	__m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz), ww = _mm_mul_ps(qw, qw);
+	__m128 xy = _mm_mul_ps(two, _mm_mul_ps(qx, qy)), xz = _mm_mul_ps(two, _mm_mul_ps(qx, qz)), yz = _mm_mul_ps(two, _mm_mul_ps(qy, qz));
+	__m128 wx = _mm_mul_ps(two, _mm_mul_ps(qw, qx)), wy = _mm_mul_ps(two, _mm_mul_ps(qw, qy)), wz = _mm_mul_ps(two, _mm_mul_ps(qw, qz));
+
+	__m128 tx = _mm_add_ps(px, _mm_add_ps(_mm_add_ps(
+		_mm_mul_ps(vx, _mm_sub_ps(_mm_add_ps(xx, ww), _mm_add_ps(yy, zz))),
+		_mm_mul_ps(vy, _mm_sub_ps(xy, wz))),
+		_mm_mul_ps(vz, _mm_add_ps(xz, wy))));
+	__m128 ty = _mm_add_ps(py, _mm_add_ps(_mm_add_ps(
+		_mm_mul_ps(vx, _mm_add_ps(wz, xy)),
+		_mm_mul_ps(vy, _mm_sub_ps(_mm_add_ps(ww, yy), _mm_add_ps(xx, zz)))),
+		_mm_mul_ps(vz, _mm_sub_ps(yz, wx))));
+	__m128 tz = _mm_add_ps(pz, _mm_add_ps(_mm_add_ps(
+		_mm_mul_ps(vx, _mm_sub_ps(xz, wy)),
+		_mm_mul_ps(vy, _mm_add_ps(wx, yz))),
+		_mm_mul_ps(vz, _mm_sub_ps(_mm_add_ps(ww, zz), _mm_add_ps(xx, yy)))));
+
+	// bone rotation, frame rotation * inverse binding rotation, see QuaternionMultiply
+	__m128 rx = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, inv.qw), _mm_mul_ps(qw, inv.qx)), _mm_mul_ps(qy, inv.qz)), _mm_mul_ps(qz, inv.qy));
+	__m128 ry = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(qy, inv.qw), _mm_mul_ps(qw, inv.qy)), _mm_mul_ps(qz, inv.qx)), _mm_mul_ps(qx, inv.qz));
+	__m128 rz = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(qz, inv.qw), _mm_mul_ps(qw, inv.qz)), _mm_mul_ps(qx, inv.qy)), _mm_mul_ps(qy, inv.qx));
+	__m128 rw = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(qw, inv.qw), _mm_mul_ps(qx, inv.qx)), _mm_mul_ps(qy, inv.qy)), _mm_mul_ps(qz, inv.qz));
+
+	// bone scale
+	sx = _mm_mul_ps(sx, inv.sx);
+	sy = _mm_mul_ps(sy, inv.sy);
+	sz = _mm_mul_ps(sz, inv.sz);
+
+	// matrix rows, see rlmComposeBoneMatrix
+	xx = _mm_mul_ps(rx, rx); yy = _mm_mul_ps(ry, ry); zz = _mm_mul_ps(rz, rz);
+	xy = _mm_mul_ps(rx, ry); xz = _mm_mul_ps(rx, rz); yz = _mm_mul_ps(ry, rz);
+	wx = _mm_mul_ps(rw, rx); wy = _mm_mul_ps(rw, ry); wz = _mm_mul_ps(rw, rz);
+
+	__m128 m0 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+	__m128 m4 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sx);
+	__m128 m8 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sx);
+	__m128 m12 = _mm_mul_ps(tx, sx);
+
+	__m128 m1 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sy);
+	__m128 m5 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+	__m128 m9 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sy);
+	__m128 m13 = _mm_mul_ps(ty, sy);
+
+	__m128 m2 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sz);
+	__m128 m6 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sz);
+	__m128 m10 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+	__m128 m14 = _mm_mul_ps(tz, sz);
+
+	// back to one matrix per bone, the Matrix struct stores m0 m4 m8 m12 first
+	_MM_TRANSPOSE4_PS(m0, m4, m8, m12);
+	_MM_TRANSPOSE4_PS(m1, m5, m9, m13);
+	_MM_TRANSPOSE4_PS(m2, m6, m10, m14);
+
+	const __m128 lastRow = _mm_setr_ps(0, 0, 0, 1);
+	__m128 rows[4][3] = { { m0, m1, m2 }, { m4, m5, m6 }, { m8, m9, m10 }, { m12, m13, m14 } };
+
+	for (int lane = 0; lane < 4; lane++)
+	{
+		float* dest = (float*)(output + (boneIds ? boneIds[index + lane] : index + lane));
+		_mm_storeu_ps(dest + 0, rows[lane][0]);
+		_mm_storeu_ps(dest + 4, rows[lane][1]);
+		_mm_storeu_ps(dest + 8, rows[lane][2]);
+		_mm_storeu_ps(dest + 12, lastRow);
+	}
+}
+#endif
+
+// lerps a list of bones between two keyframes into bone matrices, 4 at a time when SIMD is available
+static void rlmLerpBoneMatrices(const rlmPQSTransorm* inverseBind, const rlmPQSTransorm* frame1, const rlmPQSTransorm* frame2, float param, const int* boneIds, int count, Matrix* output)
+{
+	int index = 0;
+
+#if defined(RLM_USE_SSE2)
+	if (UseSIMDAnimation)
+	{
+		__m128 simdParam = _mm_set1_ps(param);
+		for (; index + 4 <= count; index += 4)
+			rlmLerpBoneMatrices4(inverseBind, frame1, frame2, simdParam, boneIds, index, output);
+	}
+#endif
+
+	for (; index < count; index++)
+	{
+		int boneId = boneIds ? boneIds[index] : index;
+		rlmPQSTransorm lerpedTransform = rlmPQSLerp(&frame1[boneId], &frame2[boneId], param);
+		output[boneId] = rlmGetBoneMatrixFromInverse(&inverseBind[boneId], &lerpedTransform);
+	}
+}
+
+Matrix rlmGetBoneMatrix(const rlmPQSTransorm* bindingTransform, const rlmPQSTransorm* frameTransform)
+{
+	rlmPQSTransorm inverseBindingTransform = rlmInvertBindingTransform(bindingTransform);
+	return rlmGetBoneMatrixFromInverse(&inverseBindingTransform, frameTransform);
+}
+
+// FNV-1a
+static unsigned int rlmHashBoneName(const char* name)
+{
+	unsigned int hash = 2166136261u;
+	for (int i = 0; i < 32 && name[i] != '\0'; i++)
+	{
+		hash ^= (unsigned char)name[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+void rlmCompileSkeleton(rlmSkeleton* skeleton)
+{
+	if (!skeleton || skeleton->boneCount <= 0)
+		return;
+
+	MemFree(skeleton->boneOrder);
+	MemFree(skeleton->slotParents);
+	MemFree(skeleton->slotSubtreeEnds);
+	MemFree(skeleton->boneSlots);
+	MemFree(skeleton->slotDepths);
+	MemFree(skeleton->depthSortedBones);
+	MemFree(skeleton->depthBoneCounts);
+	MemFree(skeleton->boneNameHash);
+	MemFree(skeleton->inverseBindingFrame.boneTransforms);
+
+	// the binding pose never changes, so invert it once here instead of for every bone of every pose
+	skeleton->inverseBindingFrame.boneTransforms = (rlmPQSTransorm*)MemAlloc(sizeof(rlmPQSTransorm) * skeleton->boneCount);
+	for (int i = 0; i < skeleton->boneCount; i++)
+		skeleton->inverseBindingFrame.boneTransforms[i] = rlmInvertBindingTransform(&skeleton->bindingFrame.boneTransforms[i]);
+
+	skeleton->boneOrder = (int*)MemAlloc(sizeof(int) * skeleton->boneCount);
+	skeleton->slotParents = (int*)MemAlloc(sizeof(int) * skeleton->boneCount);
+	skeleton->slotSubtreeEnds = (int*)MemAlloc(sizeof(int) * skeleton->boneCount);
+	skeleton->boneSlots = (int*)MemAlloc(sizeof(int) * skeleton->boneCount);
+
+	for (int i = 0; i < skeleton->boneCount; i++)
+		skeleton->boneSlots[i] = -1;
+
+	// depth first walk with an explicit stack, so every subtree ends up as a contiguous range of slots
+	int* stack = (int*)MemAlloc(sizeof(int) * skeleton->boneCount);
+	int slot = 0;
+
+	for (int root = 0; root < skeleton->boneCount; root++)
+	{
+		if (skeleton->bones[root].parentId >= 0)
+			continue;
+
+		int stackSize = 0;
+		stack[stackSize++] = root;
+
+		while (stackSize > 0)
 		{
-			material->extraChannels[material->materialChannels - 1].textureId = 0;
-			material->extraChannels[material->materialChannels - 1].textureLoc = -1;
+			const rlmBoneInfo* bone = &skeleton->bones[stack[--stackSize]];
+
+			skeleton->boneOrder[slot] = bone->boneId;
+			skeleton->boneSlots[bone->boneId] = slot;
+			skeleton->slotParents[slot] = bone->parentId >= 0 ? skeleton->boneSlots[bone->parentId] : -1;
+			slot++;
+
+			// push in reverse so children come out in their original order
+			for (int i = bone->childCount - 1; i >= 0; i--)
+				stack[stackSize++] = bone->childBones[i]->boneId;
+		}
+	}
+
+	MemFree(stack);
+
+	if (slot != skeleton->boneCount)
+		TraceLog(LOG_WARNING, "rlModels : %d bones are not reachable from a root bone", skeleton->boneCount - slot);
+
+	// anything not reachable from a root is still evaluated, as it's own single bone subtree
+	for (int i = 0; i < skeleton->boneCount && slot < skeleton->boneCount; i++)
+	{
+		if (skeleton->boneSlots[i] >= 0)
+			continue;
+
+		skeleton->boneOrder[slot] = i;
+		skeleton->boneSlots[i] = slot;
+		skeleton->slotParents[slot] = -1;
+		slot++;
+	}
+
+	// children always come after their parents, so walking backwards closes every subtree before it's parent
+	for (int i = 0; i < skeleton->boneCount; i++)
+		skeleton->slotSubtreeEnds[i] = i + 1;
+
+	for (int i = skeleton->boneCount - 1; i >= 0; i--)
+	{
+		int parent = skeleton->slotParents[i];
+		if (parent >= 0 && skeleton->slotSubtreeEnds[i] > skeleton->slotSubtreeEnds[parent])
+			skeleton->slotSubtreeEnds[parent] = skeleton->slotSubtreeEnds[i];
+	}
+
+	// depths, parents are always done first
+	skeleton->slotDepths = (int*)MemAlloc(sizeof(int) * skeleton->boneCount);
+	skeleton->maxBoneDepth = 0;
+	for (int i = 0; i < skeleton->boneCount; i++)
+	{
+		int parent = skeleton->slotParents[i];
+		skeleton->slotDepths[i] = parent >= 0 ? skeleton->slotDepths[parent] + 1 : 0;
+		if (skeleton->slotDepths[i] > skeleton->maxBoneDepth)
+			skeleton->maxBoneDepth = skeleton->slotDepths[i];
+	}
+
+	skeleton->depthBoneCounts = (int*)MemAlloc(sizeof(int) * (skeleton->maxBoneDepth + 1));
+	skeleton->depthSortedBones = (int*)MemAlloc(sizeof(int) * skeleton->boneCount);
+
+	int sortedCount = 0;
+	for (int depth = 0; depth <= skeleton->maxBoneDepth; depth++)
+	{
+		for (int i = 0; i < skeleton->boneCount; i++)
+		{
+			if (skeleton->slotDepths[i] == depth)
+				skeleton->depthSortedBones[sortedCount++] = skeleton->boneOrder[i];
 		}
+		skeleton->depthBoneCounts[depth] = sortedCount;
+	}
+
+	// name index, at most half full
+	skeleton->boneNameHashSize = 16;
+	while (skeleton->boneNameHashSize < skeleton->boneCount * 2)
+		skeleton->boneNameHashSize *= 2;
+
+	skeleton->boneNameHash = (int*)MemAlloc(sizeof(int) * skeleton->boneNameHashSize);
+	for (int i = 0; i < skeleton->boneNameHashSize; i++)
+		skeleton->boneNameHash[i] = -1;
+
+	int hashMask = skeleton->boneNameHashSize - 1;
+	for (int boneId = 0; boneId < skeleton->boneCount; boneId++)
+	{
+		// the first bone with a name wins, same as a linear search would
+		int index = rlmHashBoneName(skeleton->bones[boneId].name) & hashMask;
+		bool duplicate = false;
+		while (skeleton->boneNameHash[index] >= 0 && !duplicate)
+		{
+			duplicate = TextIsEqual(skeleton->bones[skeleton->boneNameHash[index]].name, skeleton->bones[boneId].name);
+			index = (index + 1) & hashMask;
+		}
+
+		if (!duplicate)
+			skeleton->boneNameHash[index] = boneId;
 	}
 }
 
-int rlmAddMaterialValue(rlmMaterialDef* material, int shaderLoc, float value)
+// skeletons built or edited by hand are compiled the first time a pose needs them
+static void rlmCheckSkeletonCompiled(rlmSkeleton* skeleton)
 {
-	if (!material)
-		return -1;
+	if (skeleton && skeleton->boneCount > 0 && skeleton->inverseBindingFrame.boneTransforms == NULL)
+		rlmCompileSkeleton(skeleton);
+}
 
-	int index = 0;
-	if (!material->values || material->materialValues == 0)
+static void rlmGetBoneSlotRange(const rlmSkeleton* skeleton, const rlmBoneInfo* startBone, int* startSlot, int* endSlot)
+{
+	*startSlot = 0;
+	*endSlot = skeleton->boneCount;
+
+	if (!startBone || !skeleton->boneSlots)
+		return;
+
+	*startSlot = skeleton->boneSlots[startBone->boneId];
+	*endSlot = skeleton->slotSubtreeEnds[*startSlot];
+}
+
+static void rlmSetBonePoseRange(const rlmSkeleton* skeleton, const rlmAnimationKeyframe* keyframe, int startSlot, int endSlot, rlmModelAnimationPose* pose)
+{
+	const rlmPQSTransorm* inverseBindTransforms = skeleton->inverseBindingFrame.boneTransforms;
+	const rlmPQSTransorm* frameTransforms = keyframe->boneTransforms;
+
+	// the whole skeleton does not care about order, so just walk the bone data linearly
+	if (startSlot == 0 && endSlot == skeleton->boneCount)
 	{
-		material->values = (rlmMaterialValueF*)MemAlloc(sizeof(rlmMaterialValueF));
-		material->materialValues = 1;
+		for (int boneId = 0; boneId < skeleton->boneCount; boneId++)
+			pose->boneMatricies[boneId] = rlmGetBoneMatrixFromInverse(&inverseBindTransforms[boneId], &frameTransforms[boneId]);
+		return;
 	}
-	else
+
+	for (int slot = startSlot; slot < endSlot; slot++)
 	{
-		index = material->materialValues;
-		material->materialValues++;
-		material->values = (rlmMaterialValueF*)MemRealloc(material->values, sizeof(rlmMaterialValueF) * material->materialValues);
+		int boneId = skeleton->boneOrder[slot];
+		pose->boneMatricies[boneId] = rlmGetBoneMatrixFromInverse(&inverseBindTransforms[boneId], &frameTransforms[boneId]);
 	}
+}
 
-	material->values[index].shaderLoc = shaderLoc;
-	material->values[index].value = value;
+static void rlmSetBonePoseRangeLerp(const rlmSkeleton* skeleton, const rlmAnimationKeyframe* keyframe1, const rlmAnimationKeyframe* keyframe2, float param, int startSlot, int endSlot, rlmModelAnimationPose* pose)
+{
+	// the whole skeleton does not care about order, so just walk the bone data linearly
+	const int* boneIds = NULL;
+	if (startSlot != 0 || endSlot != skeleton->boneCount)
+		boneIds = skeleton->boneOrder + startSlot;
 
-	return index;
+	rlmLerpBoneMatrices(skeleton->inverseBindingFrame.boneTransforms, keyframe1->boneTransforms, keyframe2->boneTransforms, param, boneIds, endSlot - startSlot, pose->boneMatricies);
 }
 
-void rlmSetMaterialValue(rlmMaterialDef* material, int valueIndex, float value)
+rlmModelAnimationPose rlmLoadPoseFromModel(rlmModel model)
 {
-	if (!material || valueIndex >= material->materialValues)
+	rlmModelAnimationPose pose = { 0 };
+
+	if (model.skeleton)
+	{
+		pose.boneMatricies = (Matrix*)MemAlloc(sizeof(Matrix) * model.skeleton->boneCount);
+
+		for (int i = 0; i < model.skeleton->boneCount; i++)
+			pose.boneMatricies[i] = MatrixIdentity();
+	}
+	return pose;
+}
+
+void rlmUnloadPose(rlmModelAnimationPose* pose)
+{
+	if (!pose)
 		return;
 
-	material->values[valueIndex].value = value;
+	MemFree(pose->boneMatricies);
+	pose->boneMatricies = NULL;
 }
 
-void rlmSetMaterialDefShader(rlmMaterialDef* material, Shader shader)
+void rlmSetPoseToKeyframe(rlmModel model, rlmModelAnimationPose* pose, rlmAnimationKeyframe frame)
 {
-	if (!material)
+	if (!model.skeleton)
 		return;
 
-	material->shader = shader;
-	material->ownsShader = false;
+	rlmCheckSkeletonCompiled(model.skeleton);
+
+	rlmSetBonePoseRange(model.skeleton, &frame, 0, model.skeleton->boneCount, pose);
 }
 
-void rlmSetMaterialChannelTexture(rlmMaterialChannel* channel, Texture2D texture)
+void rlmSetPoseToKeyframeEx(rlmModel model, rlmModelAnimationPose* pose, rlmAnimationKeyframe frame, rlmBoneInfo* startBone)
 {
-	if (!channel)
+	if (!model.skeleton)
 		return;
 
-	channel->ownsTexture = false;
-	channel->textureId = texture.id;
+	rlmCheckSkeletonCompiled(model.skeleton);
+
+	int startSlot, endSlot;
+	rlmGetBoneSlotRange(model.skeleton, startBone, &startSlot, &endSlot);
+
+	rlmSetBonePoseRange(model.skeleton, &frame, startSlot, endSlot, pose);
 }
 
-void rlmCloneMaterial(const rlmMaterialDef* oldMaterial, rlmMaterialDef* newMaterial)
+void rlmSetPoseToKeyframesLerp(rlmModel model, rlmModelAnimationPose* pose, rlmAnimationKeyframe frame1, rlmAnimationKeyframe frame2, float param)
 {
-	if (!oldMaterial || !newMaterial)
+	if (!model.skeleton)
 		return;
 
-	newMaterial->name = (char*)MemAlloc(32);
-	newMaterial->name[0] = '\0';
+	rlmCheckSkeletonCompiled(model.skeleton);
 
-	strcpy(newMaterial->name, oldMaterial->name);
-	newMaterial->baseChannel = oldMaterial->baseChannel;
-	newMaterial->baseChannel.ownsTexture = false;
+	rlmSetBonePoseRangeLerp(model.skeleton, &frame1, &frame2, param, 0, model.skeleton->boneCount, pose);
+}
+
+void rlmSetPoseToKeyframesLerpEx(rlmModel model, rlmModelAnimationPose* pose, rlmAnimationKeyframe frame1, rlmAnimationKeyframe frame2, float param, rlmBoneInfo* startBone)
+{
+	if (!model.skeleton)
+		return;
+
+	rlmCheckSkeletonCompiled(model.skeleton);
+
+	int startSlot, endSlot;
+	rlmGetBoneSlotRange(model.skeleton, startBone, &startSlot, &endSlot);
 
-	newMaterial->shader = oldMaterial->shader;
-	newMaterial->ownsShader = false;
+	rlmSetBonePoseRangeLerp(model.skeleton, &frame1, &frame2, param, startSlot, endSlot, pose);
+}
 
-	newMaterial->materialChannels = oldMaterial->materialChannels;
+int rlmFindBoneIdByName(rlmModel model, const char* boneName)
+{
+	if (!model.skeleton || !boneName)
+		return -1;
 
-	if (newMaterial->materialChannels > 0 && oldMaterial->extraChannels)
-	{
-		newMaterial->extraChannels = (rlmMaterialChannel*)MemAlloc(sizeof(rlmMaterialChannel) * newMaterial->materialChannels);
+	const rlmSkeleton* skeleton = model.skeleton;
 
-		for (int i = 0; i < newMaterial->materialChannels; i++)
+	// skeletons that were never compiled have no index
+	if (!skeleton->boneNameHash)
+	{
+		for (int i = 0; i < skeleton->boneCount; i++)
 		{
-			newMaterial->extraChannels[i] = oldMaterial->extraChannels[i];
-			newMaterial->extraChannels[i].ownsTexture = false;
+			if (TextIsEqual(skeleton->bones[i].name, boneName))
+				return i;
 		}
+		return -1;
 	}
 
-	newMaterial->materialValues = oldMaterial->materialValues;
-
-	if (newMaterial->materialValues > 0 && oldMaterial->materialValues)
+	int hashMask = skeleton->boneNameHashSize - 1;
+	int index = rlmHashBoneName(boneName) & hashMask;
+	while (skeleton->boneNameHash[index] >= 0)
 	{
-		newMaterial->values = (rlmMaterialValueF*)MemAlloc(sizeof(rlmMaterialValueF) * newMaterial->materialValues);
+		int boneId = skeleton->boneNameHash[index];
+		if (TextIsEqual(skeleton->bones[boneId].name, boneName))
+			return boneId;
 
-		for (int i = 0; i < newMaterial->materialValues; i++)
-		{
-			newMaterial->values[i].shaderLoc = oldMaterial->values[i].shaderLoc;
-			newMaterial->values[i].value = oldMaterial->values[i].value;
-		}
+		index = (index + 1) & hashMask;
 	}
+	return -1;
 }
 
-rlmModel rlmCloneModel(rlmModel model)
+rlmBoneInfo* rlmFindBoneByName(rlmModel model, const char* boneName)
 {
-	rlmModel newModel;
+	int boneId = rlmFindBoneIdByName(model, boneName);
+	if (boneId < 0)
+		return NULL;
 
-	newModel.orientationTransform = model.orientationTransform;
+	return &model.skeleton->bones[boneId];
+}
 
-	newModel.groupCount = model.groupCount;
+void rlmLoadSequenceKeyframes(rlmModelAniamtionSequence* sequence, int keyframeCount, int boneCount)
+{
+	if (!sequence || keyframeCount <= 0 || boneCount <= 0)
+		return;
 
-	newModel.skeleton = model.skeleton;
-	newModel.ownsSkeleton = false;
+	sequence->keyframeCount = keyframeCount;
+	sequence->boneCount = boneCount;
 
-	newModel.groups = (rlmModelGroup*)MemAlloc(sizeof(rlmModelGroup) * newModel.groupCount);
-	for (int group = 0; group < newModel.groupCount; group++)
+	// every keyframe is a view into one block, so neighboring frames are next to each other in memory
+	sequence->transformData = (rlmPQSTransorm*)MemAlloc(sizeof(rlmPQSTransorm) * keyframeCount * boneCount);
+	sequence->keyframes = (rlmAnimationKeyframe*)MemAlloc(sizeof(rlmAnimationKeyframe) * keyframeCount);
+
+	for (int i = 0; i < keyframeCount; i++)
 	{
-		rlmModelGroup* newGroup = newModel.groups + group;
-		const rlmModelGroup* oldGroup = model.groups + group;
+		sequence->keyframes[i].boneTransforms = sequence->transformData + (i * boneCount);
+		sequence->keyframes[i].isView = true;
+	}
+}
 
-		rlmCloneMaterial(&oldGroup->material, &newGroup->material);
+static void rlmUnloadSequenceKeyframes(rlmModelAniamtionSequence* sequence)
+{
+	// sequences built by hand may still own each keyframe
+	if (!sequence->transformData && sequence->keyframes)
+	{
+		for (int i = 0; i < sequence->keyframeCount; i++)
+			rlmUnloadAnimationKeyframe(sequence->keyframes + i);
+	}
 
-		newGroup->ownsMeshes = false;
-		newGroup->ownsMeshList = false;
+	MemFree(sequence->transformData);
+	sequence->transformData = NULL;
 
-		newGroup->meshDisableFlags = (bool*)MemAlloc(sizeof(bool) * oldGroup->meshCount);
-		for (int i = 0; i < oldGroup->meshCount; i++)
-			newGroup->meshDisableFlags[i] = oldGroup->meshDisableFlags[i];
+	MemFree(sequence->keyframes);
+	sequence->keyframes = NULL;
+}
 
-		newGroup->meshCount = oldGroup->meshCount;
-		newGroup->meshes = oldGroup->meshes;
-	}
+// compressed sequences
+#define COMPRESSED_TRACK_POSITION 0
+#define COMPRESSED_TRACK_ROTATION 1
+#define COMPRESSED_TRACK_SCALE 2
 
-	return newModel;
-}
+#define QUANTIZE_MAX 65535.0f
+#define SMALLEST_THREE_MAX 32767.0f
+#define SMALLEST_THREE_RANGE 0.70710678f	// the 3 smallest components of a unit quaternion are within +-1/sqrt(2)
 
-void rlmSetModelShader(rlmModel* model, Shader shader)
+static void rlmQuantizeVector3(Vector3 value, Vector3 rangeMin, Vector3 rangeSize, unsigned short* output)
 {
-	for (int group = 0; group < model->groupCount; group++)
-	{
-		rlmModelGroup* groupPtr = model->groups + group;
+	const float* v = (const float*)&value;
+	const float* min = (const float*)&rangeMin;
+	const float* size = (const float*)&rangeSize;
 
-		groupPtr->material.shader = shader;
-		groupPtr->material.ownsShader = false;
+	for (int i = 0; i < 3; i++)
+	{
+		float normalized = size[i] > 0 ? (v[i] - min[i]) / size[i] : 0;
+		normalized = Clamp(normalized, 0.0f, 1.0f);
+		output[i] = (unsigned short)(normalized * QUANTIZE_MAX + 0.5f);
 	}
 }
 
-void rlmUnloadModel(rlmModel* model)
+static Vector3 rlmDequantizeVector3(const unsigned short* input, Vector3 rangeMin, Vector3 rangeSize)
 {
-	if (!model)
-		return;
+	Vector3 result;
+	result.x = rangeMin.x + (input[0] / QUANTIZE_MAX) * rangeSize.x;
+	result.y = rangeMin.y + (input[1] / QUANTIZE_MAX) * rangeSize.y;
+	result.z = rangeMin.z + (input[2] / QUANTIZE_MAX) * rangeSize.z;
+	return result;
+}
 
-	for (int group = 0; group < model->groupCount; group++)
+// smallest three, the largest component is dropped and rebuilt from the unit length,
+// the other 3 get 15 bits each and the index of the dropped one goes in the top bits of the first two values
+static void rlmQuantizeQuaternion(Quaternion rotation, unsigned short* output)
+{
+	rotation = QuaternionNormalize(rotation);
+	float* q = (float*)&rotation;
+
+	int largest = 0;
+	for (int i = 1; i < 4; i++)
 	{
-		rlmModelGroup* groupPtr = model->groups + group;
+		if (fabsf(q[i]) > fabsf(q[largest]))
+			largest = i;
+	}
 
-		rlmUnloadMaterial(&groupPtr->material);
+	// q and -q are the same rotation, so keep the dropped component positive
+	float sign = q[largest] < 0 ? -1.0f : 1.0f;
 
-		if (groupPtr->ownsMeshes)
-		{
-			for (int i = 0; i < groupPtr->meshCount; i++)
-				rlmUnloadMesh(groupPtr->meshes + i);
-		}
+	int outIndex = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		if (i == largest)
+			continue;
 
-		if (groupPtr->ownsMeshList)
-			MemFree(groupPtr->meshes);
+		float normalized = Clamp((q[i] * sign / SMALLEST_THREE_RANGE) * 0.5f + 0.5f, 0.0f, 1.0f);
+		output[outIndex++] = (unsigned short)(normalized * SMALLEST_THREE_MAX + 0.5f);
+	}
 
-		MemFree(groupPtr->meshDisableFlags);
+	output[0] |= (unsigned short)((largest & 1) << 15);
+	output[1] |= (unsigned short)((largest >> 1) << 15);
+}
 
-		groupPtr->meshDisableFlags = NULL;
-		groupPtr->meshCount = 0;
-		groupPtr->meshes = 0;
-	}
+static Quaternion rlmDequantizeQuaternion(const unsigned short* input)
+{
+	int largest = (input[0] >> 15) | ((input[1] >> 15) << 1);
 
-	model->groupCount = 0;
-	MemFree(model->groups);
-	model->groups = NULL;
+	Quaternion rotation;
+	float* q = (float*)&rotation;
 
-	if (model->ownsSkeleton && model->skeleton)
+	float sumSquares = 0;
+	int inIndex = 0;
+	for (int i = 0; i < 4; i++)
 	{
-		MemFree(model->skeleton->bones);
-		model->skeleton->bones = NULL;
-		MemFree(model->skeleton->bindingFrame.boneTransforms);
-		model->skeleton->bindingFrame.boneTransforms = NULL;
+		if (i == largest)
+			continue;
 
-		MemFree(model->skeleton);
+		float normalized = (input[inIndex++] & 0x7FFF) / SMALLEST_THREE_MAX;
+		q[i] = (normalized * 2.0f - 1.0f) * SMALLEST_THREE_RANGE;
+		sumSquares += q[i] * q[i];
 	}
 
-	model->ownsSkeleton = false;
-	model->skeleton = NULL;
+	q[largest] = sqrtf(fmaxf(0.0f, 1.0f - sumSquares));
+
+	return rotation;
 }
 
-void rlmApplyMaterialChannel(rlmMaterialChannel* channel, Shader* shader, int index)
+static Quaternion rlmQuaternionNlerpShortest(Quaternion q1, Quaternion q2, float param)
 {
-	if (!channel)
-		return;
+	if (q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w < 0)
+		q2 = QuaternionScale(q2, -1);
 
-	rlActiveTextureSlot(channel->textureSlot);
-	if (channel->cubeMap)
-		rlEnableTextureCubemap(channel->textureId);
-	else
-		rlEnableTexture(channel->textureId);
-	rlSetUniform(channel->textureLoc, &channel->textureSlot, SHADER_UNIFORM_INT, 1);
+	return QuaternionNlerp(q1, q2, param);
+}
 
-	int locToUse = channel->colorLoc;
-	if (locToUse < 0)
-		locToUse = shader->locs[locToUse * -1];
+// finds the key at or before the frame, keys always start at frame 0 and end on the last frame
+static int rlmFindCompressedKey(const unsigned short* keyFrames, int keyCount, int frame)
+{
+	int low = 0;
+	int high = keyCount - 1;
 
-	// if (locToUse > 0)
+	while (low < high)
 	{
-		float values[4] = {
-			   (float)channel->color.r / 255.0f,
-			   (float)channel->color.g / 255.0f,
-			   (float)channel->color.b / 255.0f,
-			   (float)channel->color.a / 255.0f
-		};
-		rlSetUniform(locToUse, values, SHADER_UNIFORM_VEC4, 1);
+		int mid = (low + high + 1) / 2;
+		if (keyFrames[mid] <= frame)
+			low = mid;
+		else
+			high = mid - 1;
 	}
-}
-
-void rlmResetMaterialChannel(rlmMaterialChannel* channel)
-{
-	if (!channel)
-		return;
 
-	rlActiveTextureSlot(channel->textureSlot);
-	if (channel->cubeMap)
-		rlDisableTextureCubemap();
-	else
-		rlDisableTexture();
+	return low;
 }
 
-void rlmApplyMaterialDef(rlmMaterialDef* material)
+static Vector3 rlmDecodeCompressedVector3(const rlmCompressedSequence* sequence, const rlmCompressedTrack* track, int frame)
 {
-	if (!material)
-		return;
+	if (track->keyCount == 0)
+		return track->rangeMin;
 
-	rlEnableShader(material->shader.id);
+	const unsigned short* keyFrames = sequence->keyFrames + track->keyOffset;
+	const unsigned short* keyData = sequence->keyData + (track->keyOffset * 3);
 
-	int index = 0;
+	int key = rlmFindCompressedKey(keyFrames, track->keyCount, frame);
 
-	rlmApplyMaterialChannel(&material->baseChannel, &material->shader, 0);
+	Vector3 value = rlmDequantizeVector3(keyData + (key * 3), track->rangeMin, track->rangeSize);
+	if (key + 1 >= track->keyCount || keyFrames[key] == frame)
+		return value;
 
-	for (index = 1; index < material->materialChannels + 1; index++)
-		rlmApplyMaterialChannel(&material->extraChannels[index - 1], &material->shader, 0);
+	Vector3 nextValue = rlmDequantizeVector3(keyData + ((key + 1) * 3), track->rangeMin, track->rangeSize);
+	float param = (float)(frame - keyFrames[key]) / (float)(keyFrames[key + 1] - keyFrames[key]);
 
-	for (int i = 0; i < material->materialValues; i++)
-		SetShaderValue(material->shader, material->values[i].shaderLoc, &material->values[i].value, SHADER_UNIFORM_FLOAT);
+	return Vector3Lerp(value, nextValue, param);
 }
 
-void rlmResetMaterialDef(rlmMaterialDef* material)
+static Quaternion rlmDecodeCompressedQuaternion(const rlmCompressedSequence* sequence, const rlmCompressedTrack* track, int frame)
 {
-	if (!material)
-		return;
+	const unsigned short* keyFrames = sequence->keyFrames + track->keyOffset;
+	const unsigned short* keyData = sequence->keyData + (track->keyOffset * 3);
 
-	int index = 0;
-	rlmResetMaterialChannel(&material->baseChannel);
+	int key = rlmFindCompressedKey(keyFrames, track->keyCount, frame);
 
-	for (index = 1; index < material->materialChannels + 1; index++)
-		rlmResetMaterialChannel(&material->extraChannels[index - 1]);
+	Quaternion value = rlmDequantizeQuaternion(keyData + (key * 3));
+	if (key + 1 >= track->keyCount || keyFrames[key] == frame)
+		return value;
+
+	Quaternion nextValue = rlmDequantizeQuaternion(keyData + ((key + 1) * 3));
+	float param = (float)(frame - keyFrames[key]) / (float)(keyFrames[key + 1] - keyFrames[key]);
+
+	return rlmQuaternionNlerpShortest(value, nextValue, param);
 }
 
-Matrix rlmPQSToMatrix(const rlmPQSTransorm* transform)
+rlmPQSTransorm rlmDecodeCompressedTransform(const rlmCompressedSequence* sequence, int boneId, int frame)
 {
-	Matrix matScale = MatrixScale(transform->scale.x, transform->scale.y, transform->scale.z);
+	if (!sequence || boneId < 0 || boneId >= sequence->boneCount)
+		return rlmPQSIdentity();
 
-	Vector3 axis = { 0 };
-	float angle = 0;
+	const rlmCompressedTrack* tracks = sequence->tracks + (boneId * 3);
 
-	QuaternionToAxisAngle(transform->rotation, &axis, &angle);
-	Matrix matRotation = MatrixRotate(axis, angle);
-	Matrix matTranslation = MatrixTranslate(transform->position.x, transform->position.y, transform->position.z);
+	rlmPQSTransorm transform;
+	transform.position = rlmDecodeCompressedVector3(sequence, &tracks[COMPRESSED_TRACK_POSITION], frame);
+	transform.rotation = rlmDecodeCompressedQuaternion(sequence, &tracks[COMPRESSED_TRACK_ROTATION], frame);
+	transform.scale = rlmDecodeCompressedVector3(sequence, &tracks[COMPRESSED_TRACK_SCALE], frame);
 
-	return MatrixMultiply(MatrixMultiply(matScale, matRotation), matTranslation);
+	return transform;
 }
 
-rlmPQSTransorm rlmPQSFromMatrix(Matrix matrix)
+// reads one channel of a bone out of the raw keyframes as 4 floats
+static Quaternion rlmGetTrackSourceValue(const rlmModelAniamtionSequence* sequence, int boneId, int trackType, int frame)
 {
-	rlmPQSTransorm transform;
+	const rlmPQSTransorm* transform = &sequence->keyframes[frame].boneTransforms[boneId];
 
-	MatrixDecompose(matrix, &transform.position, &transform.rotation, &transform.scale);
+	if (trackType == COMPRESSED_TRACK_ROTATION)
+		return transform->rotation;
 
-	return transform;
+	Vector3 value = trackType == COMPRESSED_TRACK_POSITION ? transform->position : transform->scale;
+	return (Quaternion){ value.x, value.y, value.z, 0 };
 }
 
-void rlmDrawMesh(rlmGPUMesh* mesh, Shader* shader)
+static float rlmTrackValueError(Quaternion a, Quaternion b, int trackType)
 {
-	if (!mesh || !shader)
-		return;
+	if (trackType == COMPRESSED_TRACK_ROTATION && a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0)
+		b = QuaternionScale(b, -1);
 
-	// Try binding vertex array objects (VAO) or use VBOs if not possible
-	// WARNING: UploadMesh() enables all vertex attributes available in mesh and sets default attribute values
-	// for shader expected vertex attributes that are not provided by the mesh (i.e. colors)
-	// This could be a dangerous approach because different meshes with different shaders can enable/disable some attributes
-	if (!rlEnableVertexArray(mesh->vaoId))
+	return fmaxf(fmaxf(fabsf(a.x - b.x), fabsf(a.y - b.y)), fmaxf(fabsf(a.z - b.z), fabsf(a.w - b.w)));
+}
+
+bool rlmCompressAnimationSequence(rlmModelAniamtionSequence* sequence, int boneCount, float maxError, rlmAnimationCompressionReport* report)
+{
+	if (!sequence || sequence->compressed || !sequence->keyframes || sequence->keyframeCount <= 0 || boneCount <= 0)
+		return false;
+
+	if (sequence->keyframeCount > 65535)
 	{
-		// Bind mesh VBO data: vertex position (shader-location = 0)
-		rlEnableVertexBuffer(mesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION]);
+		TraceLog(LOG_WARNING, "rlModels : Sequence %s has too many frames to compress", sequence->name);
+		return false;
+	}
 
-		// Bind mesh VBO data: vertex texcoords (shader-location = 1)
-		rlEnableVertexBuffer(mesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD]);
-		rlSetVertexAttribute(shader->locs[SHADER_LOC_VERTEX_TEXCOORD01], 2, RL_FLOAT, 0, 0, 0);
-		rlEnableVertexAttribute(shader->locs[SHADER_LOC_VERTEX_TEXCOORD01]);
+	if (maxError < 0)
+		maxError = 0;
 
-		if (shader->locs[SHADER_LOC_VERTEX_NORMAL] != -1)
+	int frameCount = sequence->keyframeCount;
+	int trackCount = boneCount * 3;
+
+	rlmCompressedSequence* compressed = (rlmCompressedSequence*)MemAlloc(sizeof(rlmCompressedSequence));
+	compressed->boneCount = boneCount;
+	compressed->frameCount = frameCount;
+	compressed->tracks = (rlmCompressedTrack*)MemAlloc(sizeof(rlmCompressedTrack) * trackCount);
+
+	// worst case every frame of every track is kept, trimmed once we know
+	compressed->keyFrames = (unsigned short*)MemAlloc(sizeof(unsigned short) * trackCount * frameCount);
+	compressed->keyData = (unsigned short*)MemAlloc(sizeof(unsigned short) * 3 * trackCount * frameCount);
+
+	// scratch space for one track
+	unsigned short* quantized = (unsigned short*)MemAlloc(sizeof(unsigned short) * 3 * frameCount);
+	Quaternion* decoded = (Quaternion*)MemAlloc(sizeof(Quaternion) * frameCount);
+
+	int keyCount = 0;
+	int constantTracks = 0;
+
+	for (int track = 0; track < trackCount; track++)
+	{
+		int boneId = track / 3;
+		int trackType = track % 3;
+		rlmCompressedTrack* outTrack = compressed->tracks + track;
+
+		Quaternion firstValue = rlmGetTrackSourceValue(sequence, boneId, trackType, 0);
+
+		// constant positions and scales are stored as a plain value, with no keys at all
+		bool constant = true;
+		for (int f = 1; f < frameCount && constant; f++)
+			constant = rlmTrackValueError(firstValue, rlmGetTrackSourceValue(sequence, boneId, trackType, f), trackType) <= maxError;
+
+		if (constant && trackType != COMPRESSED_TRACK_ROTATION)
 		{
-			// Bind mesh VBO data: vertex normals (shader-location = 2)
-			rlEnableVertexBuffer(mesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL]);
-			rlSetVertexAttribute(shader->locs[SHADER_LOC_VERTEX_NORMAL], 3, RL_FLOAT, 0, 0, 0);
-			rlEnableVertexAttribute(shader->locs[SHADER_LOC_VERTEX_NORMAL]);
+			outTrack->keyCount = 0;
+			outTrack->keyOffset = keyCount;
+			outTrack->rangeMin = (Vector3){ firstValue.x, firstValue.y, firstValue.z };
+			outTrack->rangeSize = Vector3Zero();
+			constantTracks++;
+			continue;
 		}
 
-		// Bind mesh VBO data: vertex colors (shader-location = 3, if available)
-		if (shader->locs[SHADER_LOC_VERTEX_COLOR] != -1)
+		int sourceFrames = constant ? 1 : frameCount;
+		if (constant)
+			constantTracks++;
+
+		// quantize every frame, and keep what it decodes to, so the reduction error includes the quantization error
+		if (trackType == COMPRESSED_TRACK_ROTATION)
 		{
-			if (mesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR] != 0)
+			for (int f = 0; f < sourceFrames; f++)
 			{
-				rlEnableVertexBuffer(mesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR]);
-				rlSetVertexAttribute(shader->locs[SHADER_LOC_VERTEX_COLOR], 4, RL_UNSIGNED_BYTE, 1, 0, 0);
-				rlEnableVertexAttribute(shader->locs[SHADER_LOC_VERTEX_COLOR]);
+				rlmQuantizeQuaternion(rlmGetTrackSourceValue(sequence, boneId, trackType, f), quantized + (f * 3));
+				decoded[f] = rlmDequantizeQuaternion(quantized + (f * 3));
 			}
-			else
+		}
+		else
+		{
+			Vector3 rangeMin = { firstValue.x, firstValue.y, firstValue.z };
+			Vector3 rangeMax = rangeMin;
+			for (int f = 1; f < sourceFrames; f++)
 			{
-				// Set default value for defined vertex attribute in shader but not provided by mesh
-				// WARNING: It could result in GPU undefined behavior
-				static float value[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
-				rlSetVertexAttributeDefault(shader->locs[SHADER_LOC_VERTEX_COLOR], value, SHADER_ATTRIB_VEC4, 4);
-				rlDisableVertexAttribute(shader->locs[SHADER_LOC_VERTEX_COLOR]);
+				Quaternion value = rlmGetTrackSourceValue(sequence, boneId, trackType, f);
+				rangeMin = Vector3Min(rangeMin, (Vector3) { value.x, value.y, value.z });
+				rangeMax = Vector3Max(rangeMax, (Vector3) { value.x, value.y, value.z });
+			}
+
+			outTrack->rangeMin = rangeMin;
+			outTrack->rangeSize = Vector3Subtract(rangeMax, rangeMin);
+
+			for (int f = 0; f < sourceFrames; f++)
+			{
+				Quaternion value = rlmGetTrackSourceValue(sequence, boneId, trackType, f);
+				rlmQuantizeVector3((Vector3) { value.x, value.y, value.z }, outTrack->rangeMin, outTrack->rangeSize, quantized + (f * 3));
+
+				Vector3 decodedValue = rlmDequantizeVector3(quantized + (f * 3), outTrack->rangeMin, outTrack->rangeSize);
+				decoded[f] = (Quaternion){ decodedValue.x, decodedValue.y, decodedValue.z, 0 };
 			}
 		}
 
-		// Bind mesh VBO data: vertex tangents (shader-location = 4, if available)
-		if (shader->locs[SHADER_LOC_VERTEX_TANGENT] != -1)
+		outTrack->keyOffset = keyCount;
+		outTrack->keyCount = 0;
+
+		// greedy reduction, grow each segment until interpolating across it misses a source frame by more than the error
+		int start = 0;
+		while (true)
+		{
+			compressed->keyFrames[keyCount] = (unsigned short)start;
+			memcpy(compressed->keyData + (keyCount * 3), quantized + (start * 3), sizeof(unsigned short) * 3);
+			keyCount++;
+			outTrack->keyCount++;
+
+			if (start >= sourceFrames - 1)
+				break;
+
+			int end = start + 1;
+			while (end + 1 < sourceFrames)
+			{
+				int candidate = end + 1;
+				bool fits = true;
+
+				for (int f = start + 1; f < candidate && fits; f++)
+				{
+					float param = (float)(f - start) / (float)(candidate - start);
+					Quaternion value;
+					if (trackType == COMPRESSED_TRACK_ROTATION)
+						value = rlmQuaternionNlerpShortest(decoded[start], decoded[candidate], param);
+					else
+						value = QuaternionAdd(decoded[start], QuaternionScale(QuaternionSubtract(decoded[candidate], decoded[start]), param));
+
+					fits = rlmTrackValueError(value, rlmGetTrackSourceValue(sequence, boneId, trackType, f), trackType) <= maxError;
+				}
+
+				if (!fits)
+					break;
+
+				end = candidate;
+			}
+
+			start = end;
+		}
+	}
+
+	MemFree(quantized);
+	MemFree(decoded);
+
+	compressed->keyFrames = (unsigned short*)MemRealloc(compressed->keyFrames, sizeof(unsigned short) * (keyCount > 0 ? keyCount : 1));
+	compressed->keyData = (unsigned short*)MemRealloc(compressed->keyData, sizeof(unsigned short) * 3 * (keyCount > 0 ? keyCount : 1));
+
+	int rawBytes = (int)(frameCount * (sizeof(rlmAnimationKeyframe) + sizeof(rlmPQSTransorm) * boneCount));
+	int compressedBytes = (int)(sizeof(rlmCompressedSequence) + sizeof(rlmCompressedTrack) * trackCount + keyCount * sizeof(unsigned short) * 4);
+
+	if (report)
+	{
+		report->rawBytes = rawBytes;
+		report->compressedBytes = compressedBytes;
+		report->ratio = (float)rawBytes / (float)compressedBytes;
+		report->trackCount = trackCount;
+		report->constantTracks = constantTracks;
+		report->sourceKeys = trackCount * frameCount;
+		report->storedKeys = keyCount;
+	}
+
+	TraceLog(LOG_INFO, "rlModels : Compressed sequence %s from %d to %d bytes (%.2f:1), %d of %d tracks constant", sequence->name, rawBytes, compressedBytes, (float)rawBytes / (float)compressedBytes, constantTracks, trackCount);
+
+	// the raw keyframes are no longer needed, everything samples the compressed data from here on
+	rlmUnloadSequenceKeyframes(sequence);
+
+	sequence->compressed = compressed;
+
+	return true;
+}
+
+static void rlmSetPoseToCompressedFrame(rlmModel model, rlmModelAnimationPose* pose, const rlmCompressedSequence* sequence, int frame, int nextFrame, float param, bool interpolate, const int* boneIds, int count)
+{
+	const rlmPQSTransorm* inverseBindTransforms = model.skeleton->inverseBindingFrame.boneTransforms;
+
+	for (int index = 0; index < count; index++)
+	{
+		int boneId = boneIds ? boneIds[index] : index;
+		if (boneId >= sequence->boneCount)
+			continue;
+
+		rlmPQSTransorm transform = rlmDecodeCompressedTransform(sequence, boneId, frame);
+
+		if (interpolate)
 		{
-			rlEnableVertexBuffer(mesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT]);
-			rlSetVertexAttribute(shader->locs[SHADER_LOC_VERTEX_TANGENT], 4, RL_FLOAT, 0, 0, 0);
-			rlEnableVertexAttribute(shader->locs[SHADER_LOC_VERTEX_TANGENT]);
+			rlmPQSTransorm nextTransform = rlmDecodeCompressedTransform(sequence, boneId, nextFrame);
+			transform = rlmPQSLerp(&transform, &nextTransform, param);
 		}
 
-		// Bind mesh VBO data: vertex texcoords2 (shader-location = 5, if available)
-		if (shader->locs[SHADER_LOC_VERTEX_TEXCOORD02] != -1)
+		pose->boneMatricies[boneId] = rlmGetBoneMatrixFromInverse(&inverseBindTransforms[boneId], &transform);
+	}
+}
+
+// bones past the depth limit were not evaluated, give them their parent's matrix, parents come first so this cascades down
+static void rlmInheritParentBoneMatrices(const rlmSkeleton* skeleton, int maxBoneDepth, rlmModelAnimationPose* pose)
+{
+	for (int slot = 0; slot < skeleton->boneCount; slot++)
+	{
+		if (skeleton->slotDepths[slot] <= maxBoneDepth)
+			continue;
+
+		int parentBone = skeleton->boneOrder[skeleton->slotParents[slot]];
+		pose->boneMatricies[skeleton->boneOrder[slot]] = pose->boneMatricies[parentBone];
+	}
+}
+
+static void rlmSetPoseToSequenceFrame(rlmModel model, rlmModelAnimationPose* pose, const rlmModelAniamtionSequence* sequence, int frame, float param, bool interpolate, int maxBoneDepth)
+{
+	rlmCheckSkeletonCompiled(model.skeleton);
+	const rlmSkeleton* skeleton = model.skeleton;
+
+	// a depth limit is a prefix of the depth sorted bones
+	const int* boneIds = NULL;
+	int count = skeleton->boneCount;
+	bool depthLimited = maxBoneDepth >= 0 && maxBoneDepth < skeleton->maxBoneDepth && skeleton->depthSortedBones;
+	if (depthLimited)
+	{
+		boneIds = skeleton->depthSortedBones;
+		count = skeleton->depthBoneCounts[maxBoneDepth];
+	}
+
+	int nextFrame = frame + 1;
+	if (nextFrame >= sequence->keyframeCount)
+		nextFrame = 0;
+
+	if (sequence->compressed)
+	{
+		rlmSetPoseToCompressedFrame(model, pose, sequence->compressed, frame, nextFrame, param, interpolate, boneIds, count);
+	}
+	else if (!interpolate)
+	{
+		const rlmPQSTransorm* inverseBindTransforms = skeleton->inverseBindingFrame.boneTransforms;
+		const rlmPQSTransorm* frameTransforms = sequence->keyframes[frame].boneTransforms;
+
+		for (int index = 0; index < count; index++)
 		{
-			rlEnableVertexBuffer(mesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2]);
-			rlSetVertexAttribute(shader->locs[SHADER_LOC_VERTEX_TEXCOORD02], 2, RL_FLOAT, 0, 0, 0);
-			rlEnableVertexAttribute(shader->locs[SHADER_LOC_VERTEX_TEXCOORD02]);
+			int boneId = boneIds ? boneIds[index] : index;
+			pose->boneMatricies[boneId] = rlmGetBoneMatrixFromInverse(&inverseBindTransforms[boneId], &frameTransforms[boneId]);
 		}
+	}
+	else
+	{
+		rlmLerpBoneMatrices(skeleton->inverseBindingFrame.boneTransforms, sequence->keyframes[frame].boneTransforms, sequence->keyframes[nextFrame].boneTransforms, param, boneIds, count, pose->boneMatricies);
+	}
 
-#ifdef RL_SUPPORT_MESH_GPU_SKINNING
-		// Bind mesh VBO data: vertex bone ids (shader-location = 6, if available)
-		if (shader->locs[SHADER_LOC_VERTEX_BONEIDS] != -1)
-		{
-			rlEnableVertexBuffer(mesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS]);
-			rlSetVertexAttribute(shader->locs[SHADER_LOC_VERTEX_BONEIDS], 4, RL_UNSIGNED_BYTE, 0, 0, 0);
-			rlEnableVertexAttribute(shader->locs[SHADER_LOC_VERTEX_BONEIDS]);
-		}
+	if (depthLimited)
+		rlmInheritParentBoneMatrices(skeleton, maxBoneDepth, pose);
+}
 
-		// Bind mesh VBO data: vertex bone weights (shader-location = 7, if available)
-		if (shader->locs[SHADER_LOC_VERTEX_BONEWEIGHTS] != -1)
-		{
-			rlEnableVertexBuffer(mesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS]);
-			rlSetVertexAttribute(shader->locs[SHADER_LOC_VERTEX_BONEWEIGHTS], 4, RL_FLOAT, 0, 0, 0);
-			rlEnableVertexAttribute(shader->locs[SHADER_LOC_VERTEX_BONEWEIGHTS]);
-		}
-#endif
+// the sequence loops, the last frame blends back into the first
+static bool rlmGetSequenceFrameAtTime(const rlmModelAniamtionSequence* sequence, float time, int* frame, float* param)
+{
+	if (!sequence || sequence->keyframeCount <= 0 || sequence->fps <= 0)
+		return false;
 
-		if (mesh->isIndexed)
-			rlEnableVertexBufferElement(mesh->vboIds[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES]);
-	}
+	float duration = sequence->keyframeCount / sequence->fps;
+	time = fmodf(time, duration);
+	if (time < 0)
+		time += duration;
 
-	// Draw mesh
-	if (mesh->isIndexed)
-		rlDrawVertexArrayElements(0, mesh->elementCount, 0);
-	else
-		rlDrawVertexArray(0, mesh->elementCount);
+	float framePosition = time * sequence->fps;
+	*frame = (int)framePosition;
+	if (*frame >= sequence->keyframeCount)
+		*frame = sequence->keyframeCount - 1;
 
-	// Disable all possible vertex array objects (or VBOs)
-	rlDisableVertexArray();
-	rlDisableVertexBuffer();
-	rlDisableVertexBufferElement();
+	*param = framePosition - *frame;
+	return true;
 }
 
-void rlmDrawModel(rlmModel model, rlmPQSTransorm transform)
+void rlmSampleSequenceAtTime(rlmModel model, const rlmModelAniamtionSequence* sequence, float time, rlmModelAnimationPose* pose)
 {
-	Matrix transformMatrix = rlmPQSToMatrix(&transform);
-	Matrix modelMatrix = MatrixMultiply(rlmPQSToMatrix(&model.orientationTransform), transformMatrix);
+	if (!model.skeleton || !pose)
+		return;
 
-	// add in the rlgl matrix stack
-	Matrix matModel = MatrixMultiply(modelMatrix, rlGetMatrixTransform());
+	int frame;
+	float param;
+	if (!rlmGetSequenceFrameAtTime(sequence, time, &frame, &param))
+		return;
 
-	for (int group = 0; group < model.groupCount; group++)
-	{
-		rlmModelGroup* groupPtr = model.groups + group;
+	rlmSetPoseToSequenceFrame(model, pose, sequence, frame, param, true, -1);
+}
 
-		rlmApplyMaterialDef(&groupPtr->material);
+rlmAnimationBoneMask rlmLoadBoneMask(rlmModel model, float weight)
+{
+	rlmAnimationBoneMask mask = { 0 };
+	if (!model.skeleton || model.skeleton->boneCount <= 0)
+		return mask;
 
-		// draw the meshes
-		for (int i = 0; i < groupPtr->meshCount; i++)
-		{
-			// load uniforms
-			// Get a copy of current matrices to work with,
-			// just in case stereo render is required, and we need to modify them
-			// NOTE: At this point the modelview matrix just contains the view matrix (camera)
-			// That's because BeginMode3D() sets it and there is no model-drawing function
-			// that modifies it, all use rlPushMatrix() and rlPopMatrix()
-			Matrix matView = MatrixMultiply(rlmPQSToMatrix(&groupPtr->meshes[i].transform), rlGetMatrixModelview());
-			Matrix matProjection = rlGetMatrixProjection();
-			Matrix matModelView = MatrixMultiply(matModel, matView);
-			Matrix matModelViewProjection = MatrixMultiply(matModelView, matProjection);
-
-			// Upload view and projection matrices (if locations available)
-			if (groupPtr->material.shader.locs[SHADER_LOC_MATRIX_VIEW] != -1)
-				rlSetUniformMatrix(groupPtr->material.shader.locs[SHADER_LOC_MATRIX_VIEW], matView);
-
-			if (groupPtr->material.shader.locs[SHADER_LOC_MATRIX_PROJECTION] != -1)
-				rlSetUniformMatrix(groupPtr->material.shader.locs[SHADER_LOC_MATRIX_PROJECTION], matProjection);
-
-			// Model transformation matrix is sent to shader uniform location: SHADER_LOC_MATRIX_MODEL
-			if (groupPtr->material.shader.locs[SHADER_LOC_MATRIX_MODEL] != -1)
-				rlSetUniformMatrix(groupPtr->material.shader.locs[SHADER_LOC_MATRIX_MODEL], matModel);
-
-			// Upload model normal matrix (if locations available)
-			if (groupPtr->material.shader.locs[SHADER_LOC_MATRIX_NORMAL] != -1)
-				rlSetUniformMatrix(groupPtr->material.shader.locs[SHADER_LOC_MATRIX_NORMAL], MatrixTranspose(MatrixInvert(matModel)));
-
-			// Send combined model-view-projection matrix to shader
-			rlSetUniformMatrix(groupPtr->material.shader.locs[SHADER_LOC_MATRIX_MVP], matModelViewProjection);
-
-			// if the shader wants bones, set identity matricies, so it can still draw
-			if (groupPtr->material.shader.locs[SHADER_LOC_BONE_MATRICES] >= 0)
-			{
-				int count = MAX_BONE_NUM;
-				if (model.skeleton)
-					count = model.skeleton->boneCount;
+	mask.boneCount = model.skeleton->boneCount;
+	mask.boneWeights = (float*)MemAlloc(sizeof(float) * mask.boneCount);
+	for (int i = 0; i < mask.boneCount; i++)
+		mask.boneWeights[i] = weight;
 
-				CheckGlobalBoneMatricies();
-				rlSetUniformMatrices(groupPtr->material.shader.locs[SHADER_LOC_BONE_MATRICES], DefaultBoneMatricies, count);
-			}
+	return mask;
+}
 
-			if (groupPtr->meshDisableFlags == NULL || !groupPtr->meshDisableFlags[i])
-				rlmDrawMesh(&groupPtr->meshes[i].gpuMesh, &groupPtr->material.shader);
-		}
+void rlmSetBoneMaskWeight(rlmModel model, rlmAnimationBoneMask* mask, rlmBoneInfo* startBone, float weight)
+{
+	if (!model.skeleton || !mask || !mask->boneWeights)
+		return;
 
-		rlmResetMaterialDef(&groupPtr->material);
-		// Disable shader program
-		rlDisableShader();
+	int startSlot, endSlot;
+	rlmGetBoneSlotRange(model.skeleton, startBone, &startSlot, &endSlot);
+
+	for (int slot = startSlot; slot < endSlot; slot++)
+	{
+		int boneId = model.skeleton->boneOrder ? model.skeleton->boneOrder[slot] : slot;
+		if (boneId < mask->boneCount)
+			mask->boneWeights[boneId] = weight;
 	}
+}
 
-	rlSetTexture(0);
+void rlmUnloadBoneMask(rlmAnimationBoneMask* mask)
+{
+	if (!mask)
+		return;
+
+	MemFree(mask->boneWeights);
+	mask->boneWeights = NULL;
+	mask->boneCount = 0;
 }
 
-void rlmDrawModelWithPose(rlmModel model, rlmPQSTransorm transform, rlmModelAnimationPose* pose)
+typedef struct rlmBlendLayerSample
 {
-	rlmDrawModelWithPoseEx(model, transform, pose, NULL);
+	const rlmModelAniamtionSequence* sequence;
+	const rlmAnimationBoneMask* mask;
+	float weight;
+	int frame;
+	int nextFrame;
+	float param;
+	int boneCount;	// bones the sequence has data for
+}rlmBlendLayerSample;
+
+static rlmPQSTransorm rlmSampleBlendLayerBone(const rlmBlendLayerSample* layer, int boneId)
+{
+	const rlmModelAniamtionSequence* sequence = layer->sequence;
+
+	if (sequence->compressed)
+	{
+		rlmPQSTransorm transform = rlmDecodeCompressedTransform(sequence->compressed, boneId, layer->frame);
+		rlmPQSTransorm nextTransform = rlmDecodeCompressedTransform(sequence->compressed, boneId, layer->nextFrame);
+		return rlmPQSLerp(&transform, &nextTransform, layer->param);
+	}
+
+	return rlmPQSLerp(&sequence->keyframes[layer->frame].boneTransforms[boneId], &sequence->keyframes[layer->nextFrame].boneTransforms[boneId], layer->param);
 }
 
-void rlmDrawModelWithPoseEx(rlmModel model, rlmPQSTransorm transform, rlmModelAnimationPose* pose, Shader* shader)
+void rlmBlendAnimationLayers(rlmModel model, const rlmAnimationBlendLayer* layers, int layerCount, rlmModelAnimationPose* pose)
 {
-	Matrix transformMatrix = rlmPQSToMatrix(&transform);
-	Matrix modelMatrix = MatrixMultiply(rlmPQSToMatrix(&model.orientationTransform), transformMatrix);
+	if (!model.skeleton || !layers || !pose)
+		return;
 
-	// add in the rlgl matrix stack
-	Matrix matModel = MatrixMultiply(modelMatrix, rlGetMatrixTransform());
+	if (layerCount > RLM_MAX_BLEND_LAYERS)
+	{
+		TraceLog(LOG_WARNING, "rlModels : only the first %d of %d blend layers are used", RLM_MAX_BLEND_LAYERS, layerCount);
+		layerCount = RLM_MAX_BLEND_LAYERS;
+	}
 
-	for (int group = 0; group < model.groupCount; group++)
+	// resolve the frames for each layer once, on the stack
+	rlmBlendLayerSample samples[RLM_MAX_BLEND_LAYERS];
+	int sampleCount = 0;
+
+	for (int i = 0; i < layerCount; i++)
 	{
-		rlmModelGroup* groupPtr = model.groups + group;
+		rlmBlendLayerSample* sample = &samples[sampleCount];
+		if (layers[i].weight <= 0 || !rlmGetSequenceFrameAtTime(layers[i].sequence, layers[i].time, &sample->frame, &sample->param))
+			continue;
+
+		sample->sequence = layers[i].sequence;
+		sample->mask = layers[i].mask;
+		sample->weight = layers[i].weight;
+		sample->nextFrame = sample->frame + 1;
+		if (sample->nextFrame >= sample->sequence->keyframeCount)
+			sample->nextFrame = 0;
+
+		// only rlmLoadSequenceKeyframes sets the bone count, hand built sequences are taken to cover the whole skeleton
+		sample->boneCount = model.skeleton->boneCount;
+		if (sample->sequence->compressed)
+			sample->boneCount = sample->sequence->compressed->boneCount;
+		else if (sample->sequence->boneCount > 0)
+			sample->boneCount = sample->sequence->boneCount;
+
+		sampleCount++;
+	}
 
-		Shader* shaderToUse = &groupPtr->material.shader;
-		if (shader)
+	rlmCheckSkeletonCompiled(model.skeleton);
+	const rlmPQSTransorm* inverseBindTransforms = model.skeleton->inverseBindingFrame.boneTransforms;
+
+	for (int boneId = 0; boneId < model.skeleton->boneCount; boneId++)
+	{
+		rlmPQSTransorm blended = { 0 };
+		float totalWeight = 0;
+
+		for (int i = 0; i < sampleCount; i++)
 		{
-			shaderToUse = shader; // shader override, assume it is already setup
+			const rlmBlendLayerSample* sample = &samples[i];
+			if (boneId >= sample->boneCount)
+				continue;
+
+			float weight = sample->weight;
+			if (sample->mask && boneId < sample->mask->boneCount)
+				weight *= sample->mask->boneWeights[boneId];
+
+			if (weight <= 0)
+				continue;
+
+			rlmPQSTransorm transform = rlmSampleBlendLayerBone(sample, boneId);
+
+			// keep every rotation in the same hemisphere as the first one so they don't cancel out
+			Quaternion rotation = transform.rotation;
+			if (blended.rotation.x * rotation.x + blended.rotation.y * rotation.y + blended.rotation.z * rotation.z + blended.rotation.w * rotation.w < 0)
+				rotation = QuaternionScale(rotation, -1);
+
+			blended.position = Vector3Add(blended.position, Vector3Scale(transform.position, weight));
+			blended.scale = Vector3Add(blended.scale, Vector3Scale(transform.scale, weight));
+			blended.rotation = QuaternionAdd(blended.rotation, QuaternionScale(rotation, weight));
+			totalWeight += weight;
 		}
-		else
+
+		if (totalWeight <= 0)
 		{
-			rlmApplyMaterialDef(&groupPtr->material);
+			pose->boneMatricies[boneId] = MatrixIdentity();
+			continue;
 		}
 
-		// if the shader wants bones, set some bone matricies
-		if (shaderToUse->locs[SHADER_LOC_BONE_MATRICES] >= 0)
-		{
-			// if we have a real pose, use it
-			if (model.skeleton && pose)
-			{
-				rlSetUniformMatrices(shaderToUse->locs[SHADER_LOC_BONE_MATRICES], pose->boneMatricies, model.skeleton->boneCount);
-			}
-			else // otherwise just fill out a list of default bones.
-			{
-				int count = MAX_BONE_NUM;
-				if (model.skeleton)
-					count = model.skeleton->boneCount;
+		float scale = 1.0f / totalWeight;
+		blended.position = Vector3Scale(blended.position, scale);
+		blended.scale = Vector3Scale(blended.scale, scale);
+		blended.rotation = QuaternionNormalize(blended.rotation);
 
-				CheckGlobalBoneMatricies();
-				rlSetUniformMatrices(shaderToUse->locs[SHADER_LOC_BONE_MATRICES], DefaultBoneMatricies, count);
-			}
-		}
+		pose->boneMatricies[boneId] = rlmGetBoneMatrixFromInverse(&inverseBindTransforms[boneId], &blended);
+	}
+}
 
-		// load uniforms
-		// Get a copy of current matrices to work with,
-		// just in case stereo render is required, and we need to modify them
-		// NOTE: At this point the modelview matrix just contains the view matrix (camera)
-		// That's because BeginMode3D() sets it and there is no model-drawing function
-		// that modifies it, all use rlPushMatrix() and rlPopMatrix()
-		Matrix matView = rlGetMatrixModelview();
-		Matrix matProjection = rlGetMatrixProjection();
-		Matrix matModelView = MatrixMultiply(matModel, matView);
-		Matrix matModelViewProjection = MatrixMultiply(matModelView, matProjection);
+rlmPoseCache rlmLoadPoseCache(rlmModel model, const rlmModelAniamtionSequence* sequence, float sampleRate)
+{
+	rlmPoseCache cache = { 0 };
 
-		// Upload view and projection matrices (if locations available)
-		if (shaderToUse->locs[SHADER_LOC_MATRIX_VIEW] != -1)
-			rlSetUniformMatrix(shaderToUse->locs[SHADER_LOC_MATRIX_VIEW], matView);
+	if (!model.skeleton || !sequence || sequence->keyframeCount <= 0 || sequence->fps <= 0 || sampleRate <= 0)
+		return cache;
 
-		if (shaderToUse->locs[SHADER_LOC_MATRIX_PROJECTION] != -1)
-			rlSetUniformMatrix(shaderToUse->locs[SHADER_LOC_MATRIX_PROJECTION], matProjection);
+	float duration = sequence->keyframeCount / sequence->fps;
 
-		// Model transformation matrix is sent to shader uniform location: SHADER_LOC_MATRIX_MODEL
-		if (shaderToUse->locs[SHADER_LOC_MATRIX_MODEL] != -1)
-			rlSetUniformMatrix(shaderToUse->locs[SHADER_LOC_MATRIX_MODEL], matModel);
+	cache.skeleton = model.skeleton;
+	cache.sequence = sequence;
+	cache.sampleRate = sampleRate;
+	cache.slotCount = (int)ceilf(duration * sampleRate);
+	if (cache.slotCount < 1)
+		cache.slotCount = 1;
+	cache.boneCount = model.skeleton->boneCount;
 
-		// Upload model normal matrix (if locations available)
-		if (shaderToUse->locs[SHADER_LOC_MATRIX_NORMAL] != -1)
-			rlSetUniformMatrix(shaderToUse->locs[SHADER_LOC_MATRIX_NORMAL], MatrixTranspose(MatrixInvert(matModel)));
+	cache.boneMatricies = (Matrix*)MemAlloc(sizeof(Matrix) * cache.slotCount * cache.boneCount);
+	cache.validSlots = (bool*)MemAlloc(sizeof(bool) * cache.slotCount);
 
-		// Send combined model-view-projection matrix to shader
-		rlSetUniformMatrix(shaderToUse->locs[SHADER_LOC_MATRIX_MVP], matModelViewProjection);
+	return cache;
+}
 
-		// draw the meshes
-		for (int i = 0; i < groupPtr->meshCount; i++)
-		{
-			if (groupPtr->meshDisableFlags == NULL || !groupPtr->meshDisableFlags[i])
-				rlmDrawMesh(&groupPtr->meshes[i].gpuMesh, &groupPtr->material.shader);
-		}
+static void rlmFillPoseCacheSlot(rlmModel model, rlmPoseCache* cache, int slot)
+{
+	rlmModelAnimationPose slotPose = { cache->boneMatricies + (slot * cache->boneCount) };
+	rlmSampleSequenceAtTime(model, cache->sequence, slot / cache->sampleRate, &slotPose);
+	cache->validSlots[slot] = true;
+}
 
-		if (!shader)
-			rlmResetMaterialDef(&groupPtr->material);
+void rlmBakePoseCache(rlmModel model, rlmPoseCache* cache)
+{
+	if (!cache || !cache->boneMatricies || model.skeleton != cache->skeleton)
+		return;
 
-		// Disable shader program
-		rlDisableShader();
+	for (int slot = 0; slot < cache->slotCount; slot++)
+	{
+		if (!cache->validSlots[slot])
+			rlmFillPoseCacheSlot(model, cache, slot);
 	}
 
-	rlSetTexture(0);
+	cache->baked = true;
 }
 
-Matrix rlmGetBoneMatrix(const rlmPQSTransorm* bindingTransform, const rlmPQSTransorm* frameTransform)
+void rlmUnloadPoseCache(rlmPoseCache* cache)
 {
-	Vector3 invTranslation = Vector3RotateByQuaternion(Vector3Negate(bindingTransform->position), QuaternionInvert(bindingTransform->rotation));
-	Quaternion invRotation = QuaternionInvert(bindingTransform->rotation);
-	Vector3 invScale = Vector3Divide((Vector3) { 1, 1, 1 }, bindingTransform->scale);
+	if (!cache)
+		return;
 
-	Vector3 boneTranslation = Vector3Add(Vector3RotateByQuaternion(Vector3Multiply(frameTransform->scale, invTranslation), frameTransform->rotation), frameTransform->position);
-	Quaternion boneRotation = QuaternionMultiply(frameTransform->rotation, invRotation);
-	Vector3 boneScale = Vector3Multiply(frameTransform->scale, invScale);
+	MemFree(cache->boneMatricies);
+	MemFree(cache->validSlots);
+	cache->boneMatricies = NULL;
+	cache->validSlots = NULL;
+	cache->slotCount = 0;
+	cache->baked = false;
+}
 
-	Matrix boneMatrix = MatrixMultiply(MatrixMultiply(
-		QuaternionToMatrix(boneRotation),
-		MatrixTranslate(boneTranslation.x, boneTranslation.y, boneTranslation.z)),
-		MatrixScale(boneScale.x, boneScale.y, boneScale.z));
+static int rlmGetPoseCacheSlot(const rlmPoseCache* cache, float time)
+{
+	int slot = (int)floorf(time * cache->sampleRate) % cache->slotCount;
+	if (slot < 0)
+		slot += cache->slotCount;
 
-	return boneMatrix;
+	return slot;
 }
 
-static void rlmSetBonePoseRecursive(const rlmBoneInfo* bone, const rlmAnimationKeyframe* bindingFrame, const rlmAnimationKeyframe* keyframe, rlmModelAnimationPose* pose)
+// not thread safe, a miss fills the slot and every call updates the counters
+rlmModelAnimationPose rlmGetCachedPose(rlmModel model, rlmPoseCache* cache, float time)
 {
-	pose->boneMatricies[bone->boneId] = rlmGetBoneMatrix(&bindingFrame->boneTransforms[bone->boneId], &keyframe->boneTransforms[bone->boneId]);
+	rlmModelAnimationPose pose = { 0 };
+
+	if (!cache || !cache->boneMatricies)
+		return pose;
+
+	if (model.skeleton != cache->skeleton)
+	{
+		TraceLog(LOG_WARNING, "rlModels : Pose cache used with a different skeleton than it was made for");
+		return pose;
+	}
 
-	for (int i = 0; i < bone->childCount; i++)
+	int slot = rlmGetPoseCacheSlot(cache, time);
+
+	if (cache->validSlots[slot])
+	{
+		cache->hits++;
+	}
+	else
 	{
-		rlmSetBonePoseRecursive(bone->childBones[i], bindingFrame, keyframe, pose);
+		cache->misses++;
+		rlmFillPoseCacheSlot(model, cache, slot);
 	}
+
+	pose.boneMatricies = cache->boneMatricies + (slot * cache->boneCount);
+	return pose;
 }
 
-static void rlmSetBonePoseRecursiveLerp(const rlmBoneInfo* bone, const rlmAnimationKeyframe* bindingFrame, const rlmAnimationKeyframe* keyframe1, const rlmAnimationKeyframe* keyframe2, float param, rlmModelAnimationPose* pose)
+rlmPoseCache* rlmLoadPoseCacheSet(rlmModel model, const rlmModelAnimationSet* set, float sampleRate, bool bake)
 {
-	rlmPQSTransorm lerpedTransform = rlmPQSLerp(&keyframe1->boneTransforms[bone->boneId], &keyframe2->boneTransforms[bone->boneId], param);
+	if (!set || set->sequenceCount <= 0)
+		return NULL;
 
-	pose->boneMatricies[bone->boneId] = rlmGetBoneMatrix(&bindingFrame->boneTransforms[bone->boneId], &lerpedTransform);
+	rlmPoseCache* caches = (rlmPoseCache*)MemAlloc(sizeof(rlmPoseCache) * set->sequenceCount);
 
-	for (int i = 0; i < bone->childCount; i++)
+	for (int i = 0; i < set->sequenceCount; i++)
 	{
-		rlmSetBonePoseRecursiveLerp(bone->childBones[i], bindingFrame, keyframe1, keyframe2, param, pose);
+		caches[i] = rlmLoadPoseCache(model, set->sequences + i, sampleRate);
+		if (bake)
+			rlmBakePoseCache(model, caches + i);
 	}
+
+	return caches;
 }
 
-rlmModelAnimationPose rlmLoadPoseFromModel(rlmModel model)
+void rlmUnloadPoseCacheSet(rlmPoseCache* caches, int count)
+{
+	if (!caches)
+		return;
+
+	for (int i = 0; i < count; i++)
+		rlmUnloadPoseCache(caches + i);
+
+	MemFree(caches);
+}
+
+// read only lookup for caches shared across the animation workers, they are baked before the workers start
+static rlmModelAnimationPose rlmReadBakedPose(rlmModel model, const rlmPoseCache* cache, float time)
 {
 	rlmModelAnimationPose pose = { 0 };
 
-	if (model.skeleton)
-	{
-		pose.boneMatricies = (Matrix*)MemAlloc(sizeof(Matrix) * model.skeleton->boneCount);
+	if (!cache || !cache->boneMatricies || !cache->baked || model.skeleton != cache->skeleton)
+		return pose;
 
-		for (int i = 0; i < model.skeleton->boneCount; i++)
-			pose.boneMatricies[i] = MatrixIdentity();
-	}
+	pose.boneMatricies = cache->boneMatricies + (rlmGetPoseCacheSlot(cache, time) * cache->boneCount);
 	return pose;
 }
 
-void rlmUnloadPose(rlmModelAnimationPose* pose)
+static void rlmAdvanceAnimationInstanceEx(rlmAnimatedModelInstance* instance, float deltaTime, bool sharedCaches)
 {
-	if (!pose)
+	if (!instance)
 		return;
 
-	MemFree(pose->boneMatricies);
-	pose->boneMatricies = NULL;
+	const rlmModelAniamtionSequence* sequence = &instance->sequences->sequences[instance->currentSequence];
+	if (sequence->keyframeCount <= 0 || sequence->fps <= 0)
+		return;
+
+	bool interpolate = instance->interpolate;
+	int maxBoneDepth = -1;
+
+	// closer than the first level the pose is always full quality
+	const rlmAnimationLOD* lod = &instance->model->animationLOD;
+	if (lod->levelCount > 0 && instance->lodLevel > 0)
+	{
+		int level = instance->lodLevel - 1;
+		if (level >= lod->levelCount)
+			level = lod->levelCount - 1;
+
+		const rlmAnimationLODLevel* lodLevel = &lod->levels[level];
+
+		// hold the pose, and catch up with all the skipped time on the next update
+		instance->lodPendingTime += deltaTime;
+		instance->lodSkippedUpdates++;
+		if (lodLevel->updateInterval > 1 && instance->lodSkippedUpdates < lodLevel->updateInterval)
+			return;
+
+		deltaTime = instance->lodPendingTime;
+		instance->lodPendingTime = 0;
+		instance->lodSkippedUpdates = 0;
+
+		interpolate = interpolate && lodLevel->interpolate;
+		maxBoneDepth = lodLevel->maxBoneDepth;
+	}
+
+	instance->currentParam += deltaTime;
+
+	float fpsDelta = 1.0f / sequence->fps;
+
+	// jump straight to the frame, no matter how many were skipped
+	if (instance->currentParam >= fpsDelta)
+	{
+		int framesToAdvance = (int)(instance->currentParam / fpsDelta);
+		instance->currentParam -= framesToAdvance * fpsDelta;
+		if (instance->currentParam < 0)
+			instance->currentParam = 0;
+
+		instance->currentFrame = (instance->currentFrame + framesToAdvance) % sequence->keyframeCount;
+	}
+
+	if (instance->poseCaches)
+	{
+		float time = (instance->currentFrame + (instance->currentParam / fpsDelta)) * fpsDelta;
+		if (sharedCaches)
+			instance->cachedPose = rlmReadBakedPose(*instance->model, instance->poseCaches + instance->currentSequence, time);
+		else
+			instance->cachedPose = rlmGetCachedPose(*instance->model, instance->poseCaches + instance->currentSequence, time);
+
+		if (instance->cachedPose.boneMatricies)
+			return;
+	}
+
+	rlmSetPoseToSequenceFrame(*instance->model, &instance->currentPose, sequence, instance->currentFrame, instance->currentParam / fpsDelta, interpolate, maxBoneDepth);
 }
 
-void rlmSetPoseToKeyframe(rlmModel model, rlmModelAnimationPose* pose, rlmAnimationKeyframe frame)
+void rlmAdvanceAnimationInstance(rlmAnimatedModelInstance* instance, float deltaTime)
 {
-	if (!model.skeleton)
-		return;
-
-	rlmSetBonePoseRecursive(model.skeleton->rootBone, &model.skeleton->bindingFrame, &frame, pose);
+	rlmAdvanceAnimationInstanceEx(instance, deltaTime, false);
 }
 
-void rlmSetPoseToKeyframeEx(rlmModel model, rlmModelAnimationPose* pose, rlmAnimationKeyframe frame, rlmBoneInfo* startBone)
+int rlmAddAnimationLODLevel(rlmModel* model, float distance, int updateInterval, bool interpolate, int maxBoneDepth)
 {
-	if (!model.skeleton)
-		return;
+	if (!model || model->animationLOD.levelCount >= RLM_MAX_ANIMATION_LODS)
+		return -1;
+
+	rlmAnimationLOD* lod = &model->animationLOD;
 
-	if (startBone == NULL)
-		startBone = model.skeleton->rootBone;
+	// keep the levels sorted by distance
+	int index = lod->levelCount;
+	while (index > 0 && lod->levels[index - 1].distance > distance)
+	{
+		lod->levels[index] = lod->levels[index - 1];
+		index--;
+	}
 
-	rlmSetBonePoseRecursive(startBone, &model.skeleton->bindingFrame, &frame, pose);
+	lod->levels[index].distance = distance;
+	lod->levels[index].updateInterval = updateInterval < 1 ? 1 : updateInterval;
+	lod->levels[index].interpolate = interpolate;
+	lod->levels[index].maxBoneDepth = maxBoneDepth;
+	lod->levelCount++;
+
+	return index;
 }
 
-void rlmSetPoseToKeyframesLerp(rlmModel model, rlmModelAnimationPose* pose, rlmAnimationKeyframe frame1, rlmAnimationKeyframe frame2, float param)
+void rlmUpdateAnimationInstanceLOD(rlmAnimatedModelInstance* instance, Vector3 viewPosition)
 {
-	if (!model.skeleton)
+	if (!instance || !instance->model)
 		return;
 
-	rlmSetBonePoseRecursiveLerp(model.skeleton->rootBone, &model.skeleton->bindingFrame, &frame1, &frame2, param, pose);
+	const rlmAnimationLOD* lod = &instance->model->animationLOD;
+
+	float distance = Vector3Distance(instance->transform.position, viewPosition);
+
+	// each level starts at its distance, so this counts the levels passed
+	int level = 0;
+	while (level < lod->levelCount && distance >= lod->levels[level].distance)
+		level++;
+
+	instance->lodLevel = level;
 }
 
-void rlmSetPoseToKeyframesLerpEx(rlmModel model, rlmModelAnimationPose* pose, rlmAnimationKeyframe frame1, rlmAnimationKeyframe frame2, float param, rlmBoneInfo* startBone)
+void rlmUpdateAnimationInstancesLOD(rlmAnimatedModelInstance* instances, int count, Vector3 viewPosition)
 {
-	if (!model.skeleton)
+	if (!instances)
 		return;
 
-	if (startBone == NULL)
-		startBone = model.skeleton->rootBone;
-
-	rlmSetBonePoseRecursiveLerp(startBone, &model.skeleton->bindingFrame, &frame1, &frame2, param, pose);
+	for (int i = 0; i < count; i++)
+		rlmUpdateAnimationInstanceLOD(instances + i, viewPosition);
 }
 
-rlmBoneInfo* rlmFindBoneByName(rlmModel model, const char* boneName)
+rlmModelAnimationPose* rlmGetAnimationInstancePose(rlmAnimatedModelInstance* instance)
 {
-	if (!model.skeleton || !boneName)
+	if (!instance)
 		return NULL;
 
-	for (int i = 0; i < model.skeleton->boneCount; i++)
-	{
-		if (TextIsEqual(model.skeleton->bones[i].name, boneName))
-			return &model.skeleton->bones[i];
-	}
-	return NULL;
+	if (instance->poseCaches && instance->cachedPose.boneMatricies)
+		return &instance->cachedPose;
+
+	return &instance->currentPose;
 }
 
-void rlmAdvanceAnimationInstance(rlmAnimatedModelInstance* instance, float deltaTime)
+// instances each worker claims at a time, small enough to balance uneven skeletons, big enough to keep the shared counter cold
+#define ANIMATION_INSTANCE_CHUNK 16
+
+typedef struct rlmAdvanceInstancesJob
 {
-	if (!instance)
-		return;
+	rlmAnimatedModelInstance* instances;
+	float deltaTime;
+}rlmAdvanceInstancesJob;
 
-	instance->currentParam += deltaTime;
+static void rlmAdvanceAnimationInstancesRange(void* userData, int start, int end)
+{
+	rlmAdvanceInstancesJob* job = (rlmAdvanceInstancesJob*)userData;
+
+	for (int i = start; i < end; i++)
+		rlmAdvanceAnimationInstanceEx(job->instances + i, job->deltaTime, true);
+}
 
-	float fpsDelta = 1.0f / instance->sequences->sequences[instance->currentSequence].fps;
+void rlmAdvanceAnimationInstances(rlmAnimatedModelInstance* instances, int count, float deltaTime)
+{
+	if (!instances || count <= 0)
+		return;
 
-	while (instance->currentParam >= fpsDelta)
+	// the workers only read the skeletons and pose caches, so anything that would be built lazily is built here first
+	for (int i = 0; i < count; i++)
 	{
-		instance->currentParam -= fpsDelta;
-		instance->currentFrame++;
-		if (instance->currentFrame >= instance->sequences->sequences[instance->currentSequence].keyframeCount)
-			instance->currentFrame = 0;
+		rlmAnimatedModelInstance* instance = instances + i;
+		if (instance->model)
+			rlmCheckSkeletonCompiled(instance->model->skeleton);
 
-		if (!instance->interpolate)
-			rlmSetPoseToKeyframe(*instance->model, &instance->currentPose, instance->sequences->sequences[instance->currentSequence].keyframes[instance->currentFrame]);
+		if (!instance->poseCaches || !instance->model)
+			continue;
+
+		rlmPoseCache* cache = instance->poseCaches + instance->currentSequence;
+		if (cache->boneMatricies && !cache->baked && instance->model->skeleton == cache->skeleton)
+		{
+			TraceLog(LOG_WARNING, "rlModels : Pose cache was not baked before rlmAdvanceAnimationInstances, baking it now");
+			rlmBakePoseCache(*instance->model, cache);
+		}
 	}
 
-	if (instance->interpolate)
-	{
-		int nextFrame = instance->currentFrame + 1;
-		if (nextFrame >= instance->sequences->sequences[instance->currentSequence].keyframeCount)
-			nextFrame = 0;
+	// every instance only writes it's own pose, so the result is the same no matter which thread runs it
+	rlmAdvanceInstancesJob job = { instances, deltaTime };
+	rlmThreadsRun(rlmAdvanceAnimationInstancesRange, &job, count, ANIMATION_INSTANCE_CHUNK);
+}
 
-		rlmSetPoseToKeyframesLerp(*instance->model,
-			&instance->currentPose,
-			instance->sequences->sequences[instance->currentSequence].keyframes[instance->currentFrame],
-			instance->sequences->sequences[instance->currentSequence].keyframes[nextFrame],
-			instance->currentParam);
-	}
+void rlmSetAnimationWorkerCount(int count)
+{
+	rlmThreadsSetWorkerCount(count);
+}
+
+int rlmGetAnimationWorkerCount()
+{
+	return rlmThreadsGetWorkerCount();
 }
 
 void rlmSetAnimationInstanceSequence(rlmAnimatedModelInstance* instance, int sequence)
@@ -1067,7 +7934,7 @@ void rlmSetAnimationInstanceSequence(rlmAnimatedModelInstance* instance, int seq
 		return;
 	instance->currentFrame = 0;
 	instance->currentSequence = sequence;
-	instance->currentParam = -1.0f / instance->sequences->sequences[instance->currentSequence].fps;
+	instance->currentParam = 0;
 
 	rlmAdvanceAnimationInstance(instance, 0);
 }
@@ -1080,6 +7947,16 @@ void rlmUnloadAnimationPose(rlmModelAnimationPose* pose)
 
 void rlmUnloadAnimationKeyframe(rlmAnimationKeyframe* keyframe)
 {
+	if (!keyframe)
+		return;
+
+	// freeing a pointer into the middle of the sequence's block would corrupt the heap
+	if (keyframe->isView)
+	{
+		TraceLog(LOG_WARNING, "rlModels : rlmUnloadAnimationKeyframe called on a keyframe of a sequence, unload the sequence instead");
+		return;
+	}
+
 	MemFree(keyframe->boneTransforms);
 	keyframe->boneTransforms = NULL;
 }
@@ -1089,12 +7966,17 @@ void rlmUnloadAnimationSequence(rlmModelAniamtionSequence* sequence)
 	if (!sequence)
 		return;
 
-	for (int i = 0; i < sequence->keyframeCount; i++)
-		rlmUnloadAnimationKeyframe(sequence->keyframes + i);
-
-	MemFree(sequence->keyframes);
+	rlmUnloadSequenceKeyframes(sequence);
 	sequence->keyframeCount = 0;
-	sequence->keyframes = NULL;
+
+	if (sequence->compressed)
+	{
+		MemFree(sequence->compressed->tracks);
+		MemFree(sequence->compressed->keyFrames);
+		MemFree(sequence->compressed->keyData);
+		MemFree(sequence->compressed);
+		sequence->compressed = NULL;
+	}
 }
 
 void rlmUnloadAnimationSet(rlmModelAnimationSet* set)
@@ -1,5 +1,8 @@
 #include "rlModels_IO.h"
 
+#include "rlgl.h"
+#include "config.h"
+
 #include <stdio.h>
 #include <string.h>
 
@@ -9,8 +12,64 @@ rlmModel rlmLoadFromModel(Model raylibModel)
 }
 
 rlmModel rlmLoadFromModelEX(Model raylibModel, bool keepCPUdata)
+{
+	return rlmLoadFromModelWithLODs(raylibModel, keepCPUdata, 0, 0.5f, 0.01f);
+}
+
+// raylib's upload is thrown away, the mesh is optimized and uploaded again from its CPU data, a negative weld distance only uploads it
+static rlmMeshOptimizeReport rlmReuploadImportedMesh(rlmMesh* newMesh, Mesh* oldMesh, bool keepCPUdata, int lodLevels, float reduction, float maxError, float weldDistance)
+{
+	rlUnloadVertexArray(oldMesh->vaoId);
+	if (oldMesh->vboId != NULL)
+	{
+		for (int i = 0; i < MAX_MESH_VERTEX_BUFFERS; i++)
+			rlUnloadVertexBuffer(oldMesh->vboId[i]);
+	}
+	MemFree(oldMesh->vboId);
+
+	rlmMeshBuffers* buffers = (rlmMeshBuffers*)MemAlloc(sizeof(rlmMeshBuffers));
+	buffers->vertexCount = oldMesh->vertexCount;
+	buffers->triangleCount = oldMesh->triangleCount;
+	buffers->vertices = oldMesh->vertices;
+	buffers->texcoords = oldMesh->texcoords;
+	buffers->texcoords2 = oldMesh->texcoords2;
+	buffers->normals = oldMesh->normals;
+	buffers->tangents = oldMesh->tangents;
+	buffers->colors = oldMesh->colors;
+	buffers->indices = oldMesh->indices;
+	buffers->boneIds = oldMesh->boneIds;
+	buffers->boneWeights = oldMesh->boneWeights;
+	newMesh->meshBuffers = buffers;
+
+	rlmMeshOptimizeReport report = { 0 };
+	if (weldDistance >= 0)
+		rlmOptimizeMeshBuffers(buffers, weldDistance, &report);
+
+	if (lodLevels > 0)
+		rlmGenerateMeshLODs(newMesh, lodLevels, reduction, maxError);
+
+	rlmUploadMesh(newMesh, !keepCPUdata);
+
+	MemFree(oldMesh->animVertices);
+	MemFree(oldMesh->animNormals);
+
+	return report;
+}
+
+rlmModel rlmLoadFromModelWithLODs(Model raylibModel, bool keepCPUdata, int lodLevels, float reduction, float maxError)
+{
+	return rlmLoadFromModelOptimized(raylibModel, keepCPUdata, lodLevels, reduction, maxError, -1.0f, NULL);
+}
+
+// a negative weld distance skips the optimize pass
+rlmModel rlmLoadFromModelOptimized(Model raylibModel, bool keepCPUdata, int lodLevels, float reduction, float maxError, float weldDistance, rlmMeshOptimizeReport* report)
 {
 	rlmModel newModel = { 0 };
+	rlmMeshOptimizeReport totals = { 0 };
+	bool optimize = weldDistance >= 0;
+
+	// raylib's buffers can't go in the arena, so the meshes are uploaded again from their CPU data
+	bool reupload = optimize || rlmGetUseMeshArena();
 
 	if (raylibModel.boneCount > 0 && raylibModel.bones != NULL)
 	{
@@ -59,6 +118,8 @@ rlmModel rlmLoadFromModelEX(Model raylibModel, bool keepCPUdata)
 
 		// TODO, make children relative
 
+		rlmCompileSkeleton(skeleton);
+
 		newModel.skeleton = skeleton;
 
 		MemFree(raylibModel.bindPose);
@@ -159,6 +220,22 @@ rlmModel rlmLoadFromModelEX(Model raylibModel, bool keepCPUdata)
 
 			newMesh->bounds = GetMeshBoundingBox(*oldMesh);
 
+			if (reupload && oldMesh->vertices)
+			{
+				rlmMeshOptimizeReport meshReport = rlmReuploadImportedMesh(newMesh, oldMesh, keepCPUdata, lodLevels, reduction, maxError, weldDistance);
+
+				// the cache miss ratios are summed by triangle and averaged at the end
+				totals.vertexCountBefore += meshReport.vertexCountBefore;
+				totals.vertexCountAfter += meshReport.vertexCountAfter;
+				totals.triangleCountBefore += meshReport.triangleCountBefore;
+				totals.triangleCountAfter += meshReport.triangleCountAfter;
+				totals.acmrBefore += meshReport.acmrBefore * meshReport.triangleCountBefore;
+				totals.acmrAfter += meshReport.acmrAfter * meshReport.triangleCountAfter;
+
+				meshIndex++;
+				continue;
+			}
+
 			newMesh->gpuMesh.vaoId = oldMesh->vaoId;
 			newMesh->gpuMesh.vboIds = oldMesh->vboId;
 
@@ -173,6 +250,27 @@ rlmModel rlmLoadFromModelEX(Model raylibModel, bool keepCPUdata)
 				newMesh->gpuMesh.elementCount = oldMesh->vertexCount;
 			}
 
+			if (lodLevels > 0 && oldMesh->vertices)
+			{
+				// the LODs only need to read the geometry, so point at the raylib arrays for now
+				rlmMeshBuffers buffers = { 0 };
+				buffers.vertexCount = oldMesh->vertexCount;
+				buffers.triangleCount = oldMesh->triangleCount;
+				buffers.vertices = oldMesh->vertices;
+				buffers.texcoords = oldMesh->texcoords;
+				buffers.texcoords2 = oldMesh->texcoords2;
+				buffers.normals = oldMesh->normals;
+				buffers.tangents = oldMesh->tangents;
+				buffers.colors = oldMesh->colors;
+				buffers.indices = oldMesh->indices;
+				buffers.boneIds = oldMesh->boneIds;
+				buffers.boneWeights = oldMesh->boneWeights;
+
+				newMesh->meshBuffers = &buffers;
+				rlmGenerateMeshLODs(newMesh, lodLevels, reduction, maxError);
+				newMesh->meshBuffers = NULL;
+			}
+
 			if (keepCPUdata)
 			{
 				newMesh->meshBuffers = (rlmMeshBuffers*)MemAlloc(sizeof(rlmMeshBuffers));
@@ -211,6 +309,14 @@ rlmModel rlmLoadFromModelEX(Model raylibModel, bool keepCPUdata)
 	MemFree(raylibModel.meshMaterial);
 	MemFree(raylibModel.meshes);
 
+	if (totals.triangleCountBefore > 0)
+		totals.acmrBefore /= (float)totals.triangleCountBefore;
+	if (totals.triangleCountAfter > 0)
+		totals.acmrAfter /= (float)totals.triangleCountAfter;
+
+	if (report)
+		*report = totals;
+
 	return newModel;
 }
 
@@ -222,13 +328,10 @@ rlmModelAniamtionSequence* rlmLoadModelAnimations(rlmSkeleton* skeleton, ModelAn
 	{
 		memcpy(sequences[i].name, animations[i].name, 32);
 		sequences[i].fps = 30;
-		sequences[i].keyframeCount = animations[i].frameCount;
-		sequences[i].keyframes = (rlmAnimationKeyframe*)MemAlloc(sizeof(rlmAnimationKeyframe) * animations[i].frameCount);
+		rlmLoadSequenceKeyframes(sequences + i, animations[i].frameCount, skeleton->boneCount);
 
 		for (int f = 0; f < animations[i].frameCount; f++)
 		{
-			sequences[i].keyframes[f].boneTransforms = (rlmPQSTransorm*)MemAlloc(sizeof(rlmPQSTransorm) * skeleton->boneCount);
-
 			for (int b = 0; b < skeleton->boneCount; b++)
 			{
 				sequences[i].keyframes[f].boneTransforms[b].position = animations[i].framePoses[f][b].translation;
@@ -243,4 +346,35 @@ rlmModelAniamtionSequence* rlmLoadModelAnimations(rlmSkeleton* skeleton, ModelAn
 	MemFree(animations);
 
 	return sequences;
-}
\ No newline at end of file
+}
+
+rlmModelAniamtionSequence* rlmLoadModelAnimationsCompressed(rlmSkeleton* skeleton, ModelAnimation* animations, int animationCount, float maxError, rlmAnimationCompressionReport* report)
+{
+	rlmModelAniamtionSequence* sequences = rlmLoadModelAnimations(skeleton, animations, animationCount);
+
+	rlmAnimationCompressionReport totals = { 0 };
+
+	for (int i = 0; i < animationCount; i++)
+	{
+		rlmAnimationCompressionReport sequenceReport = { 0 };
+		if (!rlmCompressAnimationSequence(sequences + i, skeleton->boneCount, maxError, &sequenceReport))
+			continue;
+
+		totals.rawBytes += sequenceReport.rawBytes;
+		totals.compressedBytes += sequenceReport.compressedBytes;
+		totals.trackCount += sequenceReport.trackCount;
+		totals.constantTracks += sequenceReport.constantTracks;
+		totals.sourceKeys += sequenceReport.sourceKeys;
+		totals.storedKeys += sequenceReport.storedKeys;
+	}
+
+	if (totals.compressedBytes > 0)
+		totals.ratio = (float)totals.rawBytes / (float)totals.compressedBytes;
+
+	TraceLog(LOG_INFO, "rlModels : Compressed %d animations from %d to %d bytes (%.2f:1)", animationCount, totals.rawBytes, totals.compressedBytes, totals.ratio);
+
+	if (report)
+		*report = totals;
+
+	return sequences;
+}
@@ -0,0 +1,219 @@
+#include "rlModels_Optimize.h"
+
+#include "raylib.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// the cache the scores model, bigger than most real caches so the order works on all of them
+#define RLM_OPTIMIZE_CACHE_SIZE 32
+
+// tuning from the paper
+#define RLM_OPTIMIZE_CACHE_DECAY 1.5f
+#define RLM_OPTIMIZE_LAST_TRIANGLE_SCORE 0.75f
+#define RLM_OPTIMIZE_VALENCE_SCALE 2.0f
+#define RLM_OPTIMIZE_VALENCE_POWER 0.5f
+
+// vertices in the cache score higher the more recently they were used, except the last triangle's, which are
+// held back a little so the next triangle does not just share an edge and strip along it
+// vertices with few triangles left score higher so lone triangles are not left behind
+static float rlmGetVertexScore(int cachePosition, unsigned int remaining)
+{
+	if (remaining == 0)
+		return -1.0f;
+
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		if (cachePosition < 3)
+			score = RLM_OPTIMIZE_LAST_TRIANGLE_SCORE;
+		else
+			score = powf(1.0f - (float)(cachePosition - 3) / (RLM_OPTIMIZE_CACHE_SIZE - 3), RLM_OPTIMIZE_CACHE_DECAY);
+	}
+
+	return score + RLM_OPTIMIZE_VALENCE_SCALE * powf((float)remaining, -RLM_OPTIMIZE_VALENCE_POWER);
+}
+
+void rlmOptimizeVertexCache(unsigned int* destination, const unsigned int* indices, int indexCount, int vertexCount)
+{
+	int triangleCount = indexCount / 3;
+	if (!destination || !indices || triangleCount <= 0 || vertexCount <= 0)
+		return;
+
+	// triangles of each vertex, the live ones are kept at the front of its list
+	unsigned int* offsets = (unsigned int*)MemAlloc(vertexCount * sizeof(unsigned int));
+	unsigned int* remaining = (unsigned int*)MemAlloc(vertexCount * sizeof(unsigned int));
+	unsigned int* triangles = (unsigned int*)MemAlloc(triangleCount * 3 * sizeof(unsigned int));
+
+	for (int i = 0; i < triangleCount * 3; i++)
+		remaining[indices[i]]++;
+
+	unsigned int offset = 0;
+	for (int v = 0; v < vertexCount; v++)
+	{
+		offsets[v] = offset;
+		offset += remaining[v];
+		remaining[v] = 0;
+	}
+
+	for (int i = 0; i < triangleCount * 3; i++)
+	{
+		unsigned int vertex = indices[i];
+		triangles[offsets[vertex] + remaining[vertex]++] = (unsigned int)(i / 3);
+	}
+
+	int* cachePositions = (int*)MemAlloc(vertexCount * sizeof(int));
+	float* vertexScores = (float*)MemAlloc(vertexCount * sizeof(float));
+	for (int v = 0; v < vertexCount; v++)
+	{
+		cachePositions[v] = -1;
+		vertexScores[v] = rlmGetVertexScore(-1, remaining[v]);
+	}
+
+	float* triangleScores = (float*)MemAlloc(triangleCount * sizeof(float));
+	bool* emitted = (bool*)MemAlloc(triangleCount * sizeof(bool));
+
+	int best = 0;
+	for (int t = 0; t < triangleCount; t++)
+	{
+		const unsigned int* triangle = indices + t * 3;
+		triangleScores[t] = vertexScores[triangle[0]] + vertexScores[triangle[1]] + vertexScores[triangle[2]];
+		if (triangleScores[t] > triangleScores[best])
+			best = t;
+	}
+
+	unsigned int cache[RLM_OPTIMIZE_CACHE_SIZE + 3];
+	int cacheCount = 0;
+	int cursor = 0;
+
+	for (int output = 0; output < triangleCount; output++)
+	{
+		// nothing in the cache has triangles left, start again from the first one not emitted
+		if (best < 0)
+		{
+			while (emitted[cursor])
+				cursor++;
+			best = cursor;
+		}
+
+		const unsigned int* triangle = indices + best * 3;
+		memcpy(destination + output * 3, triangle, 3 * sizeof(unsigned int));
+		emitted[best] = true;
+
+		for (int k = 0; k < 3; k++)
+		{
+			unsigned int vertex = triangle[k];
+			unsigned int* list = triangles + offsets[vertex];
+			for (unsigned int i = 0; i < remaining[vertex]; i++)
+			{
+				if (list[i] == (unsigned int)best)
+				{
+					list[i] = list[remaining[vertex] - 1];
+					remaining[vertex]--;
+					break;
+				}
+			}
+		}
+
+		// the triangle's vertices move to the front, the ones pushed past the end fall out
+		unsigned int newCache[RLM_OPTIMIZE_CACHE_SIZE + 3];
+		int newCount = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			if (k > 0 && triangle[k] == triangle[0])
+				continue;
+			if (k > 1 && triangle[k] == triangle[1])
+				continue;
+			newCache[newCount++] = triangle[k];
+		}
+
+		for (int i = 0; i < cacheCount; i++)
+		{
+			if (cache[i] != triangle[0] && cache[i] != triangle[1] && cache[i] != triangle[2])
+				newCache[newCount++] = cache[i];
+		}
+
+		for (int i = 0; i < newCount; i++)
+		{
+			unsigned int vertex = newCache[i];
+			cachePositions[vertex] = i < RLM_OPTIMIZE_CACHE_SIZE ? i : -1;
+			vertexScores[vertex] = rlmGetVertexScore(cachePositions[vertex], remaining[vertex]);
+		}
+
+		// only triangles around vertices whose score changed need a new score, the best of them goes next
+		best = -1;
+		float bestScore = -1.0f;
+		for (int i = 0; i < newCount; i++)
+		{
+			unsigned int vertex = newCache[i];
+			const unsigned int* list = triangles + offsets[vertex];
+			for (unsigned int j = 0; j < remaining[vertex]; j++)
+			{
+				const unsigned int* other = indices + list[j] * 3;
+				float score = vertexScores[other[0]] + vertexScores[other[1]] + vertexScores[other[2]];
+				triangleScores[list[j]] = score;
+				if (score > bestScore)
+				{
+					bestScore = score;
+					best = (int)list[j];
+				}
+			}
+		}
+
+		cacheCount = newCount < RLM_OPTIMIZE_CACHE_SIZE ? newCount : RLM_OPTIMIZE_CACHE_SIZE;
+		memcpy(cache, newCache, cacheCount * sizeof(unsigned int));
+	}
+
+	MemFree(offsets);
+	MemFree(remaining);
+	MemFree(triangles);
+	MemFree(cachePositions);
+	MemFree(vertexScores);
+	MemFree(triangleScores);
+	MemFree(emitted);
+}
+
+int rlmOptimizeVertexFetch(unsigned int* remap, unsigned int* indices, int indexCount, int vertexCount)
+{
+	if (!remap || !indices || vertexCount <= 0)
+		return 0;
+
+	memset(remap, 0xFF, vertexCount * sizeof(unsigned int));
+
+	unsigned int next = 0;
+	for (int i = 0; i < indexCount; i++)
+	{
+		unsigned int vertex = indices[i];
+		if (remap[vertex] == ~0u)
+			remap[vertex] = next++;
+
+		indices[i] = remap[vertex];
+	}
+
+	return (int)next;
+}
+
+float rlmGetACMR(const unsigned int* indices, int indexCount, int vertexCount, int cacheSize)
+{
+	int triangleCount = indexCount / 3;
+	if (!indices || triangleCount <= 0 || vertexCount <= 0 || cacheSize <= 0)
+		return 0.0f;
+
+	// a vertex is in the FIFO while fewer than cacheSize misses have come after the one that loaded it
+	unsigned int* loadedAt = (unsigned int*)MemAlloc(vertexCount * sizeof(unsigned int));
+	unsigned int misses = 0;
+
+	for (int i = 0; i < triangleCount * 3; i++)
+	{
+		unsigned int vertex = indices[i];
+		if (loadedAt[vertex] == 0 || misses - loadedAt[vertex] >= (unsigned int)cacheSize)
+		{
+			misses++;
+			loadedAt[vertex] = misses;
+		}
+	}
+
+	MemFree(loadedAt);
+	return (float)misses / (float)triangleCount;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// internal index and vertex reordering used by rlmOptimizeMeshBuffers
+// all of them work on 32 bit triangle lists, degenerate triangles are allowed but waste cache
+
+// reorders the triangles so neighbours reuse vertices still in the post transform cache (Tom Forsyth's linear speed optimizer)
+// destination can not be indices
+void rlmOptimizeVertexCache(unsigned int* destination, const unsigned int* indices, int indexCount, int vertexCount);
+
+// renumbers the vertices in the order the indices first use them, so the vertex fetch walks memory forwards
+// remap gets the new index of each old vertex, or ~0 for vertices nothing uses, returns the number of used vertices
+int rlmOptimizeVertexFetch(unsigned int* remap, unsigned int* indices, int indexCount, int vertexCount);
+
+// average cache misses per triangle for a FIFO post transform cache, 3 is the worst, about 0.5 the best a regular grid can get
+float rlmGetACMR(const unsigned int* indices, int indexCount, int vertexCount, int cacheSize);
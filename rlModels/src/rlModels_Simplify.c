@@ -0,0 +1,393 @@
+#include "rlModels_Simplify.h"
+
+#include "raylib.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// plane quadric, the symmetric 4x4 matrix of the squared distance to a set of planes, weighted by area
+typedef struct rlmQuadric
+{
+	float a2, b2, c2, d2;
+	float ab, ac, ad;
+	float bc, bd, cd;
+	float weight;
+}rlmQuadric;
+
+typedef struct rlmCollapse
+{
+	unsigned int from;
+	unsigned int to;
+	float error;
+}rlmCollapse;
+
+static void rlmAddPlaneQuadric(rlmQuadric* quadric, float a, float b, float c, float d, float weight)
+{
+	quadric->a2 += a * a * weight;
+	quadric->b2 += b * b * weight;
+	quadric->c2 += c * c * weight;
+	quadric->d2 += d * d * weight;
+	quadric->ab += a * b * weight;
+	quadric->ac += a * c * weight;
+	quadric->ad += a * d * weight;
+	quadric->bc += b * c * weight;
+	quadric->bd += b * d * weight;
+	quadric->cd += c * d * weight;
+	quadric->weight += weight;
+}
+
+static void rlmAddQuadric(rlmQuadric* quadric, const rlmQuadric* other)
+{
+	quadric->a2 += other->a2;
+	quadric->b2 += other->b2;
+	quadric->c2 += other->c2;
+	quadric->d2 += other->d2;
+	quadric->ab += other->ab;
+	quadric->ac += other->ac;
+	quadric->ad += other->ad;
+	quadric->bc += other->bc;
+	quadric->bd += other->bd;
+	quadric->cd += other->cd;
+	quadric->weight += other->weight;
+}
+
+// mean squared distance of a point to the planes in the quadric
+static float rlmGetQuadricError(const rlmQuadric* quadric, const float* point)
+{
+	float x = point[0], y = point[1], z = point[2];
+
+	float error = quadric->a2 * x * x + quadric->b2 * y * y + quadric->c2 * z * z + quadric->d2
+		+ 2.0f * (quadric->ab * x * y + quadric->ac * x * z + quadric->bc * y * z)
+		+ 2.0f * (quadric->ad * x + quadric->bd * y + quadric->cd * z);
+
+	return quadric->weight > 0 ? fabsf(error) / quadric->weight : 0;
+}
+
+static void rlmGetTriangleNormal(const float* p0, const float* p1, const float* p2, float* normal)
+{
+	float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+	float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+	normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+	normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+	normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+static unsigned int rlmHashPosition(const float* position)
+{
+	unsigned int bits[3];
+	memcpy(bits, position, sizeof(bits));
+
+	return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+}
+
+// maps every vertex to the first vertex with the same position
+static void rlmBuildPositionRemap(unsigned int* remap, const float* positions, int vertexCount)
+{
+	unsigned int tableSize = 1;
+	while (tableSize < (unsigned int)vertexCount * 2)
+		tableSize *= 2;
+
+	unsigned int* table = (unsigned int*)MemAlloc(tableSize * sizeof(unsigned int));
+	memset(table, 0xFF, tableSize * sizeof(unsigned int));
+
+	for (int i = 0; i < vertexCount; i++)
+	{
+		const float* position = positions + i * 3;
+		unsigned int slot = rlmHashPosition(position) & (tableSize - 1);
+
+		remap[i] = i;
+		while (table[slot] != ~0u)
+		{
+			const float* other = positions + table[slot] * 3;
+			if (other[0] == position[0] && other[1] == position[1] && other[2] == position[2])
+			{
+				remap[i] = table[slot];
+				break;
+			}
+			slot = (slot + 1) & (tableSize - 1);
+		}
+
+		if (remap[i] == (unsigned int)i)
+			table[slot] = i;
+	}
+
+	MemFree(table);
+}
+
+// triangles around each position, as offsets into one list
+static void rlmBuildAdjacency(unsigned int* offsets, unsigned int* counts, unsigned int* triangles, const unsigned int* indices, int indexCount, const unsigned int* remap, int vertexCount)
+{
+	memset(counts, 0, vertexCount * sizeof(unsigned int));
+	for (int i = 0; i < indexCount; i++)
+		counts[remap[indices[i]]]++;
+
+	unsigned int offset = 0;
+	for (int i = 0; i < vertexCount; i++)
+	{
+		offsets[i] = offset;
+		offset += counts[i];
+		counts[i] = 0;
+	}
+
+	for (int i = 0; i < indexCount; i++)
+	{
+		unsigned int vertex = remap[indices[i]];
+		triangles[offsets[vertex] + counts[vertex]++] = i / 3;
+	}
+}
+
+static bool rlmHasEdge(const unsigned int* offsets, const unsigned int* counts, const unsigned int* triangles, const unsigned int* indices, const unsigned int* remap, unsigned int from, unsigned int to)
+{
+	for (unsigned int i = 0; i < counts[from]; i++)
+	{
+		const unsigned int* triangle = indices + triangles[offsets[from] + i] * 3;
+		for (int corner = 0; corner < 3; corner++)
+		{
+			if (remap[triangle[corner]] == from && remap[triangle[(corner + 1) % 3]] == to)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+// true when moving the vertex to the target would turn any triangle around it over
+static bool rlmCollapseFlips(const unsigned int* offsets, const unsigned int* counts, const unsigned int* triangles, const unsigned int* indices, const unsigned int* remap, const float* positions, unsigned int from, unsigned int to)
+{
+	const float* target = positions + to * 3;
+
+	for (unsigned int i = 0; i < counts[from]; i++)
+	{
+		const unsigned int* triangle = indices + triangles[offsets[from] + i] * 3;
+
+		// triangles on the edge go away
+		if (remap[triangle[0]] == remap[to] || remap[triangle[1]] == remap[to] || remap[triangle[2]] == remap[to])
+			continue;
+
+		const float* corners[3];
+		const float* moved[3];
+		for (int corner = 0; corner < 3; corner++)
+		{
+			corners[corner] = positions + triangle[corner] * 3;
+			moved[corner] = remap[triangle[corner]] == from ? target : corners[corner];
+		}
+
+		float before[3], after[3];
+		rlmGetTriangleNormal(corners[0], corners[1], corners[2], before);
+		rlmGetTriangleNormal(moved[0], moved[1], moved[2], after);
+
+		if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0)
+			return true;
+	}
+
+	return false;
+}
+
+static int rlmCompareCollapses(const void* lhs, const void* rhs)
+{
+	float a = ((const rlmCollapse*)lhs)->error;
+	float b = ((const rlmCollapse*)rhs)->error;
+	return (a > b) - (a < b);
+}
+
+int rlmSimplifyMesh(unsigned int* destination, const unsigned int* indices, int indexCount, const float* positions, int vertexCount, int targetIndexCount, float targetError, float* resultError)
+{
+	if (resultError)
+		*resultError = 0;
+
+	if (!destination || !indices || !positions || indexCount < 3 || vertexCount <= 0)
+		return 0;
+
+	indexCount -= indexCount % 3;
+	memcpy(destination, indices, indexCount * sizeof(unsigned int));
+
+	// work in a unit box so the errors are relative to the size of the mesh
+	float boundsMin[3] = { positions[0], positions[1], positions[2] };
+	float boundsMax[3] = { positions[0], positions[1], positions[2] };
+	for (int i = 1; i < vertexCount; i++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			boundsMin[axis] = fminf(boundsMin[axis], positions[i * 3 + axis]);
+			boundsMax[axis] = fmaxf(boundsMax[axis], positions[i * 3 + axis]);
+		}
+	}
+
+	float extent = fmaxf(boundsMax[0] - boundsMin[0], fmaxf(boundsMax[1] - boundsMin[1], boundsMax[2] - boundsMin[2]));
+	if (extent <= 0)
+		return indexCount;
+
+	float* scaled = (float*)MemAlloc(vertexCount * 3 * sizeof(float));
+	for (int i = 0; i < vertexCount * 3; i++)
+		scaled[i] = (positions[i] - boundsMin[i % 3]) / extent;
+
+	unsigned int* remap = (unsigned int*)MemAlloc(vertexCount * sizeof(unsigned int));
+	rlmBuildPositionRemap(remap, scaled, vertexCount);
+
+	unsigned int* offsets = (unsigned int*)MemAlloc(vertexCount * sizeof(unsigned int));
+	unsigned int* counts = (unsigned int*)MemAlloc(vertexCount * sizeof(unsigned int));
+	unsigned int* triangles = (unsigned int*)MemAlloc(indexCount * sizeof(unsigned int));
+	rlmBuildAdjacency(offsets, counts, triangles, destination, indexCount, remap, vertexCount);
+
+	// seams and borders stay where they are, everything else can move
+	// only referenced vertices make seams, welded buffers keep their unused duplicates
+	bool* locked = (bool*)MemAlloc(vertexCount * sizeof(bool));
+	bool* used = (bool*)MemAlloc(vertexCount * sizeof(bool));
+	for (int i = 0; i < indexCount; i++)
+		used[destination[i]] = true;
+
+	for (int i = 0; i < vertexCount; i++)
+	{
+		if (used[i] && remap[i] != (unsigned int)i)
+			locked[i] = locked[remap[i]] = true;
+	}
+	MemFree(used);
+
+	for (int i = 0; i < indexCount; i++)
+	{
+		unsigned int from = remap[destination[i]];
+		unsigned int to = remap[destination[i - i % 3 + (i + 1) % 3]];
+
+		if (!rlmHasEdge(offsets, counts, triangles, destination, remap, to, from))
+			locked[from] = locked[to] = true;
+	}
+
+	rlmQuadric* quadrics = (rlmQuadric*)MemAlloc(vertexCount * sizeof(rlmQuadric));
+	for (int i = 0; i < indexCount; i += 3)
+	{
+		const float* p0 = scaled + destination[i] * 3;
+		const float* p1 = scaled + destination[i + 1] * 3;
+		const float* p2 = scaled + destination[i + 2] * 3;
+
+		float normal[3];
+		rlmGetTriangleNormal(p0, p1, p2, normal);
+
+		float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length <= 0)
+			continue;
+
+		normal[0] /= length;
+		normal[1] /= length;
+		normal[2] /= length;
+		float distance = -(normal[0] * p0[0] + normal[1] * p0[1] + normal[2] * p0[2]);
+
+		for (int corner = 0; corner < 3; corner++)
+			rlmAddPlaneQuadric(&quadrics[remap[destination[i + corner]]], normal[0], normal[1], normal[2], distance, length * 0.5f);
+	}
+
+	rlmCollapse* collapses = (rlmCollapse*)MemAlloc(indexCount * sizeof(rlmCollapse));
+	unsigned int* targets = (unsigned int*)MemAlloc(vertexCount * sizeof(unsigned int));
+	bool* touched = (bool*)MemAlloc(vertexCount * sizeof(bool));
+
+	float maxError = targetError * targetError;
+	float acceptedError = 0;
+
+	while (indexCount > targetIndexCount)
+	{
+		// every edge out of a free vertex is a candidate
+		int collapseCount = 0;
+		for (int i = 0; i < indexCount; i++)
+		{
+			unsigned int from = destination[i];
+			unsigned int to = destination[i - i % 3 + (i + 1) % 3];
+			if (locked[from])
+				continue;
+
+			rlmQuadric quadric = quadrics[from];
+			rlmAddQuadric(&quadric, &quadrics[remap[to]]);
+
+			collapses[collapseCount].from = from;
+			collapses[collapseCount].to = to;
+			collapses[collapseCount].error = rlmGetQuadricError(&quadric, scaled + to * 3);
+			collapseCount++;
+		}
+
+		if (collapseCount == 0)
+			break;
+
+		qsort(collapses, collapseCount, sizeof(rlmCollapse), rlmCompareCollapses);
+
+		for (int i = 0; i < vertexCount; i++)
+		{
+			targets[i] = i;
+			touched[i] = false;
+		}
+
+		// each collapse takes out about two triangles
+		int trianglesToRemove = (indexCount - targetIndexCount) / 3;
+		int removed = 0;
+		int applied = 0;
+
+		for (int i = 0; i < collapseCount && removed < trianglesToRemove; i++)
+		{
+			const rlmCollapse* collapse = &collapses[i];
+			if (collapse->error > maxError)
+				break;
+
+			// only one collapse around a vertex per pass, so the flip checks see the real triangles
+			if (touched[collapse->from] || touched[remap[collapse->to]])
+				continue;
+
+			if (rlmCollapseFlips(offsets, counts, triangles, destination, remap, scaled, collapse->from, collapse->to))
+				continue;
+
+			targets[collapse->from] = collapse->to;
+			rlmAddQuadric(&quadrics[remap[collapse->to]], &quadrics[collapse->from]);
+
+			// mark the whole neighbourhood, the triangles around it are about to change
+			unsigned int around[2] = { collapse->from, remap[collapse->to] };
+			for (int side = 0; side < 2; side++)
+			{
+				for (unsigned int t = 0; t < counts[around[side]]; t++)
+				{
+					const unsigned int* triangle = destination + triangles[offsets[around[side]] + t] * 3;
+					touched[remap[triangle[0]]] = touched[remap[triangle[1]]] = touched[remap[triangle[2]]] = true;
+				}
+			}
+
+			removed += 2;
+			applied++;
+			acceptedError = fmaxf(acceptedError, collapse->error);
+		}
+
+		if (applied == 0)
+			break;
+
+		// move the collapsed corners and drop the triangles that lost their area
+		int writeIndex = 0;
+		for (int i = 0; i < indexCount; i += 3)
+		{
+			unsigned int a = targets[destination[i]];
+			unsigned int b = targets[destination[i + 1]];
+			unsigned int c = targets[destination[i + 2]];
+
+			if (remap[a] == remap[b] || remap[b] == remap[c] || remap[a] == remap[c])
+				continue;
+
+			destination[writeIndex++] = a;
+			destination[writeIndex++] = b;
+			destination[writeIndex++] = c;
+		}
+		indexCount = writeIndex;
+
+		rlmBuildAdjacency(offsets, counts, triangles, destination, indexCount, remap, vertexCount);
+	}
+
+	MemFree(scaled);
+	MemFree(remap);
+	MemFree(offsets);
+	MemFree(counts);
+	MemFree(triangles);
+	MemFree(locked);
+	MemFree(quadrics);
+	MemFree(collapses);
+	MemFree(targets);
+	MemFree(touched);
+
+	if (resultError)
+		*resultError = sqrtf(acceptedError);
+
+	return indexCount;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+// internal quadric error mesh simplifier used to build mesh LODs
+// edges are collapsed onto existing vertices, so the output indexes the same vertex buffer as the input
+// vertices on open borders or on attribute seams (more than one vertex at a position) are never moved
+
+// writes up to indexCount indices to destination and returns how many were written
+// stops at targetIndexCount or when the next collapse would go over targetError, relative to the mesh extent
+// resultError gets the largest error that was accepted, and can be NULL
+int rlmSimplifyMesh(unsigned int* destination, const unsigned int* indices, int indexCount, const float* positions, int vertexCount, int targetIndexCount, float targetError, float* resultError);
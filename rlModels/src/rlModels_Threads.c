@@ -0,0 +1,226 @@
+#include "rlModels_Threads.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+typedef HANDLE rlmThread;
+typedef SRWLOCK rlmMutex;
+typedef CONDITION_VARIABLE rlmCondition;
+
+#define rlmMutexInit(m) InitializeSRWLock(m)
+#define rlmMutexLock(m) AcquireSRWLockExclusive(m)
+#define rlmMutexUnlock(m) ReleaseSRWLockExclusive(m)
+#define rlmConditionInit(c) InitializeConditionVariable(c)
+#define rlmConditionWait(c, m) SleepConditionVariableSRW(c, m, INFINITE, 0)
+#define rlmConditionBroadcast(c) WakeAllConditionVariable(c)
+#define rlmConditionSignal(c) WakeConditionVariable(c)
+
+typedef volatile LONG rlmAtomicInt;
+#define rlmAtomicFetchAdd(a, v) InterlockedExchangeAdd(a, v)
+#define rlmAtomicStore(a, v) InterlockedExchange(a, v)
+#else
+#include <pthread.h>
+
+typedef pthread_t rlmThread;
+typedef pthread_mutex_t rlmMutex;
+typedef pthread_cond_t rlmCondition;
+
+#define rlmMutexInit(m) pthread_mutex_init(m, NULL)
+#define rlmMutexLock(m) pthread_mutex_lock(m)
+#define rlmMutexUnlock(m) pthread_mutex_unlock(m)
+#define rlmConditionInit(c) pthread_cond_init(c, NULL)
+#define rlmConditionWait(c, m) pthread_cond_wait(c, m)
+#define rlmConditionBroadcast(c) pthread_cond_broadcast(c)
+#define rlmConditionSignal(c) pthread_cond_signal(c)
+
+typedef volatile int rlmAtomicInt;
+#define rlmAtomicFetchAdd(a, v) __atomic_fetch_add(a, v, __ATOMIC_RELAXED)
+#define rlmAtomicStore(a, v) __atomic_store_n(a, v, __ATOMIC_RELAXED)
+#endif
+
+typedef struct rlmWorkerPool
+{
+	bool initialized;
+	int workerCount;
+	rlmThread threads[RLM_MAX_WORKER_THREADS];
+
+	rlmMutex lock;
+	rlmCondition wakeCondition;
+	rlmCondition doneCondition;
+
+	unsigned int generation;
+	unsigned int spawnGeneration;	// generation when the workers were started, so a slow starting worker can't miss the first job
+	bool shutdown;
+	int busyWorkers;
+
+	// the current job
+	rlmWorkerJob job;
+	void* userData;
+	int itemCount;
+	int chunkSize;
+	rlmAtomicInt nextItem;
+}rlmWorkerPool;
+
+static rlmWorkerPool WorkerPool = { 0 };
+
+static void rlmRunChunks(rlmWorkerPool* pool)
+{
+	while (true)
+	{
+		int start = (int)rlmAtomicFetchAdd(&pool->nextItem, pool->chunkSize);
+		if (start >= pool->itemCount)
+			break;
+
+		int end = start + pool->chunkSize;
+		if (end > pool->itemCount)
+			end = pool->itemCount;
+
+		pool->job(pool->userData, start, end);
+	}
+}
+
+static void rlmWorkerLoop(rlmWorkerPool* pool)
+{
+	rlmMutexLock(&pool->lock);
+	unsigned int seenGeneration = pool->spawnGeneration;
+
+	while (true)
+	{
+		while (pool->generation == seenGeneration && !pool->shutdown)
+			rlmConditionWait(&pool->wakeCondition, &pool->lock);
+
+		if (pool->shutdown)
+			break;
+
+		seenGeneration = pool->generation;
+		rlmMutexUnlock(&pool->lock);
+
+		rlmRunChunks(pool);
+
+		rlmMutexLock(&pool->lock);
+		pool->busyWorkers--;
+		if (pool->busyWorkers == 0)
+			rlmConditionSignal(&pool->doneCondition);
+	}
+
+	rlmMutexUnlock(&pool->lock);
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI rlmWorkerThreadMain(LPVOID param)
+{
+	rlmWorkerLoop((rlmWorkerPool*)param);
+	return 0;
+}
+#else
+static void* rlmWorkerThreadMain(void* param)
+{
+	rlmWorkerLoop((rlmWorkerPool*)param);
+	return NULL;
+}
+#endif
+
+static void rlmStopWorkers(rlmWorkerPool* pool)
+{
+	if (pool->workerCount == 0)
+		return;
+
+	rlmMutexLock(&pool->lock);
+	pool->shutdown = true;
+	rlmConditionBroadcast(&pool->wakeCondition);
+	rlmMutexUnlock(&pool->lock);
+
+	for (int i = 0; i < pool->workerCount; i++)
+	{
+#if defined(_WIN32)
+		WaitForSingleObject(pool->threads[i], INFINITE);
+		CloseHandle(pool->threads[i]);
+#else
+		pthread_join(pool->threads[i], NULL);
+#endif
+	}
+
+	pool->workerCount = 0;
+	pool->shutdown = false;
+}
+
+void rlmThreadsSetWorkerCount(int count)
+{
+	rlmWorkerPool* pool = &WorkerPool;
+
+	if (count < 0)
+		count = 0;
+	if (count > RLM_MAX_WORKER_THREADS)
+		count = RLM_MAX_WORKER_THREADS;
+
+	if (!pool->initialized)
+	{
+		rlmMutexInit(&pool->lock);
+		rlmConditionInit(&pool->wakeCondition);
+		rlmConditionInit(&pool->doneCondition);
+		pool->initialized = true;
+	}
+
+	if (count == pool->workerCount)
+		return;
+
+	rlmStopWorkers(pool);
+
+	pool->spawnGeneration = pool->generation;
+
+	for (int i = 0; i < count; i++)
+	{
+#if defined(_WIN32)
+		pool->threads[i] = CreateThread(NULL, 0, rlmWorkerThreadMain, pool, 0, NULL);
+		if (pool->threads[i] == NULL)
+			break;
+#else
+		if (pthread_create(&pool->threads[i], NULL, rlmWorkerThreadMain, pool) != 0)
+			break;
+#endif
+		pool->workerCount++;
+	}
+}
+
+int rlmThreadsGetWorkerCount()
+{
+	return WorkerPool.workerCount;
+}
+
+void rlmThreadsRun(rlmWorkerJob job, void* userData, int itemCount, int chunkSize)
+{
+	rlmWorkerPool* pool = &WorkerPool;
+
+	if (!job || itemCount <= 0)
+		return;
+
+	if (chunkSize < 1)
+		chunkSize = 1;
+
+	// not worth waking anyone up
+	if (pool->workerCount == 0 || itemCount <= chunkSize)
+	{
+		job(userData, 0, itemCount);
+		return;
+	}
+
+	rlmMutexLock(&pool->lock);
+	pool->job = job;
+	pool->userData = userData;
+	pool->itemCount = itemCount;
+	pool->chunkSize = chunkSize;
+	rlmAtomicStore(&pool->nextItem, 0);
+	pool->busyWorkers = pool->workerCount;
+	pool->generation++;
+	rlmConditionBroadcast(&pool->wakeCondition);
+	rlmMutexUnlock(&pool->lock);
+
+	// the calling thread pulls chunks too, instead of just waiting
+	rlmRunChunks(pool);
+
+	rlmMutexLock(&pool->lock);
+	while (pool->busyWorkers > 0)
+		rlmConditionWait(&pool->doneCondition, &pool->lock);
+	rlmMutexUnlock(&pool->lock);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+// internal worker pool used for bulk updates
+// this is kept apart from raylib.h, since the platform thread headers conflict with it on windows
+
+#include <stdbool.h>
+
+#define RLM_MAX_WORKER_THREADS 64
+
+typedef void (*rlmWorkerJob)(void* userData, int start, int end);
+
+void rlmThreadsSetWorkerCount(int count);
+int rlmThreadsGetWorkerCount();
+
+// splits [0, itemCount) into chunks that the workers and the calling thread claim until all are done, returns when everything is finished
+void rlmThreadsRun(rlmWorkerJob job, void* userData, int itemCount, int chunkSize);